@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "app_types.h"
+#include "radar_targets.h"
+#include "sbs_parser.h"
+
+#ifndef AIRCRAFT_TABLE_SIZE
+#define AIRCRAFT_TABLE_SIZE 64
+#endif
+
+#ifndef AIRCRAFT_TABLE_EXPIRE_MS
+#define AIRCRAFT_TABLE_EXPIRE_MS 60000
+#endif
+
+// Set in table keys (and radar ids) of non-ICAO ('~') addresses so they never
+// share an entry with the ICAO address of the same digits.
+constexpr uint32_t kAircraftNonIcao = 0x1000000;
+
+// Live per-aircraft state fed by the streaming ingest paths. Entries are
+// updated in place as messages arrive; nothing here allocates.
+struct TrackedAircraft {
+  uint32_t icao = 0;  // 24-bit address, | kAircraftNonIcao for '~' addresses
+  char callsign[9] = {0};
+  long altitudeFt = -1;
+  double lat = NAN;
+  double lon = NAN;
+  float groundSpeedKt = NAN;
+  float trackDeg = NAN;
+  uint16_t squawk = 0;
+  bool onGround = false;
+  uint32_t lastSeenMs = 0;
+  uint32_t lastPosMs = 0;
+  // Raw CPR frames for the Mode-S path; index 0 is even, 1 is odd.
+  uint32_t cprLat[2] = {0, 0};
+  uint32_t cprLon[2] = {0, 0};
+  uint32_t cprMs[2] = {0, 0};
+  bool cprSurface = false;
+};
+
+TrackedAircraft *aircraftTableUpsert(uint32_t icao, uint32_t nowMs);
+TrackedAircraft *aircraftTableFind(uint32_t icao);
+void aircraftTableExpire(uint32_t nowMs);
+size_t aircraftTableCount();
+// Applies the fields present in one SBS message to its aircraft's entry.
+void aircraftTableApplySbs(const SbsMessage &msg, uint32_t nowMs);
+void aircraftTableToFlightInfo(const TrackedAircraft &ac, FlightInfo &out);
+bool aircraftTableNearest(FlightInfo &out, uint32_t nowMs);
+// Every aircraft with a current position, in table order, as MIL lookup
+// candidates. Returns how many were written (at most cap).
+size_t aircraftTableCandidates(MilCandidate *out, size_t cap, uint32_t nowMs);
+void aircraftTableRadar(RadarSnapshot &out, uint32_t nowMs);
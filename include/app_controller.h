@@ -7,9 +7,19 @@ struct AppControllerState {
   FlightInfo lastShown;
   bool haveDisplayed = false;
   uint32_t lastSeq = 0;
+  uint32_t lastRadarSeq = 0;
   uint32_t lastBattUi = 0;
   uint32_t lastLvglMs = 0;
 };
 
+// Loop accounting since boot; idle is time blocked waiting for a deadline.
+struct AppLoopStats {
+  uint32_t iterations = 0;
+  uint32_t earlyWakes = 0;
+  uint64_t idleUs = 0;
+  uint64_t totalUs = 0;
+};
+
 void appControllerInit(const UiState &ui);
+AppLoopStats appControllerGetLoopStats();
 void appControllerTick();
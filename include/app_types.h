@@ -12,6 +12,7 @@ struct FlightInfo {
   double lat = NAN;
   double lon = NAN;
   double distanceKm = NAN;
+  float trackDeg = NAN;  // ground track, degrees true
   String hex;          // transponder hex id
   bool hasCallsign = false;
   String opClass;      // MIL/COM/PVT
@@ -20,6 +21,12 @@ struct FlightInfo {
   int seatOverride = -1;  // if >0, override seat display
 };
 
+struct MilCandidate {
+  FlightInfo fi;
+  bool inFlight = false;
+  bool isMil = false;
+};
+
 struct DisplayMetrics {
   int16_t screenW = 0;
   int16_t screenH = 0;
@@ -34,6 +41,13 @@ struct DisplayState {
   uint8_t brightness = 0;
 };
 
+// Battery and supply as the UI shows them.
+struct DisplayPower {
+  uint16_t battMv = 0;  // filtered reading, 0 when unknown
+  bool charging = false;
+  bool onBattery = false;  // PMU present and no USB power
+};
+
 struct UiState {
   bool ready = false;
 };
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_system.h>
+
+#include <algorithm>
+
+// Exponential backoff for retry attempt `attempt` (0-based): base doubled per
+// attempt up to 32x, with ±6.25% jitter so devices that failed together
+// do not retry together, and never more than cap.
+inline uint32_t backoffMs(uint8_t attempt, uint32_t base = 500, uint32_t cap = 8000) {
+  uint32_t exp = base << std::min<uint8_t>(attempt, 5);
+  uint32_t j = (exp >> 3) * (esp_random() & 0x7) / 7;
+  return std::min(cap, exp - (exp >> 4) + j);
+}
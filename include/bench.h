@@ -0,0 +1,12 @@
+#pragma once
+
+#include <Arduino.h>
+
+// On-device microbenchmarks for the per-poll hot paths: JSON parse, aircraft
+// parse and scan, MIL list matching, type lookup, classification and flight
+// card formatting. Inputs are synthetic aircraft lists of 10 up to
+// maxAircraft entries, generated from a fixed seed, plus any recorded lists
+// built in with BENCH_CAPTURE_HEADER. Results go to `out` as
+// one "BENCH {...}" JSON line for tools/bench_compare.py. Blocks the caller
+// for a few seconds.
+void benchRun(Print &out, size_t maxAircraft);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Synthetic inputs shared by the on-device benchmarks (bench.cpp) and the
+// host ones (host/bench_host.cpp), generated from a fixed seed so every run
+// and both builds measure the same payloads.
+
+// Aircraft list sizes each list case runs at.
+constexpr size_t kBenchSizes[] = {10, 100, 1000, 5000};
+
+// Common airliners and GA types, a pseudo type and one the table lacks.
+extern const char *const kBenchTypes[];
+extern const size_t kBenchTypeCount;
+
+// ICAO address of the i-th aircraft in a generated list.
+uint32_t benchHex(size_t i);
+
+// Shaped like an adsb.lol /v2/lat response: n aircraft within the search
+// radius, one in eight on the ground, a few without a callsign.
+bool benchMakeAircraftList(size_t n, String &out);
+
+// Shaped like /v2/mil: n entries, every 16th one of the even-numbered
+// hexes, so the matcher finds some but always reads the whole body.
+bool benchMakeMilList(size_t n, const String *hexes, size_t count, String &out);
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Boot phases and milestones. Spans (Display .. Network) run between a begin
+// and an end; milestones only record when they were reached.
+enum class BootPhase : uint8_t {
+  Display,
+  Lvgl,
+  Ui,
+  Network,     // networkingInit + fetch task start
+  FirstFrame,  // first lv_timer_handler pass in the loop
+  WifiIp,
+  FirstFetch,
+  FirstFlight,
+  Count
+};
+
+// Times are microseconds from the clock, which defaults to micros(); a fake
+// clock can be passed for host runs. Safe to call from any task.
+void bootProfilerInit(uint32_t (*clockUs)() = nullptr);
+void bootPhaseBegin(BootPhase phase);
+void bootPhaseEnd(BootPhase phase);
+// Records a milestone the first time it is reached; later calls are ignored.
+void bootMilestone(BootPhase phase);
+const char *bootPhaseName(BootPhase phase);
+// Sum of the span durations versus the wall time they covered; the
+// difference is what running them concurrently saved.
+uint32_t bootProfilerSerialUs();
+uint32_t bootProfilerWallUs();
+void bootProfilerPrint(Print &out);
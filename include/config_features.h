@@ -12,6 +12,24 @@
 #define FEATURE_DIAGNOSTICS 0
 #endif
 
+// One log line per poll with cycle time, body bytes, heap blocks left
+// allocated and the selected target; what a replayed capture should repeat.
+#ifndef FEATURE_FETCH_TRACE
+#define FEATURE_FETCH_TRACE FEATURE_DIAGNOSTICS
+#endif
+
+// Line commands on the USB serial console (e.g. "net" prints timing histograms).
+#ifndef FEATURE_SERIAL_COMMANDS
+#define FEATURE_SERIAL_COMMANDS 1
+#endif
+
+// "bench [max aircraft]" on the serial console runs the hot-path
+// microbenchmarks on synthetic aircraft lists, and on recorded ones when
+// BENCH_CAPTURE_HEADER names a header from tools/bench_capture.py.
+#ifndef FEATURE_BENCH
+#define FEATURE_BENCH FEATURE_SERIAL_COMMANDS
+#endif
+
 #ifndef FAST_FIRST_FETCH
 #define FAST_FIRST_FETCH 1
 #endif
@@ -39,3 +57,114 @@
 #ifndef MIL_LIST_FETCH_MIN_INTERVAL_MS
 #define MIL_LIST_FETCH_MIN_INTERVAL_MS (2UL * 60UL * 1000UL)
 #endif
+
+// Streaming ingest from a local receiver instead of polling the JSON API.
+#ifndef FEATURE_STREAM_INGEST
+#define FEATURE_STREAM_INGEST 0
+#endif
+
+#define STREAM_FORMAT_SBS 0
+#define STREAM_FORMAT_BEAST 1
+#define STREAM_FORMAT_AVR 2
+
+#ifndef STREAM_FORMAT
+#define STREAM_FORMAT STREAM_FORMAT_SBS
+#endif
+
+#ifndef STREAM_PUBLISH_INTERVAL_MS
+#define STREAM_PUBLISH_INTERVAL_MS 500
+#endif
+
+#ifndef STREAM_CONNECT_TIMEOUT_MS
+#define STREAM_CONNECT_TIMEOUT_MS 3000
+#endif
+
+#ifndef STREAM_IDLE_TIMEOUT_MS
+#define STREAM_IDLE_TIMEOUT_MS 30000
+#endif
+
+#ifndef STREAM_READ_BUDGET_BYTES
+#define STREAM_READ_BUDGET_BYTES 4096
+#endif
+
+// How long a target whose enrichment lookups failed keeps the partial result
+// before they are tried again.
+#ifndef STREAM_ENRICH_RETRY_MS
+#define STREAM_ENRICH_RETRY_MS 30000
+#endif
+
+// Aggregator mirror failover (API_BASE_MIRRORS) and hedged requests.
+#ifndef FEATURE_HEDGED_REQUESTS
+#define FEATURE_HEDGED_REQUESTS 1
+#endif
+
+#ifndef ENDPOINT_EWMA_ALPHA
+#define ENDPOINT_EWMA_ALPHA 0.2f
+#endif
+
+#ifndef ENDPOINT_DEFAULT_LATENCY_MS
+#define ENDPOINT_DEFAULT_LATENCY_MS 1500
+#endif
+
+#ifndef ENDPOINT_COOLDOWN_MS
+#define ENDPOINT_COOLDOWN_MS 10000
+#endif
+
+#ifndef ENDPOINT_HEDGE_DEFAULT_MS
+#define ENDPOINT_HEDGE_DEFAULT_MS 2500
+#endif
+
+#ifndef ENDPOINT_HEDGE_MIN_MS
+#define ENDPOINT_HEDGE_MIN_MS 400
+#endif
+
+#ifndef ENDPOINT_HEDGE_MIN_SAMPLES
+#define ENDPOINT_HEDGE_MIN_SAMPLES 4
+#endif
+
+#ifndef ENDPOINT_HEDGE_MIN_HEAP
+#define ENDPOINT_HEDGE_MIN_HEAP 90000
+#endif
+
+// Resolver cache and connection pre-warming ahead of the next poll.
+#ifndef FEATURE_HTTP_PREWARM
+#define FEATURE_HTTP_PREWARM 1
+#endif
+
+#ifndef HTTP_PREWARM_LEAD_MS
+#define HTTP_PREWARM_LEAD_MS 600
+#endif
+
+#ifndef HTTP_PREWARM_MAX_IDLE_MS
+#define HTTP_PREWARM_MAX_IDLE_MS 5000
+#endif
+
+static_assert(HTTP_PREWARM_LEAD_MS < FETCH_INTERVAL_MS,
+              "HTTP_PREWARM_LEAD_MS must be shorter than FETCH_INTERVAL_MS");
+
+// LVGL refresh histograms at boot; "lvgl on|off" on the serial console
+// toggles them at runtime.
+#ifndef LVGL_PROFILE_AT_BOOT
+#define LVGL_PROFILE_AT_BOOT FEATURE_DIAGNOSTICS
+#endif
+
+// Per-pixel luminance map (one PSRAM byte per pixel) updated from every
+// flushed area, for the frame's picture level and display power. Its only
+// reader is the diagnostics log, and it walks every flushed pixel.
+#ifndef LVGL_LUMA_ACCOUNTING
+#define LVGL_LUMA_ACCOUNTING FEATURE_DIAGNOSTICS
+#endif
+
+// PPI-style radar view of the nearest aircraft around HOME; long-press to toggle.
+#ifndef FEATURE_RADAR_VIEW
+#define FEATURE_RADAR_VIEW 1
+#endif
+
+#ifndef RADAR_MAX_BLIPS
+#define RADAR_MAX_BLIPS 12
+#endif
+
+// Outer ring of the scope; 0 uses SEARCH_RADIUS_KM.
+#ifndef RADAR_RANGE_KM
+#define RADAR_RANGE_KM 0
+#endif
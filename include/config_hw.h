@@ -20,6 +20,24 @@
 #define WIFI_FAST_CONNECT 1
 #endif
 
+// 1 brings Wi-Fi up from a short-lived task on core 0 while setup() inits
+// the panel, LVGL and the UI on core 1; 0 runs everything in sequence.
+#ifndef BOOT_PARALLEL_WIFI
+#define BOOT_PARALLEL_WIFI 1
+#endif
+
+// Reconnect to the last access point on its known channel instead of
+// scanning; falls back to a full scan if that attempt fails.
+#ifndef WIFI_FAST_RECONNECT
+#define WIFI_FAST_RECONNECT 1
+#endif
+
+// Also reuse the last DHCP lease as a static config on the fast path. Saves
+// the DHCP exchange but assumes the router keeps the address reserved.
+#ifndef WIFI_REUSE_DHCP_LEASE
+#define WIFI_REUSE_DHCP_LEASE 0
+#endif
+
 #ifndef AMOLED_PANEL_WAVESHARE
 #define AMOLED_PANEL_WAVESHARE 0
 #endif
@@ -60,10 +78,106 @@
 #define TOUCH_IDLE_SLEEP_MS (15UL * 60UL * 1000UL)
 #endif
 
+// Once the idle timeout has put the device into deep sleep, wake every
+// DUTY_CYCLE_WAKE_S seconds, show the retained flight, fetch once and sleep
+// again; a touch during such a wake keeps the device awake. 0 sleeps until
+// touched.
+#ifndef DUTY_CYCLE_WAKE_S
+#define DUTY_CYCLE_WAKE_S 0
+#endif
+
+// Longest a timer wake may stay up waiting for its fetch.
+#ifndef DUTY_CYCLE_BUDGET_MS
+#define DUTY_CYCLE_BUDGET_MS 8000
+#endif
+
 #ifndef BATTERY_UI_UPDATE_MS
 #define BATTERY_UI_UPDATE_MS 5000
 #endif
 
+// 1 lets the UI loop block until LVGL's next timer deadline or a wake-up
+// from the fetch task; 0 polls lv_timer_handler() every 5 ms.
+#ifndef UI_IDLE_SLEEP
+#define UI_IDLE_SLEEP 1
+#endif
+
+// Upper bound on one idle wait, so button, touch and Wi-Fi checks in the
+// loop still run at a steady rate.
+#ifndef UI_LOOP_MAX_SLEEP_MS
+#define UI_LOOP_MAX_SLEEP_MS 50
+#endif
+
+// Loop period while a brightness ramp is in progress.
+#ifndef BRIGHTNESS_RAMP_TICK_MS
+#define BRIGHTNESS_RAMP_TICK_MS 8
+#endif
+
+// 1 keeps the radio in modem sleep between polls (listening every
+// WIFI_LISTEN_INTERVAL beacons), scales the CPU clock down when idle and,
+// with POWER_SAVE_LIGHT_SLEEP, lets the chip light-sleep between deadlines.
+// Costs some request latency; meant for battery use.
+#ifndef POWER_SAVE
+#define POWER_SAVE 0
+#endif
+
+#ifndef POWER_SAVE_LIGHT_SLEEP
+#define POWER_SAVE_LIGHT_SLEEP 1
+#endif
+
+#ifndef POWER_SAVE_CPU_MAX_MHZ
+#define POWER_SAVE_CPU_MAX_MHZ 240
+#endif
+
+#ifndef POWER_SAVE_CPU_MIN_MHZ
+#define POWER_SAVE_CPU_MIN_MHZ 80
+#endif
+
+#ifndef WIFI_LISTEN_INTERVAL
+#define WIFI_LISTEN_INTERVAL 3
+#endif
+
+// Current draw of the SoC and radio (display excluded) used for the energy
+// estimate in diagnostics. Rough ESP32-S3 datasheet figures.
+#ifndef POWER_EST_SUPPLY_MV
+#define POWER_EST_SUPPLY_MV 3700
+#endif
+
+#ifndef POWER_EST_FETCH_MA
+#define POWER_EST_FETCH_MA 110
+#endif
+
+#ifndef POWER_EST_RADIO_ON_MA
+#define POWER_EST_RADIO_ON_MA 95
+#endif
+
+#ifndef POWER_EST_CPU_MA
+#define POWER_EST_CPU_MA 45
+#endif
+
+#ifndef POWER_EST_MODEM_SLEEP_MA
+#define POWER_EST_MODEM_SLEEP_MA 22
+#endif
+
+#ifndef POWER_EST_LIGHT_SLEEP_MA
+#define POWER_EST_LIGHT_SLEEP_MA 3
+#endif
+
+// AMOLED draw: a fixed part for the driver IC, plus a full-white screen at
+// maximum brightness scaled by brightness and the frame's picture level.
+#ifndef POWER_EST_DISPLAY_BASE_MA
+#define POWER_EST_DISPLAY_BASE_MA 6
+#endif
+
+#ifndef POWER_EST_DISPLAY_WHITE_MA
+#define POWER_EST_DISPLAY_WHITE_MA 140
+#endif
+
+// 1 switches to a darker theme (black panels, dimmer greens, outlined LEDs)
+// while running from the battery; needs the PMU to tell VBUS is absent.
+#ifndef LOW_POWER_THEME
+#define LOW_POWER_THEME 1
+#endif
+
 #ifndef SLEEP_BUTTON_PIN
 #define SLEEP_BUTTON_PIN 0
 #endif
@@ -71,3 +185,25 @@
 #ifndef SLEEP_HOLD_MS
 #define SLEEP_HOLD_MS 1500
 #endif
+
+// LVGL draw buffers: 0 renders full frames in PSRAM (direct mode); N > 0 uses
+// two N-line stripes in internal DMA-capable SRAM and flushes only dirty areas.
+#ifndef LVGL_DRAW_BUF_LINES
+#define LVGL_DRAW_BUF_LINES 0
+#endif
+
+#if LVGL_DRAW_BUF_LINES % 2
+#error "LVGL_DRAW_BUF_LINES must be even for the panel's 2x2 update alignment"
+#endif
+
+// 1 hands each flushed area to the panel's transfer task so LVGL can render
+// into the other buffer while the previous one is still on the bus.
+#ifndef LVGL_ASYNC_FLUSH
+#define LVGL_ASYNC_FLUSH 1
+#endif
+
+// 1 trims invalidated areas to the round panel's visible circle and pushes
+// only the in-circle span of each 2-row band, skipping the square's corners.
+#ifndef DISPLAY_CIRCLE_CLIP
+#define DISPLAY_CIRCLE_CLIP 1
+#endif
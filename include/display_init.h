@@ -1,8 +1,11 @@
 #pragma once
 
-#include <Arduino_GFX_Library.h>
 #include "app_types.h"
-#include "display/drivers/AmoledDisplay/Amoled_DisplayPanel.h"
+
+// Callers that use the panel or GFX object include their headers; the UI
+// only needs the functions here, which keeps it buildable off-target.
+class Amoled_DisplayPanel;
+class Arduino_GFX;
 
 bool displayInit();
 DisplayState displayGetState();
@@ -10,4 +13,8 @@ DisplayMetrics displayGetMetrics();
 Amoled_DisplayPanel &displayPanel();
 Arduino_GFX *displayGfx();
 bool displayIsReady();
+DisplayPower displayGetPower();
 void displaySetBrightness(uint8_t level);
+// Advances a brightness ramp and the battery sampler; true while a ramp is
+// still running.
+bool displayTick();
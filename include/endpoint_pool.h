@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Arduino.h>
+
+#ifndef ENDPOINT_MAX
+#define ENDPOINT_MAX 4
+#endif
+
+#ifndef ENDPOINT_RECENT_SAMPLES
+#define ENDPOINT_RECENT_SAMPLES 16
+#endif
+
+// Health of one aggregator mirror. Latency is tracked as an EWMA for ranking
+// and as a small ring of recent samples for the hedge (p90) threshold.
+struct EndpointStats {
+  const char *base = nullptr;
+  float ewmaMs = 0;
+  float errorRate = 0;
+  uint8_t consecutiveFailures = 0;
+  uint32_t cooldownUntilMs = 0;
+  uint32_t successes = 0;
+  uint32_t failures = 0;
+  uint32_t hedgesFired = 0;
+  uint32_t hedgeWins = 0;
+  uint16_t recentMs[ENDPOINT_RECENT_SAMPLES] = {0};
+  uint8_t recentCount = 0;
+  uint8_t recentNext = 0;
+};
+
+size_t endpointPoolCount();
+const char *endpointPoolBase(size_t idx);
+size_t endpointPoolRank(size_t *order, size_t maxOrder, uint32_t nowMs);
+void endpointPoolRecordSuccess(size_t idx, uint32_t latencyMs);
+void endpointPoolRecordFailure(size_t idx, uint32_t nowMs);
+void endpointPoolRecordHedge(size_t idx, bool won);
+uint32_t endpointPoolHedgeDelayMs(size_t idx);
+bool endpointPoolGetStats(size_t idx, EndpointStats &out);
+// Forgets every latency sample, failure and cooldown.
+void endpointPoolReset();
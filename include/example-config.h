@@ -6,6 +6,11 @@
 // Wi-Fi
 #define WIFI_SSID "SSID"
 #define WIFI_PASSWORD "PASSWORD"
+// Optional static IPv4 setup; skips DHCP on every connect.
+// #define WIFI_STATIC_IP "192.168.1.60"
+// #define WIFI_STATIC_GATEWAY "192.168.1.1"
+// #define WIFI_STATIC_NETMASK "255.255.255.0"
+// #define WIFI_STATIC_DNS "192.168.1.1"
 
 // Location and search radius (km)
 #define HOME_LAT 00.0000
@@ -14,6 +19,18 @@
 
 // API base (https enabled)
 #define API_BASE "https://api.adsb.lol"
+// Optional compatible mirrors for the /v2/lat/.../lon/.../dist/... query,
+// ranked by measured latency and error rate (first entry is the primary).
+// #define API_BASE_MIRRORS "https://api.adsb.lol", "https://opendata.adsb.fi/api"
+// HexDB base; point this and API_BASE at tools/replay_server.py to run offline.
+// #define HEXDB_BASE "https://hexdb.io"
+
+// Streaming ingest (local receiver). STREAM_FORMAT selects SBS-1 (30003),
+// Beast binary (30005) or AVR text (30002).
+// #define FEATURE_STREAM_INGEST 1
+// #define STREAM_FORMAT STREAM_FORMAT_SBS
+// #define STREAM_HOST "192.168.1.50"
+// #define STREAM_PORT 30003
 
 // AMOLED panel selection
 // Set exactly one of these to 1.
@@ -6,6 +6,35 @@ bool flightEnrichmentIsMilitaryCached(const String &hex, bool &outIsMil);
 void flightEnrichmentStoreMilitary(const String &hex, bool isMil);
 bool flightEnrichmentFetchIsMilitary(const String &hex, bool &outIsMil);
 bool flightEnrichmentFetchMilList(const String *hexes, size_t count, bool *outIsMil);
+// ICAO addresses compare as up to six hex digits, ignoring case and any
+// non-hex marker such as the leading '~' of non-ICAO addresses.
+bool flightEnrichmentParseHex(const String &hex, uint32_t &out);
+
+constexpr size_t kMilLookupMax = 48;
+
+// Matches the "hex" entries of a /v2/mil response against up to
+// kMilLookupMax candidates as the body streams in, without buffering it.
+// outIsMil[i] is set for every candidate found; the caller clears it first.
+class MilListMatcher {
+ public:
+  MilListMatcher(const String *hexes, size_t count, bool *outIsMil);
+  void feed(const char *buf, size_t n);
+  bool done() const { return _found >= _count; }
+  uint32_t entries() const { return _entries; }
+
+ private:
+  void consumeHex();
+
+  uint32_t _cand[kMilLookupMax];
+  bool *_outIsMil;
+  size_t _count;
+  size_t _found = 0;
+  uint32_t _entries = 0;
+  uint32_t _curHex = 0;
+  uint8_t _curDigits = 0;
+  uint8_t _match = 0;
+  bool _inHex = false;
+};
 
 bool flightEnrichmentLookupHexDb(const String &hex, String &outName, String &outType,
                                  String &outOwner);
@@ -14,3 +43,10 @@ bool flightEnrichmentLookupRoute(const String &callsign, double lat, double lon,
                                  String &outRoute);
 
 String flightEnrichmentClassifyOp(const FlightInfo &fi);
+
+// The MIL cache and the most recent HexDB entries are mirrored into RTC
+// memory so a deep-sleep wake does not refetch them. Save runs on the fetch
+// task after a fetch (a no-op unless a cache changed); restore runs before
+// the fetch task starts and ages entries by the time spent asleep.
+void flightEnrichmentSaveHot();
+void flightEnrichmentRestoreHot(uint32_t sleptMs);
@@ -3,6 +3,8 @@
 #include <ArduinoJson.h>
 #include "app_types.h"
 
+double flightParserHomeDistanceKm(double lat, double lon);
+double flightParserHomeBearingDeg(double lat, double lon);
 bool flightParserExtractLatLon(JsonObject obj, double &outLat, double &outLon);
 bool flightParserParseAircraft(JsonObject obj, FlightInfo &out);
 FlightInfo flightParserParseClosest(JsonVariant root);
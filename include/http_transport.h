@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+
+#ifndef HTTP_POOL_SLOTS
+#define HTTP_POOL_SLOTS 3
+#endif
+
+#ifndef DNS_CACHE_SIZE
+#define DNS_CACHE_SIZE 6
+#endif
+
+struct HttpTransportStats {
+  uint32_t dnsHits = 0;
+  uint32_t dnsMisses = 0;
+  uint32_t dnsFailures = 0;
+  uint32_t prewarms = 0;
+  uint32_t warmRequests = 0;
+  uint32_t coldRequests = 0;
+  uint32_t warmTtfbMsTotal = 0;
+  uint32_t coldTtfbMsTotal = 0;
+  uint32_t coldConnectMsTotal = 0;
+  uint32_t connectFailures = 0;
+  uint32_t fullHandshakes = 0;
+  uint32_t resumedHandshakes = 0;
+  uint32_t fullHandshakeMsTotal = 0;
+  uint32_t resumedHandshakeMsTotal = 0;
+};
+
+// Connection setup phases of a cold request; all zero for a warm lease.
+struct HttpConnectTiming {
+  uint32_t dnsUs = 0;
+  uint32_t tcpUs = 0;
+  uint32_t tlsUs = 0;
+};
+
+// A connected TLS client borrowed from the per-host pool. The slot is handed
+// back when the lease goes out of scope; a warm lease reuses a connection
+// opened ahead of time by httpTransportPrewarm().
+class HttpLease {
+ public:
+  HttpLease() = default;
+  ~HttpLease();
+  HttpLease(const HttpLease &) = delete;
+  HttpLease &operator=(const HttpLease &) = delete;
+
+  WiFiClientSecure &client() { return *_client; }
+  bool warm() const { return _warm; }
+  const HttpConnectTiming &timing() const { return _timing; }
+  void recordTtfb(uint32_t ttfbMs);
+
+ private:
+  friend bool httpTransportAcquire(const String &url, HttpLease &lease, uint32_t connectTimeoutMs);
+  WiFiClientSecure *_client = nullptr;
+  int8_t _slot = -1;
+  bool _warm = false;
+  HttpConnectTiming _timing;
+};
+
+bool httpTransportResolve(const char *host, IPAddress &out);
+bool httpTransportAcquire(const String &url, HttpLease &lease, uint32_t connectTimeoutMs);
+bool httpTransportPrewarm(const String &url, uint32_t connectTimeoutMs);
+HttpTransportStats httpTransportGetStats();
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <Arduino.h>
+
+#ifndef LATENCY_HIST_BUCKETS
+#define LATENCY_HIST_BUCKETS 18
+#endif
+
+// Fixed-bucket histogram. `bounds` holds the inclusive upper edge of each
+// bucket except the last, which collects everything above; units are up to
+// the caller. Percentiles report the upper edge of the bucket that holds the
+// requested rank (capped at the largest value seen).
+struct LatencyHistogram {
+  uint32_t counts[LATENCY_HIST_BUCKETS] = {0};
+  uint32_t samples = 0;
+  uint32_t maxValue = 0;
+};
+
+void latencyHistogramAdd(LatencyHistogram &h, const uint32_t *bounds, uint32_t value);
+uint32_t latencyHistogramPercentile(const LatencyHistogram &h, const uint32_t *bounds,
+                                    uint8_t pct);
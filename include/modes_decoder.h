@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef MODES_CPR_PAIR_MAX_MS
+#define MODES_CPR_PAIR_MAX_MS 10000
+#endif
+
+#ifndef MODES_LOCAL_REF_MAX_MS
+#define MODES_LOCAL_REF_MAX_MS 60000
+#endif
+
+#ifndef MODES_MAX_RANGE_KM
+#define MODES_MAX_RANGE_KM 300
+#endif
+
+constexpr uint8_t kModesShortBytes = 7;
+constexpr uint8_t kModesLongBytes = 14;
+
+enum class ModesFeedFormat : uint8_t { Beast, Avr };
+
+typedef void (*ModesFrameCallback)(const uint8_t *msg, uint8_t len, void *ctx);
+
+// Incremental framer for raw Mode-S feeds: Beast binary (port 30005, 0x1A
+// escaped) or AVR text (port 30002, "*...;" / "@<ts>...;" lines).
+struct ModesFramer {
+  ModesFeedFormat format = ModesFeedFormat::Beast;
+  uint8_t state = 0;
+  uint8_t need = 0;
+  uint8_t pos = 0;
+  uint8_t skip = 0;
+  uint8_t nibble = 0;
+  bool escaped = false;
+  bool emit = false;
+  uint8_t buf[kModesLongBytes];
+  uint32_t frames = 0;
+  uint32_t dropped = 0;
+};
+
+struct ModesStats {
+  uint32_t frames = 0;
+  uint32_t crcErrors = 0;
+  uint32_t ignored = 0;
+  uint32_t idents = 0;
+  uint32_t positionsGlobal = 0;
+  uint32_t positionsLocal = 0;
+  uint32_t positionsRejected = 0;
+  uint32_t velocities = 0;
+};
+
+void modesFramerReset(ModesFramer &framer, ModesFeedFormat format);
+void modesFramerFeed(ModesFramer &framer, const uint8_t *data, size_t len, ModesFrameCallback cb,
+                     void *ctx);
+
+uint32_t modesCrc(const uint8_t *msg, uint8_t len);
+int modesCprNL(double lat);
+bool modesCprGlobal(uint32_t evenLat, uint32_t evenLon, uint32_t oddLat, uint32_t oddLon,
+                    bool oddNewest, bool surface, double refLat, double refLon, double &outLat,
+                    double &outLon);
+bool modesCprLocal(uint32_t cprLat, uint32_t cprLon, bool odd, bool surface, double refLat,
+                   double refLon, double &outLat, double &outLon);
+
+// Decodes one DF17/DF18 extended squitter and applies it to the shared
+// aircraft table. Returns true when the table was updated.
+bool modesDecodeFrame(const uint8_t *msg, uint8_t len, uint32_t nowMs);
+ModesStats modesGetStats();
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "latency_histogram.h"
+
+class HttpLease;
+
+enum class NetEndpoint : uint8_t { AircraftList, MilList, HexDb, Route, Count };
+enum class NetPhase : uint8_t { Dns, Connect, Tls, Ttfb, Body, Parse, Total, Count };
+
+constexpr size_t kNetEndpointCount = (size_t)NetEndpoint::Count;
+constexpr size_t kNetPhaseCount = (size_t)NetPhase::Count;
+
+// Stream wrapper that accumulates the time spent waiting in reads, so a
+// streamed parse can be split into body transfer and parser time. Bytes
+// consumed are counted as well.
+class TimedStream : public Stream {
+ public:
+  // Once *abort turns true the stream reads as ended, which stops a parse
+  // in progress at the next read.
+  explicit TimedStream(Stream &inner, const volatile bool *abort = nullptr)
+      : _inner(inner), _abort(abort) {}
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t readBytes(char *buffer, size_t length) override;
+  using Stream::readBytes;
+  size_t write(uint8_t) override { return 0; }
+  void flush() override {}
+  uint32_t busyUs() const { return _busyUs; }
+  uint32_t bytes() const { return _bytes; }
+
+ private:
+  bool aborted() const { return _abort && *_abort; }
+
+  Stream &_inner;
+  const volatile bool *_abort;
+  uint32_t _busyUs = 0;
+  uint32_t _bytes = 0;
+};
+
+// Phase timestamps for one request, recorded into the per-endpoint
+// histograms when it goes out of scope. Total is only recorded for requests
+// marked ok; phases that never ran are left out.
+class NetPhaseTimer {
+ public:
+  explicit NetPhaseTimer(NetEndpoint endpoint);
+  ~NetPhaseTimer();
+  NetPhaseTimer(const NetPhaseTimer &) = delete;
+  NetPhaseTimer &operator=(const NetPhaseTimer &) = delete;
+
+  void connected(const HttpLease &lease);
+  void mark(NetPhase phase);
+  void markStream(const TimedStream &stream);
+  // Response body bytes read without a TimedStream.
+  void addBytes(size_t bytes) { _bytes += bytes; }
+  void ok() { _ok = true; }
+
+ private:
+  NetEndpoint _endpoint;
+  uint32_t _startUs;
+  uint32_t _lastUs;
+  uint32_t _phaseUs[kNetPhaseCount];
+  bool _seen[kNetPhaseCount];
+  uint32_t _bytes = 0;
+  bool _ok = false;
+};
+
+const char *netEndpointName(NetEndpoint endpoint);
+const char *netPhaseName(NetPhase phase);
+// Phase histograms are in milliseconds.
+bool netTimingGet(NetEndpoint endpoint, NetPhase phase, LatencyHistogram &out);
+uint32_t netTimingPercentile(const LatencyHistogram &h, uint8_t pct);
+// Response body bytes read since boot, over all endpoints.
+uint64_t netTimingBytesRead();
+void netTimingReset();
+void netTimingPrint(Print &out);
@@ -1,5 +1,34 @@
 #pragma once
 
+#include <ArduinoJson.h>
+
 #include "app_types.h"
+#include "radar_targets.h"
+
+// One pass over an aircraft list: the closest airborne and grounded targets,
+// plus every aircraft with a hex address as a MIL lookup candidate (up to
+// candCap of them, in list order).
+struct AircraftScan {
+  FlightInfo bestAir;
+  FlightInfo bestGround;
+  bool hasAir = false;
+  bool hasGround = false;
+  size_t parsed = 0;
+  MilCandidate *cands = nullptr;
+  size_t candCap = 0;
+  size_t candCount = 0;
+  bool candTruncated = false;
+};
 
+// False when a HexDB or route lookup was attempted and failed, so callers
+// that cache the result know to retry it.
+bool networkClientEnrichFlight(FlightInfo &fi, bool allowEnrichment);
+void networkClientPrewarm();
 bool networkClientFetchNearestFlight(FlightInfo &out, bool allowEnrichment = true);
+// Resolves isMil for each candidate (MIL cache first, then, when allowFetch,
+// one /v2/mil request for the rest) and returns the nearest airborne military
+// one, if any.
+bool networkClientNearestMilitary(MilCandidate *cands, size_t count, bool allowFetch,
+                                  FlightInfo &out);
+// radar, when given, is offered every parsed aircraft.
+void networkClientScanAircraft(JsonArray ac, AircraftScan &scan, RadarSnapshot *radar);
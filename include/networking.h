@@ -2,7 +2,24 @@
 
 #include "app_types.h"
 
+// Time spent inside fetches (or stream selections) since boot.
+struct NetworkingFetchStats {
+  uint32_t fetches = 0;
+  uint64_t activeUs = 0;
+};
+
+struct NetworkingWifiStats {
+  uint32_t fastConnects = 0;   // cached BSSID/channel
+  uint32_t slowConnects = 0;   // full scan
+  uint32_t fastFailures = 0;
+  uint32_t lastConnectMs = 0;  // connect call to IP
+  uint64_t fastConnectMsTotal = 0;
+  uint64_t slowConnectMsTotal = 0;
+};
+
 void networkingInit();
 void networkingStartFetchTask();
 void networkingEnsureConnected();
 bool networkingGetLatest(FlightInfo &out, bool &outValid, uint32_t &outSeq);
+NetworkingFetchStats networkingGetFetchStats();
+NetworkingWifiStats networkingGetWifiStats();
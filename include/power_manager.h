@@ -8,7 +8,19 @@ struct PowerManagerState {
   uint32_t sleepHoldStartMs = 0;
   uint8_t lastBrightness = 0;
   bool lastTouch = false;
+  bool dutyWake = false;  // timer wake: sleep again after one fetch
+  bool dutyFetchDone = false;
 };
 
+enum class PowerSaveMode : uint8_t { Off, ModemSleep, LightSleep };
+
 void powerManagerInit(PowerManagerState &state);
+// Applies POWER_SAVE once the display and Wi-Fi are up; falls back to modem
+// sleep alone when the core cannot light-sleep.
+void powerSaveInit();
+PowerSaveMode powerSaveMode();
+const char *powerSaveModeName(PowerSaveMode mode);
 void powerManagerTick(PowerManagerState &state, const FlightInfo *lastShown);
+// Reports a published fetch result; ends a timer wake once it succeeded or
+// Wi-Fi was up for the attempt.
+void powerManagerFetchDone(PowerManagerState &state, bool ok);
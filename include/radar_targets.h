@@ -0,0 +1,24 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "config_features.h"
+
+struct RadarBlip {
+  uint32_t id = 0;  // ICAO address, stable across updates
+  float bearingDeg = 0;
+  float rangeKm = 0;
+  float trackDeg = NAN;
+  bool airborne = false;
+};
+
+// The nearest aircraft around HOME, sorted by range.
+struct RadarSnapshot {
+  RadarBlip blips[RADAR_MAX_BLIPS];
+  uint8_t count = 0;
+};
+
+void radarSnapshotOffer(RadarSnapshot &snap, uint32_t id, double lat, double lon, float trackDeg,
+                        bool airborne);
+void radarTargetsPublish(const RadarSnapshot &snap);
+bool radarTargetsGetLatest(RadarSnapshot &out, uint32_t &outSeq);
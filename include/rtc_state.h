@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "app_types.h"
+
+// Per-wake duty-cycle accounting, kept across deep sleep.
+struct RtcDutyStats {
+  uint32_t wakes = 0;
+  uint32_t overBudget = 0;
+  uint32_t lastAwakeMs = 0;
+  uint64_t totalAwakeMs = 0;
+};
+
+// Where the station last associated and the lease it got (IPv4, network
+// byte order as in esp_netif).
+struct RtcWifiHint {
+  uint8_t bssid[6] = {};
+  uint8_t channel = 0;
+  uint32_t ip = 0;
+  uint32_t gateway = 0;
+  uint32_t netmask = 0;
+  uint32_t dns = 0;
+};
+
+// State carried across deep sleep in RTC slow memory: the last flight shown,
+// the access point the station last associated with, and duty-cycle
+// counters. Everything is lost on power-off or a non-sleep reset.
+void rtcStateInit();
+// True when this boot is a deep-sleep timer wake-up (not touch or button).
+bool rtcStateTimerWake();
+// Time spent in deep sleep before this boot; 0 after a cold boot.
+uint32_t rtcStateSleptMs();
+// Call right before entering deep sleep.
+void rtcStateMarkSleep();
+
+void rtcStateSaveFlight(const FlightInfo &fi);
+bool rtcStateLoadFlight(FlightInfo &out);
+
+void rtcStateSaveWifi(const RtcWifiHint &hint);
+bool rtcStateLoadWifi(RtcWifiHint &out);
+void rtcStateForgetWifi();
+
+void rtcStateRecordDutyWake(uint32_t awakeMs, bool overBudget);
+RtcDutyStats rtcStateGetDutyStats();
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef SBS_LINE_MAX
+#define SBS_LINE_MAX 192
+#endif
+
+// One decoded BaseStation "MSG,<1..8>" line. Only fields present in the line
+// are flagged; absent fields leave the tracked aircraft untouched.
+struct SbsMessage {
+  uint8_t transmissionType = 0;
+  uint32_t icao = 0;
+  bool nonIcao = false;  // '~'-prefixed address (TIS-B, anonymous, ground vehicles)
+  char callsign[9] = {0};
+  long altitudeFt = -1;
+  double lat = NAN;
+  double lon = NAN;
+  float groundSpeedKt = NAN;
+  float trackDeg = NAN;
+  uint16_t squawk = 0;
+  bool onGround = false;
+  bool hasCallsign = false;
+  bool hasAltitude = false;
+  bool hasPosition = false;
+  bool hasVelocity = false;
+  bool hasSquawk = false;
+  bool hasGround = false;
+};
+
+typedef void (*SbsMessageCallback)(const SbsMessage &msg, void *ctx);
+
+// Incremental line assembler for the port 30003 stream. Bytes can be fed in
+// arbitrary chunks; each complete line is tokenized in place.
+struct SbsParser {
+  char line[SBS_LINE_MAX];
+  size_t len = 0;
+  bool overflow = false;
+  uint32_t lines = 0;
+  uint32_t messages = 0;
+  uint32_t rejected = 0;
+};
+
+void sbsParserReset(SbsParser &parser);
+void sbsParserFeed(SbsParser &parser, const uint8_t *data, size_t len, SbsMessageCallback cb,
+                   void *ctx);
+bool sbsParseLine(char *line, size_t len, SbsMessage &out);
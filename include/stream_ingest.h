@@ -0,0 +1,17 @@
+#pragma once
+
+#include "app_types.h"
+
+struct StreamIngestStats {
+  uint32_t bytes = 0;
+  uint32_t messages = 0;
+  uint32_t rejected = 0;
+  uint32_t connects = 0;
+  size_t tracked = 0;
+  bool connected = false;
+};
+
+void streamIngestInit();
+void streamIngestService();
+bool streamIngestSelect(FlightInfo &out, bool allowEnrichment);
+StreamIngestStats streamIngestGetStats();
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <Arduino.h>
+#include <mbedtls/ssl.h>
+
+#ifndef TLS_SESSION_SLOTS
+#define TLS_SESSION_SLOTS 3
+#endif
+
+#ifndef TLS_SESSION_BLOB_MAX
+#define TLS_SESSION_BLOB_MAX 512
+#endif
+
+// Per-host TLS sessions (ticket or session ID), serialized into RTC memory so
+// they survive deep sleep. Sessions are stored without the peer certificate;
+// the server decides whether a resumption is still acceptable.
+bool tlsSessionLoad(const char *host, mbedtls_ssl_session &out);
+void tlsSessionStore(const char *host, mbedtls_ssl_session &session);
+void tlsSessionForget(const char *host);
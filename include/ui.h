@@ -1,10 +1,37 @@
 #pragma once
 
 #include "app_types.h"
+#include "radar_targets.h"
+
+// Widget updates since boot. A widget counts as changed when its text or
+// style had to be set; invalidated pixels are the areas LVGL was asked to
+// repaint while the update ran.
+struct UiRenderStats {
+  uint32_t updates = 0;
+  uint32_t widgetsChanged = 0;
+  uint32_t widgetsUnchanged = 0;
+  uint64_t invalidatedPixels = 0;
+  uint32_t lastInvalidatedPixels = 0;
+};
+
+// Text of the flight card; filled without touching any widget.
+struct UiFlightText {
+  String title;
+  String subtitle;
+  String route;
+  char dist[16];
+  char seats[12];
+  char alt[16];
+};
 
 UiState uiInit(const DisplayMetrics &metrics);
+// Also switches to the low-power theme while on battery (LOW_POWER_THEME).
 void uiUpdateBattery(const UiState &state);
+bool uiLowPowerTheme();
 void uiRenderSplash(const UiState &state, const char *title, const char *subtitle);
 void uiRenderNoData(const UiState &state, const char *detail);
+void uiFormatFlight(const FlightInfo &fi, UiFlightText &out);
 void uiRenderFlight(const UiState &state, const FlightInfo &fi);
+void uiRenderRadar(const UiState &state, const RadarSnapshot &snap);
 bool uiIsReady(const UiState &state);
+UiRenderStats uiGetRenderStats();
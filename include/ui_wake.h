@@ -0,0 +1,11 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Lets the UI loop block until its next deadline while other tasks (and
+// ISRs) can cut the wait short when they publish something to show.
+void uiWakeInit();
+void uiWake();
+void uiWakeFromIsr();
+// Blocks the calling (UI) task for up to maxMs; returns true when woken early.
+bool uiWakeWait(uint32_t maxMs);
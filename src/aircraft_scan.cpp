@@ -0,0 +1,51 @@
+// networkClientScanAircraft, kept apart from the HTTP code in network_client
+// so it builds on the host.
+#include "network_client.h"
+
+#include <Arduino.h>
+
+#include "aircraft_table.h"
+#include "flight_enrichment.h"
+#include "flight_parser.h"
+
+// Radar ids are the 24-bit address, with bit 24 set for non-ICAO ('~')
+// addresses so they never share an id with the ICAO address of the same digits.
+static uint32_t radarIdForHex(const String &hex) {
+  uint32_t id = 0;
+  if (!flightEnrichmentParseHex(hex, id)) return 0;
+  return hex.startsWith("~") ? id | kAircraftNonIcao : id;
+}
+
+void networkClientScanAircraft(JsonArray ac, AircraftScan &scan, RadarSnapshot *radar) {
+  for (JsonVariant v : ac) {
+    if (!v.is<JsonObject>()) continue;
+    FlightInfo fi;
+    if (!flightParserParseAircraft(v.as<JsonObject>(), fi)) continue;
+    ++scan.parsed;
+    bool inFlight = fi.altitudeFt > 0;
+    if (radar) {
+      radarSnapshotOffer(*radar, radarIdForHex(fi.hex), fi.lat, fi.lon, fi.trackDeg, inFlight);
+    }
+    if (inFlight) {
+      if (!scan.hasAir || fi.distanceKm < scan.bestAir.distanceKm) {
+        scan.bestAir = fi;
+        scan.hasAir = true;
+      }
+    } else {
+      if (!scan.hasGround || fi.distanceKm < scan.bestGround.distanceKm) {
+        scan.bestGround = fi;
+        scan.hasGround = true;
+      }
+    }
+    if (fi.hex.length()) {
+      if (scan.candCount < scan.candCap) {
+        MilCandidate &c = scan.cands[scan.candCount++];
+        c.fi = fi;
+        c.inFlight = inFlight;
+        c.isMil = false;
+      } else {
+        scan.candTruncated = true;
+      }
+    }
+  }
+}
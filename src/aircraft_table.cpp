@@ -0,0 +1,168 @@
+#include "aircraft_table.h"
+
+#include <Arduino.h>
+#include <math.h>
+
+#include "config_features.h"
+#include "flight_parser.h"
+
+static TrackedAircraft g_table[AIRCRAFT_TABLE_SIZE];
+// Guards slot allocation so the count can be read from the other core while
+// the ingest task adds and expires entries.
+static portMUX_TYPE g_tableMux = portMUX_INITIALIZER_UNLOCKED;
+
+TrackedAircraft *aircraftTableFind(uint32_t icao) {
+  if (icao == 0) return nullptr;
+  for (size_t i = 0; i < AIRCRAFT_TABLE_SIZE; ++i) {
+    if (g_table[i].icao == icao) return &g_table[i];
+  }
+  return nullptr;
+}
+
+TrackedAircraft *aircraftTableUpsert(uint32_t icao, uint32_t nowMs) {
+  if (icao == 0) return nullptr;
+  size_t slot = 0;
+  uint32_t oldestAge = 0;
+  bool haveFree = false;
+  portENTER_CRITICAL(&g_tableMux);
+  for (size_t i = 0; i < AIRCRAFT_TABLE_SIZE; ++i) {
+    if (g_table[i].icao == icao) {
+      g_table[i].lastSeenMs = nowMs;
+      portEXIT_CRITICAL(&g_tableMux);
+      return &g_table[i];
+    }
+    if (haveFree) continue;
+    if (g_table[i].icao == 0) {
+      slot = i;
+      haveFree = true;
+      continue;
+    }
+    uint32_t age = nowMs - g_table[i].lastSeenMs;
+    if (age >= oldestAge) {
+      oldestAge = age;
+      slot = i;
+    }
+  }
+  g_table[slot] = TrackedAircraft{};
+  g_table[slot].icao = icao;
+  g_table[slot].lastSeenMs = nowMs;
+  portEXIT_CRITICAL(&g_tableMux);
+  return &g_table[slot];
+}
+
+void aircraftTableExpire(uint32_t nowMs) {
+  portENTER_CRITICAL(&g_tableMux);
+  for (size_t i = 0; i < AIRCRAFT_TABLE_SIZE; ++i) {
+    if (g_table[i].icao == 0) continue;
+    if (nowMs - g_table[i].lastSeenMs >= AIRCRAFT_TABLE_EXPIRE_MS) {
+      g_table[i] = TrackedAircraft{};
+    }
+  }
+  portEXIT_CRITICAL(&g_tableMux);
+}
+
+size_t aircraftTableCount() {
+  size_t n = 0;
+  portENTER_CRITICAL(&g_tableMux);
+  for (size_t i = 0; i < AIRCRAFT_TABLE_SIZE; ++i) {
+    if (g_table[i].icao != 0) ++n;
+  }
+  portEXIT_CRITICAL(&g_tableMux);
+  return n;
+}
+
+void aircraftTableApplySbs(const SbsMessage &msg, uint32_t nowMs) {
+  TrackedAircraft *ac = aircraftTableUpsert(msg.nonIcao ? msg.icao | kAircraftNonIcao : msg.icao,
+                                            nowMs);
+  if (!ac) return;
+  if (msg.hasCallsign) {
+    memcpy(ac->callsign, msg.callsign, sizeof(ac->callsign));
+  }
+  if (msg.hasAltitude) ac->altitudeFt = msg.altitudeFt;
+  if (msg.hasPosition) {
+    ac->lat = msg.lat;
+    ac->lon = msg.lon;
+    ac->lastPosMs = nowMs;
+  }
+  if (msg.hasVelocity) {
+    if (!isnan(msg.groundSpeedKt)) ac->groundSpeedKt = msg.groundSpeedKt;
+    if (!isnan(msg.trackDeg)) ac->trackDeg = msg.trackDeg;
+  }
+  if (msg.hasSquawk) ac->squawk = msg.squawk;
+  if (msg.hasGround) ac->onGround = msg.onGround;
+}
+
+void aircraftTableToFlightInfo(const TrackedAircraft &ac, FlightInfo &out) {
+  char hex[8];
+  snprintf(hex, sizeof(hex), "%s%06lx", (ac.icao & kAircraftNonIcao) ? "~" : "",
+           (unsigned long)(ac.icao & 0xFFFFFF));
+
+  out = FlightInfo{};
+  out.valid = true;
+  out.hex = String(hex);
+  out.hasCallsign = ac.callsign[0] != '\0';
+  out.ident = out.hasCallsign ? String(ac.callsign) : String(hex);
+  out.ident.trim();
+  out.altitudeFt = ac.onGround ? 0 : ac.altitudeFt;
+  out.lat = ac.lat;
+  out.lon = ac.lon;
+  if (!isnan(ac.lat) && !isnan(ac.lon)) {
+    out.distanceKm = flightParserHomeDistanceKm(ac.lat, ac.lon);
+  }
+  out.trackDeg = ac.trackDeg;
+}
+
+bool aircraftTableNearest(FlightInfo &out, uint32_t nowMs) {
+  const TrackedAircraft *bestAir = nullptr;
+  const TrackedAircraft *bestGround = nullptr;
+  double bestAirKm = 0;
+  double bestGroundKm = 0;
+
+  for (size_t i = 0; i < AIRCRAFT_TABLE_SIZE; ++i) {
+    const TrackedAircraft &ac = g_table[i];
+    if (ac.icao == 0 || isnan(ac.lat) || isnan(ac.lon)) continue;
+    if (nowMs - ac.lastPosMs > (uint32_t)POSITION_MAX_AGE_S * 1000UL) continue;
+    double km = flightParserHomeDistanceKm(ac.lat, ac.lon);
+    bool inFlight = !ac.onGround && ac.altitudeFt > 0;
+    if (inFlight) {
+      if (!bestAir || km < bestAirKm) {
+        bestAir = &ac;
+        bestAirKm = km;
+      }
+    } else {
+      if (!bestGround || km < bestGroundKm) {
+        bestGround = &ac;
+        bestGroundKm = km;
+      }
+    }
+  }
+
+  const TrackedAircraft *best = bestAir ? bestAir : bestGround;
+  if (!best) return false;
+  aircraftTableToFlightInfo(*best, out);
+  return true;
+}
+
+size_t aircraftTableCandidates(MilCandidate *out, size_t cap, uint32_t nowMs) {
+  size_t n = 0;
+  for (size_t i = 0; i < AIRCRAFT_TABLE_SIZE && n < cap; ++i) {
+    const TrackedAircraft &ac = g_table[i];
+    if (ac.icao == 0 || isnan(ac.lat) || isnan(ac.lon)) continue;
+    if (nowMs - ac.lastPosMs > (uint32_t)POSITION_MAX_AGE_S * 1000UL) continue;
+    MilCandidate &c = out[n++];
+    aircraftTableToFlightInfo(ac, c.fi);
+    c.inFlight = !ac.onGround && ac.altitudeFt > 0;
+    c.isMil = false;
+  }
+  return n;
+}
+
+void aircraftTableRadar(RadarSnapshot &out, uint32_t nowMs) {
+  out = RadarSnapshot{};
+  for (size_t i = 0; i < AIRCRAFT_TABLE_SIZE; ++i) {
+    const TrackedAircraft &ac = g_table[i];
+    if (ac.icao == 0 || isnan(ac.lat) || isnan(ac.lon)) continue;
+    if (nowMs - ac.lastPosMs > (uint32_t)POSITION_MAX_AGE_S * 1000UL) continue;
+    radarSnapshotOffer(out, ac.icao, ac.lat, ac.lon, ac.trackDeg, !ac.onGround && ac.altitudeFt > 0);
+  }
+}
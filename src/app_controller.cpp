@@ -4,6 +4,7 @@
 #include <math.h>
 #include <lvgl.h>
 
+#include "boot_profiler.h"
 #include "config_features.h"
 #include "config_hw.h"
 #include "diagnostics.h"
@@ -11,10 +12,16 @@
 #include "log.h"
 #include "networking.h"
 #include "power_manager.h"
+#include "radar_targets.h"
+#include "rtc_state.h"
 #include "ui.h"
+#include "ui_wake.h"
 
 static AppControllerState g_state;
 static PowerManagerState g_power;
+static AppLoopStats g_loop;
+static uint32_t g_loopStartUs = 0;
+static bool g_bootReported = false;
 
 static bool sameFlightDisplay(const FlightInfo &a, const FlightInfo &b) {
   if (!a.valid && !b.valid) return true;
@@ -33,17 +40,25 @@ static bool sameFlightDisplay(const FlightInfo &a, const FlightInfo &b) {
 void appControllerInit(const UiState &ui) {
   g_state = AppControllerState{};
   g_state.ui = ui;
+  g_state.haveDisplayed = rtcStateLoadFlight(g_state.lastShown);
   powerManagerInit(g_power);
+  powerSaveInit();
   diagnosticsInit();
+  uiWakeInit();
+  g_loopStartUs = micros();
 }
 
+AppLoopStats appControllerGetLoopStats() { return g_loop; }
+
 void appControllerTick() {
   networkingEnsureConnected();
 
   uint32_t now = millis();
 
+  bool ramping = false;
   if (displayIsReady()) {
     powerManagerTick(g_power, g_state.haveDisplayed ? &g_state.lastShown : nullptr);
+    ramping = displayTick();
   }
 
   if (displayIsReady() && uiIsReady(g_state.ui) && BATTERY_UI_UPDATE_MS > 0) {
@@ -65,19 +80,60 @@ void appControllerTick() {
         uiRenderFlight(g_state.ui, pending);
         g_state.lastShown = pending;
         g_state.haveDisplayed = true;
+        rtcStateSaveFlight(pending);
+      }
+      if (!g_bootReported) {
+        g_bootReported = true;
+        bootMilestone(BootPhase::FirstFlight);
+        LOG_INFO("Boot profile:");
+        bootProfilerPrint(Serial);
       }
     } else if (!g_state.haveDisplayed) {
       uiRenderNoData(g_state.ui, "Check Wi-Fi/API");
     }
+    powerManagerFetchDone(g_power, pendingValid);
+  }
+
+#if FEATURE_RADAR_VIEW
+  if (uiIsReady(g_state.ui)) {
+    RadarSnapshot radar;
+    uint32_t radarSeq = 0;
+    if (radarTargetsGetLatest(radar, radarSeq) && radarSeq != g_state.lastRadarSeq) {
+      g_state.lastRadarSeq = radarSeq;
+      uiRenderRadar(g_state.ui, radar);
+    }
   }
+#endif
+
+#if UI_IDLE_SLEEP
+  uint32_t waitMs = ramping ? BRIGHTNESS_RAMP_TICK_MS : UI_LOOP_MAX_SLEEP_MS;
+  if (uiIsReady(g_state.ui)) {
+    uint32_t untilNext = lv_timer_handler();
+    g_state.lastLvglMs = now;
+    bootMilestone(BootPhase::FirstFrame);
+    if (untilNext < waitMs) waitMs = untilNext;
+  }
+
+  diagnosticsTick();
 
+  uint32_t idleStart = micros();
+  if (uiWakeWait(waitMs)) ++g_loop.earlyWakes;
+  uint32_t end = micros();
+  g_loop.idleUs += end - idleStart;
+#else
   if (uiIsReady(g_state.ui)) {
     if (now - g_state.lastLvglMs >= 5) {
       lv_timer_handler();
       g_state.lastLvglMs = now;
+      bootMilestone(BootPhase::FirstFrame);
     }
   }
 
   diagnosticsTick();
   yield();
+  uint32_t end = micros();
+#endif
+  ++g_loop.iterations;
+  g_loop.totalUs += end - g_loopStartUs;
+  g_loopStartUs = end;
 }
@@ -0,0 +1,178 @@
+#include "bench.h"
+
+#include <ArduinoJson.h>
+
+#include <new>
+
+#include "aircraft_types.h"
+#include "app_config.h"
+#include "bench_payloads.h"
+#include "config_features.h"
+#include "flight_enrichment.h"
+#include "flight_parser.h"
+#include "network_client.h"
+#include "radar_targets.h"
+#include "ui.h"
+
+#if FEATURE_BENCH && defined(BENCH_CAPTURE_HEADER)
+// Recorded aircraft lists, generated by tools/bench_capture.py.
+#include BENCH_CAPTURE_HEADER
+#endif
+
+#if FEATURE_BENCH
+namespace {
+constexpr size_t kSampleFlights = 64;
+constexpr uint32_t kMinRunUs = 200000;
+constexpr uint32_t kMaxIterations = 100000;
+
+class BenchReport {
+ public:
+  explicit BenchReport(Print &out) : _out(out) {}
+
+  // Runs fn until kMinRunUs have passed (at least once) and records the
+  // mean time per call and per item.
+  template <typename Fn>
+  void run(const char *name, size_t items, Fn fn) {
+    uint32_t iterations = 0;
+    uint32_t start = micros();
+    uint32_t elapsed = 0;
+    do {
+      fn();
+      ++iterations;
+      elapsed = micros() - start;
+    } while (elapsed < kMinRunUs && iterations < kMaxIterations);
+    double nsPerOp = elapsed * 1000.0 / iterations;
+    _out.printf("%s{\"name\":\"%s\",\"items\":%u,\"iterations\":%lu,\"ns_per_op\":%.0f,"
+                "\"ns_per_item\":%.1f}",
+                _count++ ? "," : "", name, (unsigned)items, (unsigned long)iterations, nsPerOp,
+                items ? nsPerOp / items : nsPerOp);
+    yield();
+  }
+
+ private:
+  Print &_out;
+  size_t _count = 0;
+};
+// Times the JSON parse, aircraft parse, scan and MIL matching of one
+// aircraft list, naming the cases "<case>/<tag>". Flights parsed on the way
+// fill `samples` up to kSampleFlights.
+bool benchAircraftList(BenchReport &report, const char *tag, const char *payload, size_t len,
+                       MilCandidate *cands, FlightInfo *samples, size_t &sampleCount) {
+  JsonDocument doc;
+  if (deserializeJson(doc, payload, len) != DeserializationError::Ok) return false;
+  JsonArray ac = doc["ac"].as<JsonArray>();
+  size_t n = ac.size();
+  char name[32];
+
+  snprintf(name, sizeof(name), "json/%s", tag);
+  report.run(name, n, [&]() {
+    JsonDocument scratch;
+    deserializeJson(scratch, payload, len);
+  });
+
+  snprintf(name, sizeof(name), "parse/%s", tag);
+  report.run(name, n, [&]() {
+    FlightInfo fi;
+    for (JsonVariant v : ac) flightParserParseAircraft(v.as<JsonObject>(), fi);
+  });
+
+  AircraftScan scan;
+  snprintf(name, sizeof(name), "scan/%s", tag);
+  report.run(name, n, [&]() {
+    RadarSnapshot radar;
+    scan = AircraftScan{};
+    scan.cands = cands;
+    scan.candCap = kMilLookupMax;
+    networkClientScanAircraft(ac, scan, &radar);
+  });
+
+  String hexes[kMilLookupMax];
+  for (size_t i = 0; i < scan.candCount; ++i) hexes[i] = cands[i].fi.hex;
+  String mil;
+  if (!benchMakeMilList(n, hexes, scan.candCount, mil)) return false;
+  bool isMil[kMilLookupMax];
+  snprintf(name, sizeof(name), "milmatch/%s", tag);
+  report.run(name, n, [&]() {
+    memset(isMil, 0, sizeof(isMil));
+    MilListMatcher matcher(hexes, scan.candCount, isMil);
+    const char *p = mil.c_str();
+    size_t left = mil.length();
+    // Same chunk size as the HTTP read loop.
+    while (left && !matcher.done()) {
+      size_t chunk = left < 160 ? left : 160;
+      matcher.feed(p, chunk);
+      p += chunk;
+      left -= chunk;
+    }
+  });
+
+  for (JsonVariant v : ac) {
+    if (sampleCount >= kSampleFlights) break;
+    if (flightParserParseAircraft(v.as<JsonObject>(), samples[sampleCount])) ++sampleCount;
+  }
+  return true;
+}
+}  // namespace
+
+void benchRun(Print &out, size_t maxAircraft) {
+  MilCandidate *cands = new (std::nothrow) MilCandidate[kMilLookupMax];
+  if (!cands) {
+    out.println("bench: out of memory");
+    return;
+  }
+  FlightInfo *samples = new (std::nothrow) FlightInfo[kSampleFlights];
+  if (!samples) {
+    delete[] cands;
+    out.println("bench: out of memory");
+    return;
+  }
+  size_t sampleCount = 0;
+
+  out.printf("BENCH {\"cpu_mhz\":%u,\"benchmarks\":[", (unsigned)getCpuFrequencyMhz());
+  BenchReport report(out);
+  char tag[16];
+  size_t largest = 0;
+  for (size_t n : kBenchSizes) {
+    if (n > maxAircraft) break;
+    String payload;
+    if (!benchMakeAircraftList(n, payload)) break;
+    snprintf(tag, sizeof(tag), "%u", (unsigned)n);
+    if (!benchAircraftList(report, tag, payload.c_str(), payload.length(), cands, samples,
+                           sampleCount)) {
+      break;
+    }
+    largest = n;
+  }
+#ifdef BENCH_CAPTURE_HEADER
+  for (size_t i = 0; i < kBenchCaptureCount; ++i) {
+    snprintf(tag, sizeof(tag), "rec%u", (unsigned)i);
+    benchAircraftList(report, tag, kBenchCaptures[i], kBenchCaptureLens[i], cands, samples,
+                      sampleCount);
+  }
+#endif
+
+  if (sampleCount) {
+    report.run("typename", sampleCount, [&]() {
+      for (size_t i = 0; i < sampleCount; ++i) aircraftFriendlyName(samples[i].typeCode);
+    });
+    report.run("seatmax", sampleCount, [&]() {
+      uint16_t seats = 0;
+      for (size_t i = 0; i < sampleCount; ++i) aircraftSeatMax(samples[i].typeCode, seats);
+    });
+    // Without a hex address classification never reaches the MIL cache or
+    // the network, leaving the type and callsign rules.
+    for (size_t i = 0; i < sampleCount; ++i) samples[i].hex = "";
+    report.run("classify", sampleCount, [&]() {
+      for (size_t i = 0; i < sampleCount; ++i) flightEnrichmentClassifyOp(samples[i]);
+    });
+    report.run("format", sampleCount, [&]() {
+      UiFlightText text;
+      for (size_t i = 0; i < sampleCount; ++i) uiFormatFlight(samples[i], text);
+    });
+  }
+  out.printf("],\"max_aircraft\":%u}\n", (unsigned)largest);
+
+  delete[] samples;
+  delete[] cands;
+}
+#endif
@@ -0,0 +1,76 @@
+#include "bench_payloads.h"
+
+#include <math.h>
+
+#include "app_config.h"
+#include "flight_enrichment.h"
+
+const char *const kBenchTypes[] = {"A320", "B738", "B77W", "A21N", "E190", "DH8D", "C172",
+                                   "PC12", "GLF5", "C17",  "TISB", "ZZZZ"};
+const size_t kBenchTypeCount = sizeof(kBenchTypes) / sizeof(kBenchTypes[0]);
+
+namespace {
+// xorshift32 with a fixed seed.
+struct BenchRng {
+  uint32_t s = 0x9E3779B9;
+  uint32_t next() {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+  }
+  float unit() { return (next() >> 8) * (1.0f / 16777216.0f); }
+};
+}  // namespace
+
+uint32_t benchHex(size_t i) { return (uint32_t)(0x400000 + i * 7919) & 0xFFFFFF; }
+
+bool benchMakeAircraftList(size_t n, String &out) {
+  if (!out.reserve(n * 200 + 32)) return false;
+  BenchRng rng;
+  double cosLat = cos(HOME_LAT * PI / 180.0);
+  out = "{\"now\":1700000000.0,\"ac\":[";
+  char buf[224];
+  for (size_t i = 0; i < n; ++i) {
+    double r = SEARCH_RADIUS_KM * sqrt(rng.unit()) / 111.32;
+    double a = rng.unit() * 2.0 * PI;
+    double lat = HOME_LAT + r * cos(a);
+    double lon = HOME_LON + r * sin(a) / cosLat;
+    const char *type = kBenchTypes[rng.next() % kBenchTypeCount];
+    char alt[16];
+    if (rng.next() % 8 == 0) {
+      snprintf(alt, sizeof(alt), "\"ground\"");
+    } else {
+      snprintf(alt, sizeof(alt), "%lu", (unsigned long)(500 + rng.next() % 40000));
+    }
+    char flight[24] = "";
+    if (rng.next() % 10) {
+      snprintf(flight, sizeof(flight), "\"flight\":\"BAW%03u  \",", (unsigned)(rng.next() % 1000));
+    }
+    snprintf(buf, sizeof(buf),
+             "%s{\"hex\":\"%06lx\",%s\"r\":\"G-%04u\",\"t\":\"%s\",\"alt_baro\":%s,"
+             "\"lat\":%.6f,\"lon\":%.6f,\"category\":\"A3\",\"track\":%.1f,\"seen_pos\":0.4}",
+             i ? "," : "", (unsigned long)benchHex(i), flight, (unsigned)(i % 10000), type, alt,
+             lat, lon, rng.unit() * 360.0f);
+    out += buf;
+  }
+  out += "]}";
+  return true;
+}
+
+bool benchMakeMilList(size_t n, const String *hexes, size_t count, String &out) {
+  if (!out.reserve(n * 96 + 32)) return false;
+  out = "{\"ac\":[";
+  char buf[112];
+  for (size_t i = 0; i < n; ++i) {
+    size_t c = i / 16 * 2;
+    uint32_t hex = (uint32_t)(0xAE0000 + i);
+    if (i % 16 == 0 && c < count) flightEnrichmentParseHex(hexes[c], hex);
+    snprintf(buf, sizeof(buf),
+             "%s{\"hex\":\"%06lx\",\"type\":\"adsb_icao\",\"flight\":\"RCH%03u\",\"t\":\"C17\"}",
+             i ? "," : "", (unsigned long)hex, (unsigned)(i % 1000));
+    out += buf;
+  }
+  out += "]}";
+  return true;
+}
@@ -0,0 +1,126 @@
+#include "boot_profiler.h"
+
+namespace {
+constexpr size_t kPhaseCount = (size_t)BootPhase::Count;
+constexpr size_t kSpanCount = (size_t)BootPhase::FirstFrame;
+
+struct PhaseTimes {
+  uint32_t beginUs;
+  uint32_t endUs;
+  bool begun;
+  bool ended;
+};
+}  // namespace
+
+static PhaseTimes g_phases[kPhaseCount];
+static uint32_t (*g_clock)() = nullptr;
+static portMUX_TYPE g_bootMux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t nowUs() { return g_clock ? g_clock() : micros(); }
+
+void bootProfilerInit(uint32_t (*clockUs)()) {
+  g_clock = clockUs;
+  portENTER_CRITICAL(&g_bootMux);
+  memset(g_phases, 0, sizeof(g_phases));
+  portEXIT_CRITICAL(&g_bootMux);
+}
+
+void bootPhaseBegin(BootPhase phase) {
+  uint32_t t = nowUs();
+  portENTER_CRITICAL(&g_bootMux);
+  PhaseTimes &p = g_phases[(size_t)phase];
+  p.beginUs = t;
+  p.begun = true;
+  p.ended = false;
+  portEXIT_CRITICAL(&g_bootMux);
+}
+
+void bootPhaseEnd(BootPhase phase) {
+  uint32_t t = nowUs();
+  portENTER_CRITICAL(&g_bootMux);
+  PhaseTimes &p = g_phases[(size_t)phase];
+  if (p.begun) {
+    p.endUs = t;
+    p.ended = true;
+  }
+  portEXIT_CRITICAL(&g_bootMux);
+}
+
+void bootMilestone(BootPhase phase) {
+  uint32_t t = nowUs();
+  portENTER_CRITICAL(&g_bootMux);
+  PhaseTimes &p = g_phases[(size_t)phase];
+  if (!p.ended) {
+    p.beginUs = 0;
+    p.endUs = t;
+    p.begun = true;
+    p.ended = true;
+  }
+  portEXIT_CRITICAL(&g_bootMux);
+}
+
+const char *bootPhaseName(BootPhase phase) {
+  switch (phase) {
+    case BootPhase::Display: return "display";
+    case BootPhase::Lvgl: return "lvgl";
+    case BootPhase::Ui: return "ui";
+    case BootPhase::Network: return "network";
+    case BootPhase::FirstFrame: return "first frame";
+    case BootPhase::WifiIp: return "wifi ip";
+    case BootPhase::FirstFetch: return "first fetch";
+    case BootPhase::FirstFlight: return "first flight";
+    default: return "?";
+  }
+}
+
+uint32_t bootProfilerSerialUs() {
+  uint32_t total = 0;
+  portENTER_CRITICAL(&g_bootMux);
+  for (size_t i = 0; i < kSpanCount; ++i) {
+    if (g_phases[i].ended) total += g_phases[i].endUs - g_phases[i].beginUs;
+  }
+  portEXIT_CRITICAL(&g_bootMux);
+  return total;
+}
+
+uint32_t bootProfilerWallUs() {
+  bool any = false;
+  uint32_t first = 0;
+  uint32_t last = 0;
+  portENTER_CRITICAL(&g_bootMux);
+  for (size_t i = 0; i < kSpanCount; ++i) {
+    const PhaseTimes &p = g_phases[i];
+    if (!p.ended) continue;
+    if (!any || (int32_t)(p.beginUs - first) < 0) first = p.beginUs;
+    if (!any || (int32_t)(p.endUs - last) > 0) last = p.endUs;
+    any = true;
+  }
+  portEXIT_CRITICAL(&g_bootMux);
+  return any ? last - first : 0;
+}
+
+void bootProfilerPrint(Print &out) {
+  PhaseTimes phases[kPhaseCount];
+  portENTER_CRITICAL(&g_bootMux);
+  memcpy(phases, g_phases, sizeof(phases));
+  portEXIT_CRITICAL(&g_bootMux);
+
+  out.printf("%-13s %8s %8s %8s\n", "phase", "start", "end", "ms");
+  for (size_t i = 0; i < kPhaseCount; ++i) {
+    const PhaseTimes &p = phases[i];
+    const char *name = bootPhaseName((BootPhase)i);
+    if (!p.ended) {
+      out.printf("%-13s %8s %8s %8s\n", name, "-", "-", p.begun ? "running" : "-");
+    } else if (i < kSpanCount) {
+      out.printf("%-13s %8lu %8lu %8lu\n", name, (unsigned long)(p.beginUs / 1000),
+                 (unsigned long)(p.endUs / 1000), (unsigned long)((p.endUs - p.beginUs) / 1000));
+    } else {
+      out.printf("%-13s %8s %8lu %8s\n", name, "", (unsigned long)(p.endUs / 1000), "");
+    }
+  }
+  uint32_t serial = bootProfilerSerialUs();
+  uint32_t wall = bootProfilerWallUs();
+  out.printf("init spans %lums back to back, %lums wall, %lums overlapped\n",
+             (unsigned long)(serial / 1000), (unsigned long)(wall / 1000),
+             (unsigned long)(serial > wall ? (serial - wall) / 1000 : 0));
+}
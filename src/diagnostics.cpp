@@ -2,20 +2,163 @@
 
 #include <Arduino.h>
 
+#include "app_controller.h"
+#include "bench.h"
+#include "boot_profiler.h"
 #include "config_features.h"
+#include "config_hw.h"
+#include "display/drivers/common/LV_Helper.h"
+#include "display/drivers/AmoledDisplay/Amoled_DisplayPanel.h"
+#include "display_init.h"
+#include "endpoint_pool.h"
+#include "http_transport.h"
 #include "log.h"
+#include "modes_decoder.h"
+#include "net_timing.h"
+#include "networking.h"
+#include "power_manager.h"
+#include "stream_ingest.h"
+#include "ui.h"
 
 #ifndef DIAGNOSTICS_INTERVAL_MS
 #define DIAGNOSTICS_INTERVAL_MS 60000
 #endif
 
 static uint32_t g_lastLogMs = 0;
+static AppLoopStats g_lastLoop;
+static NetworkingFetchStats g_lastFetch;
+
+#if FEATURE_SERIAL_COMMANDS
+static char g_cmd[32];
+static uint8_t g_cmdLen = 0;
+
+static void handleCommand(const char *cmd) {
+  if (!strcmp(cmd, "net")) {
+    netTimingPrint(Serial);
+  } else if (!strcmp(cmd, "net reset")) {
+    netTimingReset();
+    Serial.println("net timing reset");
+  } else if (!strcmp(cmd, "lvgl")) {
+    lvglProfilePrint(Serial);
+  } else if (!strcmp(cmd, "lvgl on") || !strcmp(cmd, "lvgl off")) {
+    lvglProfileEnable(cmd[6] == 'n');
+    Serial.printf("lvgl profiling %s\n", lvglProfileEnabled() ? "on" : "off");
+  } else if (!strcmp(cmd, "lvgl reset")) {
+    lvglProfileReset();
+    Serial.println("lvgl profile reset");
+  } else if (!strcmp(cmd, "boot")) {
+    bootProfilerPrint(Serial);
+#if FEATURE_BENCH
+  } else if (!strncmp(cmd, "bench", 5) && (cmd[5] == '\0' || cmd[5] == ' ')) {
+    long maxAircraft = cmd[5] ? atol(cmd + 6) : 0;
+    benchRun(Serial, maxAircraft > 0 ? (size_t)maxAircraft : 5000);
+#endif
+  } else {
+    Serial.printf("Unknown command '%s' (net, net reset, lvgl, lvgl on|off|reset, boot, bench [n])\n",
+                  cmd);
+  }
+}
+
+static void pollSerialCommands() {
+  while (Serial.available() > 0) {
+    int c = Serial.read();
+    if (c == '\r' || c == '\n') {
+      if (g_cmdLen) {
+        g_cmd[g_cmdLen] = '\0';
+        handleCommand(g_cmd);
+        g_cmdLen = 0;
+      }
+    } else if (g_cmdLen < sizeof(g_cmd) - 1) {
+      g_cmd[g_cmdLen++] = (char)c;
+    }
+  }
+}
+#endif
+
+#if FEATURE_DIAGNOSTICS
+// Estimated SoC + radio energy per fetch cycle over the last interval: the
+// fetch itself at full power, the rest split by the UI loop's idle share
+// between the awake and idle draw of the current power-save mode.
+static void logEnergy(uint64_t intervalUs, double idleShare) {
+  NetworkingFetchStats fetch = networkingGetFetchStats();
+  uint32_t fetches = fetch.fetches - g_lastFetch.fetches;
+  uint64_t activeUs = fetch.activeUs - g_lastFetch.activeUs;
+  g_lastFetch = fetch;
+  if (!fetches) return;
+
+  PowerSaveMode mode = powerSaveMode();
+  double awakeMa = mode == PowerSaveMode::Off ? POWER_EST_RADIO_ON_MA : POWER_EST_CPU_MA;
+  double idleMa = mode == PowerSaveMode::LightSleep   ? POWER_EST_LIGHT_SLEEP_MA
+                  : mode == PowerSaveMode::ModemSleep ? POWER_EST_MODEM_SLEEP_MA
+                                                      : POWER_EST_RADIO_ON_MA;
+  double cycleS = intervalUs / 1e6 / fetches;
+  double fetchS = activeUs / 1e6 / fetches;
+  double restS = cycleS > fetchS ? cycleS - fetchS : 0.0;
+  double mAs = fetchS * POWER_EST_FETCH_MA + restS * (idleShare * idleMa + (1.0 - idleShare) * awakeMa);
+  LOG_INFO("Energy %s fetch=%.0fms cycle=%.1fs est=%.1fmJ/fetch avg=%.1fmA",
+           powerSaveModeName(mode), fetchS * 1e3, cycleS, mAs * POWER_EST_SUPPLY_MV / 1000.0,
+           mAs / cycleS);
+}
+#endif
+
+#if FEATURE_DIAGNOSTICS && !FEATURE_STREAM_INGEST
+static void logNetTiming() {
+  for (size_t e = 0; e < kNetEndpointCount; ++e) {
+    NetEndpoint ep = (NetEndpoint)e;
+    LatencyHistogram total;
+    netTimingGet(ep, NetPhase::Total, total);
+    if (!total.samples) continue;
+    uint32_t p90[kNetPhaseCount];
+    for (size_t p = 0; p < kNetPhaseCount; ++p) {
+      LatencyHistogram h;
+      netTimingGet(ep, (NetPhase)p, h);
+      p90[p] = netTimingPercentile(h, 90);
+    }
+    LOG_INFO("Net %s n=%lu total p50=%lu p90=%lu p99=%lu | p90 dns=%lu conn=%lu tls=%lu "
+             "ttfb=%lu body=%lu parse=%lu ms",
+             netEndpointName(ep), (unsigned long)total.samples,
+             (unsigned long)netTimingPercentile(total, 50),
+             (unsigned long)p90[(size_t)NetPhase::Total],
+             (unsigned long)netTimingPercentile(total, 99),
+             (unsigned long)p90[(size_t)NetPhase::Dns],
+             (unsigned long)p90[(size_t)NetPhase::Connect],
+             (unsigned long)p90[(size_t)NetPhase::Tls],
+             (unsigned long)p90[(size_t)NetPhase::Ttfb],
+             (unsigned long)p90[(size_t)NetPhase::Body],
+             (unsigned long)p90[(size_t)NetPhase::Parse]);
+  }
+}
+#endif
+
+#if FEATURE_DIAGNOSTICS
+// Logs the refresh histograms for the last interval, then starts a new one.
+static void logLvglProfile() {
+  if (!lvglProfileEnabled()) return;
+  LatencyHistogram h[kLvglMetricCount];
+  for (size_t i = 0; i < kLvglMetricCount; ++i) lvglProfileGet((LvglMetric)i, h[i]);
+  const LatencyHistogram &render = h[(size_t)LvglMetric::RenderUs];
+  if (!render.samples) return;
+  auto p = [&](LvglMetric m, uint8_t pct) {
+    return (unsigned long)lvglProfilePercentile(m, h[(size_t)m], pct);
+  };
+  LOG_INFO("LVGL n=%lu render p50=%lu p90=%lu p99=%luus flush p50=%lu p90=%lu p99=%luus "
+           "rendered p90=%lupx flushed p90=%lupx areas p90=%lu",
+           (unsigned long)render.samples, p(LvglMetric::RenderUs, 50), p(LvglMetric::RenderUs, 90),
+           p(LvglMetric::RenderUs, 99), p(LvglMetric::FlushUs, 50), p(LvglMetric::FlushUs, 90),
+           p(LvglMetric::FlushUs, 99), p(LvglMetric::RenderedPx, 90),
+           p(LvglMetric::FlushedPx, 90), p(LvglMetric::Areas, 90));
+  lvglProfileReset();
+}
+#endif
 
 void diagnosticsInit() {
   g_lastLogMs = millis();
 }
 
 void diagnosticsTick() {
+#if FEATURE_SERIAL_COMMANDS
+  pollSerialCommands();
+#endif
 #if FEATURE_DIAGNOSTICS
   uint32_t now = millis();
   if ((int32_t)(now - g_lastLogMs) >= (int32_t)DIAGNOSTICS_INTERVAL_MS) {
@@ -25,6 +168,109 @@ void diagnosticsTick() {
              (unsigned)ESP.getMinFreeHeap());
 #else
     LOG_INFO("Diagnostics tick");
+#endif
+    AppLoopStats loop = appControllerGetLoopStats();
+    uint64_t loopUs = loop.totalUs - g_lastLoop.totalUs;
+    if (loopUs) {
+      uint32_t iterations = loop.iterations - g_lastLoop.iterations;
+      LOG_INFO("Loop %.1f it/s idle=%.1f%% early wakes=%lu",
+               iterations * 1e6 / (double)loopUs,
+               100.0 * (double)(loop.idleUs - g_lastLoop.idleUs) / (double)loopUs,
+               (unsigned long)(loop.earlyWakes - g_lastLoop.earlyWakes));
+      logEnergy(loopUs, (double)(loop.idleUs - g_lastLoop.idleUs) / (double)loopUs);
+    }
+    g_lastLoop = loop;
+    NetworkingWifiStats wifi = networkingGetWifiStats();
+    LOG_INFO("WiFi fast=%lu avg=%lums slow=%lu avg=%lums fast failed=%lu last=%lums",
+             (unsigned long)wifi.fastConnects,
+             (unsigned long)(wifi.fastConnects ? wifi.fastConnectMsTotal / wifi.fastConnects : 0),
+             (unsigned long)wifi.slowConnects,
+             (unsigned long)(wifi.slowConnects ? wifi.slowConnectMsTotal / wifi.slowConnects : 0),
+             (unsigned long)wifi.fastFailures, (unsigned long)wifi.lastConnectMs);
+    if (displayIsReady()) {
+      LOG_INFO("Touch irqs=%lu reads=%lu", (unsigned long)displayPanel().touchIrqCount(),
+               (unsigned long)displayPanel().touchReadCount());
+      uint16_t mv = displayPanel().getBattVoltage();
+      if (mv) {
+        LOG_INFO("Battery %umV soc=%d%%%s", (unsigned)mv, (int)displayPanel().getBattPercent(),
+                 displayPanel().isCharging() ? " charging" : "");
+      }
+    }
+    LvglRenderStats lv = lvglHelperGetStats();
+    if (lv.frames) {
+      uint64_t overlapUs = lv.flushUs > lv.stallUs ? lv.flushUs - lv.stallUs : 0;
+      LOG_INFO("LVGL %s frames=%lu areas/frame=%.1f px/frame=%lu render=%luus flush=%luus "
+               "stall=%luus overlap=%.0f%% trimmed=%lupx skipped=%lupx",
+               lvglHelperPartialMode() ? "partial" : "direct", (unsigned long)lv.frames,
+               (double)lv.areas / lv.frames, (unsigned long)(lv.pixels / lv.frames),
+               (unsigned long)(lv.renderUs / lv.frames), (unsigned long)(lv.flushUs / lv.frames),
+               (unsigned long)(lv.stallUs / lv.frames),
+               lv.flushUs ? 100.0 * overlapUs / lv.flushUs : 0.0,
+               (unsigned long)(lv.trimmedPixels / lv.frames),
+               (unsigned long)(lv.skippedPixels / lv.frames));
+    }
+#if LVGL_LUMA_ACCOUNTING
+    if (lv.frames && displayIsReady()) {
+      // Brightness levels run 1-16; the panel draws little beyond its base
+      // current on black and the most on full white.
+      double level = displayGetState().brightness / 16.0;
+      double ma = POWER_EST_DISPLAY_BASE_MA +
+                  POWER_EST_DISPLAY_WHITE_MA * level * (lv.lastAplPermille / 1000.0);
+      LOG_INFO("Display apl=%.1f%% avg=%.1f%% brightness=%u theme=%s est=%.1fmA %.0fmW",
+               lv.lastAplPermille / 10.0, (double)lv.aplPermilleTotal / lv.frames / 10.0,
+               (unsigned)displayGetState().brightness, uiLowPowerTheme() ? "low power" : "normal",
+               ma, ma * POWER_EST_SUPPLY_MV / 1000.0);
+    }
+#endif
+    logLvglProfile();
+    UiRenderStats ui = uiGetRenderStats();
+    if (ui.updates) {
+      LOG_INFO("UI updates=%lu widgets changed=%lu unchanged=%lu invalidated/update=%lupx last=%lupx",
+               (unsigned long)ui.updates, (unsigned long)ui.widgetsChanged,
+               (unsigned long)ui.widgetsUnchanged,
+               (unsigned long)(ui.invalidatedPixels / ui.updates),
+               (unsigned long)ui.lastInvalidatedPixels);
+    }
+#if FEATURE_STREAM_INGEST
+    StreamIngestStats st = streamIngestGetStats();
+    LOG_INFO("Stream %s bytes=%lu msgs=%lu rejected=%lu tracked=%u connects=%lu",
+             st.connected ? "up" : "down", (unsigned long)st.bytes, (unsigned long)st.messages,
+             (unsigned long)st.rejected, (unsigned)st.tracked, (unsigned long)st.connects);
+#if STREAM_FORMAT == STREAM_FORMAT_BEAST || STREAM_FORMAT == STREAM_FORMAT_AVR
+    ModesStats ms = modesGetStats();
+    LOG_INFO("Mode-S crc=%lu ignored=%lu ident=%lu pos global=%lu local=%lu rejected=%lu vel=%lu",
+             (unsigned long)ms.crcErrors, (unsigned long)ms.ignored, (unsigned long)ms.idents,
+             (unsigned long)ms.positionsGlobal, (unsigned long)ms.positionsLocal,
+             (unsigned long)ms.positionsRejected, (unsigned long)ms.velocities);
+#endif
+#else
+    for (size_t i = 0; i < endpointPoolCount(); ++i) {
+      EndpointStats ep;
+      if (!endpointPoolGetStats(i, ep)) continue;
+      LOG_INFO("Endpoint %s ewma=%.0fms err=%.2f ok=%lu fail=%lu hedge=%lu/%lu p90=%lums",
+               ep.base, ep.ewmaMs, ep.errorRate, (unsigned long)ep.successes,
+               (unsigned long)ep.failures, (unsigned long)ep.hedgeWins,
+               (unsigned long)ep.hedgesFired, (unsigned long)endpointPoolHedgeDelayMs(i));
+    }
+    HttpTransportStats ht = httpTransportGetStats();
+    LOG_INFO("HTTP warm=%lu ttfb=%lums cold=%lu connect=%lums ttfb=%lums prewarms=%lu "
+             "connFail=%lu dns hit=%lu miss=%lu fail=%lu",
+             (unsigned long)ht.warmRequests,
+             (unsigned long)(ht.warmRequests ? ht.warmTtfbMsTotal / ht.warmRequests : 0),
+             (unsigned long)ht.coldRequests,
+             (unsigned long)(ht.coldRequests ? ht.coldConnectMsTotal / ht.coldRequests : 0),
+             (unsigned long)(ht.coldRequests ? ht.coldTtfbMsTotal / ht.coldRequests : 0),
+             (unsigned long)ht.prewarms, (unsigned long)ht.connectFailures,
+             (unsigned long)ht.dnsHits, (unsigned long)ht.dnsMisses,
+             (unsigned long)ht.dnsFailures);
+    LOG_INFO("TLS full=%lu avg=%lums resumed=%lu avg=%lums",
+             (unsigned long)ht.fullHandshakes,
+             (unsigned long)(ht.fullHandshakes ? ht.fullHandshakeMsTotal / ht.fullHandshakes : 0),
+             (unsigned long)ht.resumedHandshakes,
+             (unsigned long)(ht.resumedHandshakes
+                                 ? ht.resumedHandshakeMsTotal / ht.resumedHandshakes
+                                 : 0));
+    logNetTiming();
 #endif
   }
 #endif
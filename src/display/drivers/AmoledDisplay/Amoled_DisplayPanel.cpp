@@ -1,9 +1,41 @@
 #include "Amoled_DisplayPanel.h"
 #include "Arduino_GFX_Library.h"
+#include "config_hw.h"
 #include "pin_config.h"
 #include <Wire.h>
+#include <algorithm>
 #include <esp_adc_cal.h>
+#include <driver/gpio.h>
 #include <esp_log.h>
+#include <esp_sleep.h>
+#include <hal/gpio_ll.h>
+#include <soc/gpio_struct.h>
+
+#ifndef AMOLED_FLUSH_TASK_CORE
+#define AMOLED_FLUSH_TASK_CORE 0
+#endif
+
+#ifndef AMOLED_FLUSH_TASK_PRIORITY
+#define AMOLED_FLUSH_TASK_PRIORITY 3
+#endif
+
+// Read interval while a finger is down; matches LVGL's default indev period
+// so every LVGL read sees fresh coordinates.
+#ifndef AMOLED_TOUCH_POLL_MS
+#define AMOLED_TOUCH_POLL_MS 30
+#endif
+
+#define AMOLED_TOUCH_MAX_POINTS 10
+
+#ifndef AMOLED_BATTERY_SAMPLE_MS
+#define AMOLED_BATTERY_SAMPLE_MS 500
+#endif
+
+// EMA weight of a new median, as a shift: 1/8 per sample, so the reading
+// settles within a few seconds without following load spikes.
+#ifndef AMOLED_BATTERY_EMA_SHIFT
+#define AMOLED_BATTERY_EMA_SHIFT 3
+#endif
 
 static void waitMs(uint32_t durationMs) {
     uint32_t start = millis();
@@ -52,13 +84,14 @@ static void touchPrepareIntPin(const AmoledHwConfig &hwConfig) {
 
 Amoled_DisplayPanel::Amoled_DisplayPanel(AmoledHwConfig hw_config)
     : hwConfig(hw_config), displayBus(nullptr), display(nullptr), _touchDrv(nullptr), _wakeupMethod(WAKEUP_FROM_NONE),
-      _sleepTimeUs(0), currentBrightness(0) {
+      _sleepTimeUs(0) {
     _rotation = 0;
 }
 
 Amoled_DisplayPanel::~Amoled_DisplayPanel() {
     uninstallSD();
 
+    detachTouchIrq();
     if (_touchDrv) {
         delete _touchDrv;
         _touchDrv = nullptr;
@@ -97,6 +130,7 @@ bool Amoled_DisplayPanel::begin(Amoled_Display_Panel_Color_Order order) {
         // Touch is optional for rendering; keep the display usable if touch fails.
         ESP_LOGW("Amoled_DisplayPanel", "Touch init failed; continuing without touch");
     }
+    attachTouchIrq();
     display_ok &= initDisplay(order);
 
     return display_ok;
@@ -123,27 +157,40 @@ void Amoled_DisplayPanel::uninstallSD() {
     pinMode(hwConfig.sd_cs, INPUT);
 }
 
-void Amoled_DisplayPanel::setBrightness(uint8_t level) {
-    uint16_t brightness = level * 16;
+void Amoled_DisplayPanel::setBrightness(uint8_t level, uint32_t nowMs) {
+    _ramp.start(level, nowMs);
+}
 
-    brightness = brightness > 255 ? 255 : brightness;
-    brightness = brightness < 0 ? 0 : brightness;
+void Amoled_DisplayPanel::setBrightnessNow(uint8_t level) {
+    uint8_t value = BrightnessRamp::fromLevel(level);
+    if (display) {
+        lockBus();
+        display->setBrightness(value);
+        unlockBus();
+    }
+    _ramp.set(value);
+}
 
-    if (brightness > this->currentBrightness) {
-        for (int i = this->currentBrightness; i <= brightness; i++) {
-            display->setBrightness(i);
-            waitMs(1);
+bool Amoled_DisplayPanel::tickBrightness(uint32_t nowMs) {
+    if (!display) {
+        return false;
+    }
+    return _ramp.tick(nowMs, [this](uint8_t value) {
+        // Never wait behind a frame transfer; the next tick catches up.
+        if (_busMutex && xSemaphoreTake(_busMutex, 0) != pdTRUE) {
+            return false;
         }
-    } else {
-        for (int i = this->currentBrightness; i >= brightness; i--) {
-            display->setBrightness(i);
-            waitMs(1);
+        display->setBrightness(value);
+        if (_busMutex) {
+            xSemaphoreGive(_busMutex);
         }
-    }
-    this->currentBrightness = brightness;
+        return true;
+    });
 }
 
-uint8_t Amoled_DisplayPanel::getBrightness() { return (this->currentBrightness + 1) / 16; }
+uint8_t Amoled_DisplayPanel::getBrightness() {
+    return _ramp.level();
+}
 
 Amoled_Display_Panel_Type Amoled_DisplayPanel::getModel() { return panelType; }
 
@@ -166,12 +213,15 @@ void Amoled_DisplayPanel::sleep() {
     }
 
     sleepBrightnessLevel = getBrightness();
-    setBrightness(0);
+    setBrightnessNow(0);
     if (display) {
+        lockBus();
         display->displayOff();
+        unlockBus();
     }
     pinOutputLowIfValid(hwConfig.lcd_en);
     uninstallSD();
+    detachTouchIrq();
 
     if (WAKEUP_FROM_TOUCH != _wakeupMethod) {
         if (_touchDrv) {
@@ -194,13 +244,17 @@ void Amoled_DisplayPanel::sleep() {
         pinMode(hwConfig.tp_int, INPUT);
 
         // Wait for the finger to be lifted from the screen
+        bool lifted = false;
         while (!digitalRead(hwConfig.tp_int)) {
             waitMs(100);
             // Clear touch buffer
-            getPoint(x_array, y_array, get_point);
+            readTouch(x_array, y_array, get_point);
+            lifted = true;
         }
 
-        waitMs(2000); // Wait for the interrupt level to stabilize
+        if (lifted) {
+            waitMs(2000); // Wait for the interrupt level to stabilize
+        }
         esp_sleep_enable_ext1_wakeup(_BV(hwConfig.tp_int), ESP_EXT1_WAKEUP_ANY_LOW);
     } break;
     case WAKEUP_FROM_BUTTON:
@@ -214,6 +268,9 @@ void Amoled_DisplayPanel::sleep() {
         esp_sleep_enable_ext1_wakeup(_BV(0), ESP_EXT1_WAKEUP_ANY_LOW);
         break;
     }
+    if (_extraTimerUs && _wakeupMethod != WAKEUP_FROM_TIMER) {
+        esp_sleep_enable_timer_wakeup(_extraTimerUs);
+    }
 
     pinInputIfValid(hwConfig.lcd_cs);
     pinInputIfValid(hwConfig.lcd_sclk);
@@ -257,6 +314,7 @@ bool Amoled_DisplayPanel::wakeup() {
     }
 
     // Re-init touch on wake (tp_rst may not be wired).
+    detachTouchIrq();
     if (_touchDrv) {
         delete _touchDrv;
         _touchDrv = nullptr;
@@ -264,6 +322,7 @@ bool Amoled_DisplayPanel::wakeup() {
     if (!initTouch()) {
         ESP_LOGW("Amoled_DisplayPanel", "Touch init failed on wakeup");
     }
+    attachTouchIrq();
 
     if (!initDisplay(colorOrder)) {
         ESP_LOGW("Amoled_DisplayPanel", "Display init failed on wakeup");
@@ -278,12 +337,115 @@ bool Amoled_DisplayPanel::wakeup() {
         setRotation(0);
     }
     if (sleepBrightnessLevel > 0) {
-        setBrightness(sleepBrightnessLevel);
+        // The loop that advances ramps is not running yet.
+        setBrightnessNow(sleepBrightnessLevel);
     }
     return true;
 }
 
 uint8_t Amoled_DisplayPanel::getPoint(int16_t *x_array, int16_t *y_array, uint8_t get_point) {
+    updateTouch();
+    if (!_touchActive || get_point == 0) {
+        return 0;
+    }
+    x_array[0] = _touchX;
+    y_array[0] = _touchY;
+    return 1;
+}
+
+bool Amoled_DisplayPanel::isPressed() {
+    updateTouch();
+    return _touchActive;
+}
+
+void IRAM_ATTR Amoled_DisplayPanel::touchIsr(void *arg) {
+    Amoled_DisplayPanel *self = static_cast<Amoled_DisplayPanel *>(arg);
+    if (self->_touchWakeLevel) {
+        // Level triggered: stays asserted until the finger lifts. The driver's
+        // gpio_intr_disable() lives in flash and would fault on a touch during
+        // a flash write; the inlined register write is IRAM-safe. The
+        // dispatcher has already cleared the status bit.
+        gpio_ll_intr_disable(&GPIO, self->hwConfig.tp_int);
+    }
+    self->_touchIrqPending = true;
+    self->_touchIrqs = self->_touchIrqs + 1;
+    if (self->_touchIrqCb) {
+        self->_touchIrqCb();
+    }
+}
+
+void Amoled_DisplayPanel::attachTouchIrq() {
+    if (_touchIrqAttached || !_touchDrv || hwConfig.tp_int < 0) {
+        return;
+    }
+    // Read once straight away in case a finger is already down.
+    _touchIrqPending = true;
+    attachInterruptArg(hwConfig.tp_int, touchIsr, this, FALLING);
+    _touchIrqAttached = true;
+    if (_touchWakeLevel) {
+        gpio_wakeup_enable((gpio_num_t)hwConfig.tp_int, GPIO_INTR_LOW_LEVEL);
+    }
+}
+
+void Amoled_DisplayPanel::enableTouchLightSleepWake() {
+    if (hwConfig.tp_int < 0) {
+        return;
+    }
+    _touchWakeLevel = true;
+    if (_touchIrqAttached) {
+        gpio_wakeup_enable((gpio_num_t)hwConfig.tp_int, GPIO_INTR_LOW_LEVEL);
+    }
+    esp_sleep_enable_gpio_wakeup();
+}
+
+void Amoled_DisplayPanel::detachTouchIrq() {
+    if (!_touchIrqAttached) {
+        return;
+    }
+    if (_touchWakeLevel) {
+        gpio_wakeup_disable((gpio_num_t)hwConfig.tp_int);
+    }
+    detachInterrupt(hwConfig.tp_int);
+    _touchIrqAttached = false;
+    _touchActive = false;
+}
+
+void Amoled_DisplayPanel::updateTouch() {
+    if (!_touchDrv) {
+        _touchActive = false;
+        return;
+    }
+    bool pending = _touchIrqPending;
+    // Idle and no interrupt: nothing can have changed, skip the bus.
+    if (_touchIrqAttached && !pending && !_touchActive) {
+        return;
+    }
+    uint32_t now = millis();
+    // A new touch is read at once; an ongoing one (or a board without INT)
+    // is polled at the LVGL input rate.
+    bool newTouch = pending && !_touchActive;
+    if (!newTouch && _touchReads && (uint32_t)(now - _touchLastReadMs) < AMOLED_TOUCH_POLL_MS) {
+        return;
+    }
+    _touchIrqPending = false;
+    _touchLastReadMs = now;
+    _touchReads++;
+
+    // CST92xx reports every supported contact regardless of get_point.
+    int16_t x[AMOLED_TOUCH_MAX_POINTS];
+    int16_t y[AMOLED_TOUCH_MAX_POINTS];
+    _touchActive = readTouch(x, y, 1) > 0;
+    if (_touchActive) {
+        _touchX = x[0];
+        _touchY = y[0];
+    } else if (_touchWakeLevel && _touchIrqAttached) {
+        // Undoes the ISR's gpio_ll_intr_disable(); the driver call restores
+        // the enable bit for the core the handler was installed on.
+        gpio_intr_enable((gpio_num_t)hwConfig.tp_int);
+    }
+}
+
+uint8_t Amoled_DisplayPanel::readTouch(int16_t *x_array, int16_t *y_array, uint8_t get_point) {
     if (!_touchDrv || !_touchDrv->isPressed()) {
         return 0;
     }
@@ -320,32 +482,80 @@ uint8_t Amoled_DisplayPanel::getPoint(int16_t *x_array, int16_t *y_array, uint8_
     return points;
 }
 
-bool Amoled_DisplayPanel::isPressed() {
-    if (_touchDrv) {
-        return _touchDrv->isPressed();
+uint16_t Amoled_DisplayPanel::getBattVoltage(void) {
+    // PMU and ADC boards both answer from sampleBattery()'s filtered value,
+    // so a query never touches I2C or the ADC.
+    if (!pmuReady && hwConfig.battery_voltage_adc_data == -1) {
+        return 0;
+    }
+    return battSampled ? (uint16_t)((battFilteredMv16 + 8) >> 4) : 0;
+}
+
+int8_t Amoled_DisplayPanel::getBattPercent(void) {
+    // Resting single-cell LiPo discharge curve, mV -> percent.
+    static const uint16_t kCurve[][2] = {
+        {4200, 100}, {4100, 90}, {4000, 78}, {3900, 62}, {3800, 42},
+        {3750, 28},  {3700, 15}, {3600, 5},  {3300, 0},
+    };
+    uint16_t mv = getBattVoltage();
+    if (mv == 0) {
+        return -1;
+    }
+    const size_t n = sizeof(kCurve) / sizeof(kCurve[0]);
+    if (mv >= kCurve[0][0]) {
+        return 100;
+    }
+    for (size_t i = 1; i < n; i++) {
+        if (mv >= kCurve[i][0]) {
+            uint16_t hiMv = kCurve[i - 1][0], loMv = kCurve[i][0];
+            uint16_t hiPct = kCurve[i - 1][1], loPct = kCurve[i][1];
+            return (int8_t)(loPct + (uint32_t)(mv - loMv) * (hiPct - loPct) / (hiMv - loMv));
+        }
     }
     return 0;
 }
 
-uint16_t Amoled_DisplayPanel::getBattVoltage(void) {
+void Amoled_DisplayPanel::sampleBattery(uint32_t nowMs) {
+    if (battSampled && (int32_t)(nowMs - battLastSampleMs) < (int32_t)AMOLED_BATTERY_SAMPLE_MS) {
+        return;
+    }
+    battLastSampleMs = nowMs;
+
+    uint16_t mv = 0;
     if (pmuReady) {
-        return pmu.getBattVoltage();
+        mv = pmu.getBattVoltage();
+    } else if (hwConfig.battery_voltage_adc_data != -1) {
+        if (!adcCharacterized) {
+            esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_12, ADC_WIDTH_BIT_12, 1100, &adcChars);
+            adcCharacterized = true;
+        }
+        // The cell is read through a 1:2 divider.
+        mv = esp_adc_cal_raw_to_voltage(analogRead(hwConfig.battery_voltage_adc_data), &adcChars) * 2;
     }
-    if (hwConfig.battery_voltage_adc_data == -1) {
-        return 0;
+    if (mv == 0) {
+        return;
     }
-    esp_adc_cal_characteristics_t adc_chars;
-    esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_12, ADC_WIDTH_BIT_12, 1100, &adc_chars);
 
-    const int number_of_samples = 20;
-    uint32_t sum = 0;
-    for (int i = 0; i < number_of_samples; i++) {
-        sum += analogRead(hwConfig.battery_voltage_adc_data);
-        waitMs(2);
+    // Median of the last few readings drops single-sample spikes from radio
+    // bursts; the EMA on top smooths what is left.
+    const uint8_t window = sizeof(battWindow) / sizeof(battWindow[0]);
+    battWindow[battWindowNext] = mv;
+    battWindowNext = (battWindowNext + 1) % window;
+    if (battWindowCount < window) {
+        battWindowCount++;
     }
-    sum = sum / number_of_samples;
+    uint16_t sorted[window];
+    memcpy(sorted, battWindow, battWindowCount * sizeof(sorted[0]));
+    std::sort(sorted, sorted + battWindowCount);
+    uint32_t median16 = (uint32_t)sorted[battWindowCount / 2] << 4;
 
-    return esp_adc_cal_raw_to_voltage(sum, &adc_chars) * 2;
+    if (!battSampled) {
+        battFilteredMv16 = median16;
+        battSampled = true;
+    } else {
+        battFilteredMv16 = battFilteredMv16 - (battFilteredMv16 >> AMOLED_BATTERY_EMA_SHIFT) +
+                           (median16 >> AMOLED_BATTERY_EMA_SHIFT);
+    }
 }
 
 bool Amoled_DisplayPanel::hasPowerManagement() {
@@ -366,15 +576,95 @@ bool Amoled_DisplayPanel::isVbusPresent() {
 
 void Amoled_DisplayPanel::pushColors(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *data) {
     if (displayBus && display) {
+        lockBus();
+        drawBitmap(x, y, width, height, data);
+        unlockBus();
+    }
+}
+
+void Amoled_DisplayPanel::pushColorsAsync(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *data,
+                                          FlushDoneCallback done, void *ctx) {
+    if (!displayBus || !display || !startFlushTask()) {
+        pushColors(x, y, width, height, data);
+        done(ctx);
+        return;
+    }
+    FlushJob job = {x, y, width, height, data, done, ctx};
+    xQueueSend(_flushQueue, &job, portMAX_DELAY);
+}
+
+bool Amoled_DisplayPanel::isRound() {
+#if DISPLAY_CIRCLE_CLIP
+    return hwConfig.round_panel && hwConfig.lcd_width == hwConfig.lcd_height;
+#else
+    return false;
+#endif
+}
+
+void Amoled_DisplayPanel::drawBitmap(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *data) {
+    if (isRound()) {
+        display->drawRound16bitRGBBitmap(x, y, data, width, height, hwConfig.lcd_width);
+    } else {
         display->draw16bitRGBBitmap(x, y, data, width, height);
     }
 }
 
+bool Amoled_DisplayPanel::startFlushTask() {
+    if (_flushTask) {
+        return true;
+    }
+    if (!_busMutex) {
+        _busMutex = xSemaphoreCreateMutex();
+    }
+    if (!_flushQueue) {
+        // LVGL has at most one flush outstanding per draw buffer.
+        _flushQueue = xQueueCreate(2, sizeof(FlushJob));
+    }
+    if (!_busMutex || !_flushQueue) {
+        return false;
+    }
+    if (xTaskCreatePinnedToCore(flushTask, "dispFlush", 4096, this, AMOLED_FLUSH_TASK_PRIORITY, &_flushTask,
+                                AMOLED_FLUSH_TASK_CORE) != pdPASS) {
+        _flushTask = nullptr;
+        ESP_LOGW("Amoled_DisplayPanel", "Flush task start failed; flushing synchronously");
+        return false;
+    }
+    return true;
+}
+
+void Amoled_DisplayPanel::flushTask(void *arg) {
+    Amoled_DisplayPanel *self = static_cast<Amoled_DisplayPanel *>(arg);
+    FlushJob job;
+    for (;;) {
+        if (xQueueReceive(self->_flushQueue, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        self->lockBus();
+        self->drawBitmap(job.x, job.y, job.w, job.h, job.data);
+        self->unlockBus();
+        job.done(job.ctx);
+    }
+}
+
+void Amoled_DisplayPanel::lockBus() {
+    if (_busMutex) {
+        xSemaphoreTake(_busMutex, portMAX_DELAY);
+    }
+}
+
+void Amoled_DisplayPanel::unlockBus() {
+    if (_busMutex) {
+        xSemaphoreGive(_busMutex);
+    }
+}
+
 void Amoled_DisplayPanel::setRotation(uint8_t rotation) {
     _rotation = rotation;
 
     if (displayBus && display) {
+        lockBus();
         display->setRotation(rotation);
+        unlockBus();
     }
 }
 
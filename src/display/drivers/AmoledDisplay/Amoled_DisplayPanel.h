@@ -11,6 +11,10 @@
 
 #include <Arduino.h>
 #include <Arduino_GFX_Library.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
 #include <memory>
 
 #ifndef BOARD_HAS_PSRAM
@@ -20,6 +24,8 @@
 #include "CO5300.h"
 #include "pin_config.h"
 #include <SD_MMC.h>
+#include <esp_adc_cal.h>
+#include <display/drivers/common/BrightnessRamp.h>
 #include <display/drivers/common/Display.h>
 #include <display/drivers/common/ext.h>
 #define XPOWERS_CHIP_SY6970
@@ -64,7 +70,13 @@ class Amoled_DisplayPanel : public Display {
 
     void uninstallSD();
 
-    void setBrightness(uint8_t level);
+    // Starts an eased ramp towards level (0..16) and returns immediately;
+    // tickBrightness() advances it and returns true while still ramping.
+    // Both take the clock from the caller, so a ramp can be stepped with any
+    // time source. Paths that run before the loop use setBrightnessNow().
+    void setBrightness(uint8_t level, uint32_t nowMs = millis());
+    void setBrightnessNow(uint8_t level);
+    bool tickBrightness(uint32_t nowMs);
 
     uint8_t getBrightness();
 
@@ -75,6 +87,8 @@ class Amoled_DisplayPanel : public Display {
     void enableTouchWakeup();
     void enableButtonWakeup();
     void enableTimerWakeup(uint64_t time_in_us);
+    // Adds a timer wake-up on top of the touch or button method; 0 removes it.
+    void setWakeupTimer(uint64_t time_in_us) { _extraTimerUs = time_in_us; }
 
     void sleep();
 
@@ -84,11 +98,29 @@ class Amoled_DisplayPanel : public Display {
 
     uint16_t height() override { return hwConfig.lcd_height; };
 
+    // Touch state is cached: the controller is only read over I2C after its
+    // INT line fires and then while a finger stays down, at most once per
+    // AMOLED_TOUCH_POLL_MS. getPoint() reports the first contact only.
     uint8_t getPoint(int16_t *x_array, int16_t *y_array, uint8_t get_point = 1);
 
     bool isPressed();
 
+    // Called from the touch interrupt, so it must be safe to run in an ISR.
+    void setTouchIrqCallback(void (*cb)()) { _touchIrqCb = cb; }
+    uint32_t touchIrqCount() const { return _touchIrqs; }
+    uint32_t touchReadCount() const { return _touchReads; }
+    // Lets a touch wake the chip from automatic light sleep. Light-sleep
+    // wake-up is level triggered, so the interrupt then fires once per touch
+    // and is re-armed when the finger lifts.
+    void enableTouchLightSleepWake();
+
+    // Takes at most one battery reading per AMOLED_BATTERY_SAMPLE_MS and folds
+    // it into the filtered value; cheap enough to call every loop iteration.
+    void sampleBattery(uint32_t nowMs);
+    // Filtered battery voltage in mV (0 if unknown) and the matching LiPo
+    // state of charge in percent (-1 if unknown).
     uint16_t getBattVoltage(void);
+    int8_t getBattPercent(void);
     bool hasPowerManagement();
     bool isCharging();
     bool isChargeDone();
@@ -96,31 +128,83 @@ class Amoled_DisplayPanel : public Display {
 
     void pushColors(uint16_t x, uint16_t y, uint16_t width, uint16_t hight, uint16_t *data);
 
+    void pushColorsAsync(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *data,
+                         FlushDoneCallback done, void *ctx) override;
+
     bool supportsDirectMode() { return true; }
 
+    bool isRound() override;
+
+
     void setRotation(uint8_t rotation);
 
     Arduino_GFX *gfx() { return display; }
 
   private:
+    struct FlushJob {
+        uint16_t x;
+        uint16_t y;
+        uint16_t w;
+        uint16_t h;
+        uint16_t *data;
+        FlushDoneCallback done;
+        void *ctx;
+    };
+
     bool initTouch();
+    uint8_t readTouch(int16_t *x_array, int16_t *y_array, uint8_t get_point);
+    void updateTouch();
+    void attachTouchIrq();
+    void detachTouchIrq();
+    static void touchIsr(void *arg);
     bool initDisplay(Amoled_Display_Panel_Color_Order colorOrder);
+    void drawBitmap(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *data);
+    bool startFlushTask();
+    static void flushTask(void *arg);
+    void lockBus();
+    void unlockBus();
 
   private:
     AmoledHwConfig hwConfig;
     TouchDrvInterface *_touchDrv = nullptr;
+    void (*_touchIrqCb)() = nullptr;
+    volatile bool _touchIrqPending = false;
+    volatile uint32_t _touchIrqs = 0;
+    bool _touchIrqAttached = false;
+    bool _touchWakeLevel = false;
+    bool _touchActive = false;
+    int16_t _touchX = 0;
+    int16_t _touchY = 0;
+    uint32_t _touchLastReadMs = 0;
+    uint32_t _touchReads = 0;
     Arduino_DataBus *displayBus = nullptr;
     CO5300 *display = nullptr;
 
-    uint8_t currentBrightness = 0;
+    BrightnessRamp _ramp;
     uint8_t sleepBrightnessLevel = 0;
     Amoled_Display_Panel_Color_Order colorOrder = ORDER_RGB;
     XPowersPPM pmu;
     bool pmuReady = false;
 
+    esp_adc_cal_characteristics_t adcChars;
+    bool adcCharacterized = false;
+    uint16_t battWindow[5] = {};
+    uint8_t battWindowCount = 0;
+    uint8_t battWindowNext = 0;
+    uint32_t battFilteredMv16 = 0;  // EMA of the window median, mV * 16
+    uint32_t battLastSampleMs = 0;
+    bool battSampled = false;
+
     Amoled_Display_Panel_Type panelType = DISPLAY_UNKNOWN;
     Amoled_Display_Panel_TouchType touchType = TOUCH_UNKNOWN;
 
     Amoled_Display_Panel_Wakeup_Method _wakeupMethod;
     uint64_t _sleepTimeUs;
+    uint64_t _extraTimerUs = 0;
+
+    // Queued flushes run on a separate task; every other bus access holds
+    // the bus mutex so it cannot interleave with a transfer in flight.
+    TaskHandle_t _flushTask = nullptr;
+    QueueHandle_t _flushQueue = nullptr;
+    SemaphoreHandle_t _busMutex = nullptr;
 };
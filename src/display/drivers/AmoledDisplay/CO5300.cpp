@@ -1,5 +1,7 @@
 #include "CO5300.h"
 
+#include <display/drivers/common/CircleClip.h>
+
 #ifndef CO5300_REQUIRE_2X2_UPDATES
 #define CO5300_REQUIRE_2X2_UPDATES 1
 #endif
@@ -67,6 +69,33 @@ CO5300::CO5300(Arduino_DataBus *bus, int8_t rst, uint8_t r, bool ips, int16_t w,
       _color_order(color_order),
       _stroke_bg_color(BLACK) {}
 
+uint32_t CO5300::drawRound16bitRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h,
+                                         int16_t size) {
+    if (((x | y | w | h) & 1) || x < 0 || y < 0 || x + w > _width || y + h > _height) {
+        draw16bitRGBBitmap(x, y, bitmap, w, h);
+        return (uint32_t)w * h;
+    }
+
+    uint32_t written = 0;
+    startWrite();
+    for (int16_t row = y; row < y + h; row += 2) {
+        int16_t s0, s1;
+        if (!circleBandSpan(row, size, s0, s1)) continue;
+        int16_t bx = s0 > x ? s0 : x;
+        int16_t bw = (s1 < x + w ? s1 : x + w) - bx;
+        if (bw <= 0) continue;
+        // Band windows start on even coordinates with even sizes, so they
+        // already satisfy alignRect2x2 and map onto the source rows exactly.
+        writeAddrWindow(bx, row, bw, 2);
+        uint16_t *src = bitmap + (uint32_t)(row - y) * w + (bx - x);
+        _bus->writePixels(src, bw);
+        _bus->writePixels(src + w, bw);
+        written += (uint32_t)bw * 2;
+    }
+    endWrite();
+    return written;
+}
+
 void CO5300::setRotation(uint8_t r) {
     Arduino_TFT::setRotation(r);
     switch (_rotation) {
@@ -11,6 +11,11 @@ class CO5300 : public Arduino_CO5300 {
            uint8_t row_offset2 = 0, uint8_t color_order = CO5300_MADCTL_RGB);
     void setRotation(uint8_t r) override;
 
+    // Pushes only the parts of a w x h bitmap that fall inside a round panel
+    // of diameter `size`, one 2-row band window at a time. Rectangles that are
+    // not 2x2 aligned are pushed whole. Returns the number of pixels written.
+    uint32_t drawRound16bitRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h, int16_t size);
+
   private:
     uint8_t _color_order;
     uint16_t _stroke_bg_color;
@@ -26,6 +26,7 @@ struct AmoledHwConfig {
     int8_t rotation_175;
     int8_t default_rotation;
     bool mirror_touch;
+    bool round_panel;
 };
 
 constexpr AmoledHwConfig LILYGO_T_DISPLAY_S3_DS_HW_CONFIG{
@@ -54,6 +55,7 @@ constexpr AmoledHwConfig LILYGO_T_DISPLAY_S3_DS_HW_CONFIG{
     .rotation_175 = 2,
     .default_rotation = 2,
     .mirror_touch = false,
+    .round_panel = true,
 };
 
 constexpr AmoledHwConfig WAVESHARE_S3_AMOLED_HW_CONFIG{
@@ -82,6 +84,7 @@ constexpr AmoledHwConfig WAVESHARE_S3_AMOLED_HW_CONFIG{
     .rotation_175 = 0,
     .default_rotation = 0,
     .mirror_touch = true,
+    .round_panel = true,
 };
 
 #define CST92XX_DEVICE_ADDRESS 0x5A
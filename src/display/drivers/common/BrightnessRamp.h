@@ -0,0 +1,89 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+// A full 0..255 brightness sweep takes this long; smaller steps scale down
+// but never below the minimum, so short changes still fade.
+#ifndef AMOLED_BRIGHTNESS_RAMP_MS
+#define AMOLED_BRIGHTNESS_RAMP_MS 250
+#endif
+
+#ifndef AMOLED_BRIGHTNESS_RAMP_MIN_MS
+#define AMOLED_BRIGHTNESS_RAMP_MIN_MS 40
+#endif
+
+// Eased fade of a panel's 0..255 brightness register. Levels are the UI's
+// 0..16 steps. The clock comes from the caller and the register write is a
+// callable that may refuse (bus busy), so the ramp runs without hardware.
+class BrightnessRamp {
+  public:
+    static uint8_t fromLevel(uint8_t level) {
+        uint16_t brightness = level * 16;
+        return brightness > 255 ? 255 : (uint8_t)brightness;
+    }
+
+    // Starts a ramp towards level from wherever the panel is now, so a
+    // reversal mid-ramp is smooth. Asking for the current target is a no-op.
+    void start(uint8_t level, uint32_t nowMs) {
+        uint8_t target = fromLevel(level);
+        if (target == (_active ? _to : _current)) {
+            return;
+        }
+        uint16_t delta = target > _current ? target - _current : _current - target;
+        uint32_t duration = (uint32_t)AMOLED_BRIGHTNESS_RAMP_MS * delta / 255;
+        _from = _current;
+        _to = target;
+        _startMs = nowMs;
+        _durationMs = duration < AMOLED_BRIGHTNESS_RAMP_MIN_MS ? AMOLED_BRIGHTNESS_RAMP_MIN_MS : duration;
+        _active = delta > 0;
+    }
+
+    // Records a value written directly, ending any ramp.
+    void set(uint8_t value) {
+        _active = false;
+        _current = value;
+    }
+
+    // Writes the value due at nowMs through write(uint8_t) -> bool. A refused
+    // write leaves the ramp where it was; the next tick catches up. Returns
+    // true while the ramp is still running.
+    template <typename Write>
+    bool tick(uint32_t nowMs, Write &&write) {
+        if (!_active) {
+            return false;
+        }
+        uint32_t elapsed = nowMs - _startMs;
+        uint8_t value = _to;
+        if (elapsed < _durationMs) {
+            // Smoothstep: slow at both ends, so steps are least visible where
+            // the panel is most sensitive.
+            float t = (float)elapsed / _durationMs;
+            float eased = t * t * (3.0f - 2.0f * t);
+            value = (uint8_t)lroundf(_from + ((int)_to - (int)_from) * eased);
+        }
+        if (value != _current) {
+            if (!write(value)) {
+                return true;
+            }
+            _current = value;
+        }
+        if (value == _to) {
+            _active = false;
+        }
+        return _active;
+    }
+
+    // The level being shown or ramped to, rounded back to 0..16.
+    uint8_t level() const { return ((_active ? _to : _current) + 1) / 16; }
+    uint8_t current() const { return _current; }
+    bool active() const { return _active; }
+
+  private:
+    uint8_t _current = 0;
+    uint8_t _from = 0;
+    uint8_t _to = 0;
+    uint32_t _startMs = 0;
+    uint32_t _durationMs = 0;
+    bool _active = false;
+};
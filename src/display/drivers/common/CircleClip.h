@@ -0,0 +1,68 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+// Geometry of a round panel inscribed in its square frame buffer of side
+// `size`. Spans are computed per 2-row band and widened to even columns, so
+// every span keeps the 2x2 update alignment the CO5300 requires.
+
+// Columns [x0, x1) of the band starting at even row y that touch the circle.
+inline bool circleBandSpan(int16_t y, int16_t size, int16_t &x0, int16_t &x1) {
+    float r = size * 0.5f;
+    float top = (float)y;
+    float bottom = (float)(y + 2);
+    float dy = 0.0f;
+    if (bottom < r) {
+        dy = r - bottom;
+    } else if (top > r) {
+        dy = top - r;
+    }
+    if (dy >= r) return false;
+
+    float half = sqrtf(r * r - dy * dy);
+    int16_t a = (int16_t)floorf(r - half) & ~1;
+    int16_t b = (int16_t)ceilf(r + half);
+    if (b & 1) b += 1;
+    if (a < 0) a = 0;
+    if (b > size) b = size;
+    x0 = a;
+    x1 = b;
+    return a < b;
+}
+
+// Shrinks the inclusive rectangle to the circle's bounding box inside it.
+// Expects and preserves 2x2 alignment; returns false (rectangle untouched)
+// when it lies entirely outside the circle.
+inline bool circleClipRect(int16_t &x1, int16_t &y1, int16_t &x2, int16_t &y2, int16_t size) {
+    int16_t c = size / 2;
+    // The widest span of a rectangle is on its row (column) closest to the
+    // centre; the circle is symmetric, so one helper covers both axes.
+    int16_t rowNearest = c < y1 ? y1 : (c > y2 ? y2 : c);
+    int16_t colNearest = c < x1 ? x1 : (c > x2 ? x2 : c);
+    int16_t sx0, sx1, sy0, sy1;
+    if (!circleBandSpan(rowNearest & ~1, size, sx0, sx1)) return false;
+    if (!circleBandSpan(colNearest & ~1, size, sy0, sy1)) return false;
+    if (sx0 > x2 || sx1 <= x1 || sy0 > y2 || sy1 <= y1) return false;
+
+    if (x1 < sx0) x1 = sx0;
+    if (x2 >= sx1) x2 = sx1 - 1;
+    if (y1 < sy0) y1 = sy0;
+    if (y2 >= sy1) y2 = sy1 - 1;
+    return true;
+}
+
+// Pixels of a w x h rectangle at (x, y) that a band-wise push would send;
+// unaligned rectangles are sent whole.
+inline uint32_t circleSpanPixels(int16_t x, int16_t y, int16_t w, int16_t h, int16_t size) {
+    if ((x | y | w | h) & 1) return (uint32_t)w * h;
+    uint32_t px = 0;
+    for (int16_t row = y; row < y + h; row += 2) {
+        int16_t s0, s1;
+        if (!circleBandSpan(row, size, s0, s1)) continue;
+        int16_t a = s0 > x ? s0 : x;
+        int16_t b = s1 < x + w ? s1 : x + w;
+        if (b > a) px += (uint32_t)(b - a) * 2;
+    }
+    return px;
+}
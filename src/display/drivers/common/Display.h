@@ -4,14 +4,25 @@
 
 class Display {
   public:
+    typedef void (*FlushDoneCallback)(void *ctx);
+
     virtual ~Display() = default;
 
     Display() : _rotation(0) {};
     virtual void pushColors(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *data) = 0;
+    // Queues the transfer and calls done(ctx) once data may be reused, possibly
+    // from another task. Panels without a transfer queue push synchronously.
+    virtual void pushColorsAsync(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *data,
+                                 FlushDoneCallback done, void *ctx) {
+        pushColors(x, y, width, height, data);
+        done(ctx);
+    }
     virtual uint16_t width() = 0;
     virtual uint16_t height() = 0;
     virtual uint8_t getPoint(int16_t *x, int16_t *y, uint8_t get_point) = 0;
     virtual bool supportsDirectMode() = 0;
+    // True when the visible area is the circle inscribed in width() x height().
+    virtual bool isRound() { return false; }
 
   protected:
     uint8_t _rotation;
@@ -6,8 +6,16 @@
  *
  */
 #include "LV_Helper.h"
+#include "CircleClip.h"
+#include "Luminance.h"
+#include "config_features.h"
+#include "config_hw.h"
 #include "log.h"
 
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
 #if LV_VERSION_CHECK(9, 0, 0)
 #error "LVGL 9.x not supported"
 #endif
@@ -17,6 +25,67 @@ static lv_disp_drv_t disp_drv;
 static lv_indev_drv_t indev_drv;
 static lv_color_t *buf = nullptr;
 static lv_color_t *buf1 = nullptr;
+static bool g_partialMode = false;
+static lv_timer_cb_t g_refrTimerCb = nullptr;
+static LvglRenderStats g_stats;
+static uint32_t g_refrFlushUs = 0;
+static uint32_t g_refrStallUs = 0;
+static uint32_t g_refrPixels = 0;
+static uint32_t g_refrSkipped = 0;
+static bool g_inRefresh = false;
+static uint16_t g_refrAreas = 0;
+static uint32_t g_flushStartUs = 0;
+static SemaphoreHandle_t g_flushDone = nullptr;
+static portMUX_TYPE g_statsMux = portMUX_INITIALIZER_UNLOCKED;
+#if LVGL_LUMA_ACCOUNTING
+// Luminance of every pixel as last flushed, so partial refreshes keep a
+// whole-panel total; pixels a round panel never shows stay at zero.
+static LumaTables g_luma;
+static uint8_t *g_lumaMap = nullptr;
+static uint32_t g_lumaTotal = 0;
+static uint32_t g_lumaVisiblePx = 0;
+#endif
+
+static bool g_profile = LVGL_PROFILE_AT_BOOT;
+static LatencyHistogram g_profileHist[kLvglMetricCount];
+static const uint32_t kUsBounds[LATENCY_HIST_BUCKETS - 1] = {
+    250, 500, 1000, 2000, 3000, 5000, 7500, 10000, 15000,
+    20000, 30000, 40000, 50000, 75000, 100000, 150000, 250000};
+static const uint32_t kPxBounds[LATENCY_HIST_BUCKETS - 1] = {
+    256, 1024, 2048, 4096, 8192, 12288, 16384, 24576, 32768,
+    49152, 65536, 98304, 131072, 163840, 196608, 217156, 262144};
+static const uint32_t kAreaBounds[LATENCY_HIST_BUCKETS - 1] = {
+    1, 2, 3, 4, 5, 6, 8, 10, 12, 16, 20, 24, 32, 48, 64, 96, 128};
+
+static const uint32_t *metricBounds(LvglMetric metric) {
+  switch (metric) {
+    case LvglMetric::RenderUs:
+    case LvglMetric::FlushUs: return kUsBounds;
+    case LvglMetric::RenderedPx:
+    case LvglMetric::FlushedPx: return kPxBounds;
+    default: return kAreaBounds;
+  }
+}
+
+static void profileAdd(LvglMetric metric, uint32_t value) {
+  latencyHistogramAdd(g_profileHist[(size_t)metric], metricBounds(metric), value);
+}
+
+// LVGL reports the pixels it actually rendered in a refresh; in direct mode
+// this is the dirty area while the flush is always the full frame.
+static void monitor_cb(lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px) {
+  (void)disp_drv;
+  (void)time;
+  if (g_profile) profileAdd(LvglMetric::RenderedPx, px);
+}
+
+// The rounder sees every invalidated area. In partial mode LVGL also calls
+// it while sizing stripes during a refresh; those calls are not counted.
+static void countInvalidated(const lv_area_t *area) {
+  if (g_partialMode && g_inRefresh) return;
+  if (area->x2 < area->x1 || area->y2 < area->y1) return;
+  g_stats.invalidatedPixels += lv_area_get_size(area);
+}
 
 static void rounder_cb(lv_disp_drv_t *disp_drv, lv_area_t *area) {
   if (area->x1 % 2 != 0) area->x1 += 1;
@@ -26,16 +95,197 @@ static void rounder_cb(lv_disp_drv_t *disp_drv, lv_area_t *area) {
   uint32_t h = (area->y2 - area->y1 + 1);
   if (w % 2 != 0) area->x2 -= 1;
   if (h % 2 != 0) area->y2 -= 1;
+
+#if DISPLAY_CIRCLE_CLIP
+  Display *board = static_cast<Display *>(disp_drv->user_data);
+  if (!board->isRound() || area->x2 < area->x1 || area->y2 < area->y1) {
+    countInvalidated(area);
+    return;
+  }
+  uint32_t before = (uint32_t)lv_area_get_size(area);
+  int16_t cx1 = area->x1, cy1 = area->y1, cx2 = area->x2, cy2 = area->y2;
+  if (circleClipRect(cx1, cy1, cx2, cy2, (int16_t)disp_drv->hor_res)) {
+    area->x1 = cx1;
+    area->y1 = cy1;
+    area->x2 = cx2;
+    area->y2 = cy2;
+    if (!(g_partialMode && g_inRefresh)) g_stats.trimmedPixels += before - lv_area_get_size(area);
+  }
+#endif
+  countInvalidated(area);
+}
+
+#if LVGL_LUMA_ACCOUNTING
+static void lumaAccount(Display &board, const lv_area_t *area, const uint16_t *data) {
+  int16_t w = area->x2 - area->x1 + 1;
+  int16_t h = area->y2 - area->y1 + 1;
+  int16_t stride = disp_drv.hor_res;
+  int32_t delta = 0;
+#if DISPLAY_CIRCLE_CLIP
+  if (board.isRound() && !((area->x1 | area->y1 | w | h) & 1)) {
+    for (int16_t row = area->y1; row <= area->y2; row += 2) {
+      int16_t s0, s1;
+      if (!circleBandSpan(row, stride, s0, s1)) continue;
+      int16_t a = s0 > area->x1 ? s0 : area->x1;
+      int16_t b = s1 < area->x2 + 1 ? s1 : area->x2 + 1;
+      if (b <= a) continue;
+      for (int16_t r = row; r < row + 2; ++r) {
+        const uint16_t *src = data + (uint32_t)(r - area->y1) * w + (a - area->x1);
+        delta += lumaUpdateRow(g_luma, src, g_lumaMap + (uint32_t)r * stride + a, b - a);
+      }
+    }
+    g_lumaTotal += delta;
+    return;
+  }
+#endif
+  (void)board;
+  for (int16_t r = 0; r < h; ++r) {
+    delta += lumaUpdateRow(g_luma, data + (uint32_t)r * w,
+                           g_lumaMap + (uint32_t)(area->y1 + r) * stride + area->x1, w);
+  }
+  g_lumaTotal += delta;
+}
+
+static void lumaInit(Display &board) {
+  uint32_t px = (uint32_t)board.width() * board.height();
+  g_lumaMap = reinterpret_cast<uint8_t *>(ps_calloc(px, 1));
+  if (!g_lumaMap) {
+    LOG_WARN("Luminance accounting disabled: map allocation failed");
+    return;
+  }
+  lumaBuildTables(g_luma);
+  g_lumaVisiblePx = px;
+#if DISPLAY_CIRCLE_CLIP
+  if (board.isRound()) g_lumaVisiblePx = circleSpanPixels(0, 0, board.width(), board.height(), board.width());
+#endif
+}
+#endif
+
+// Runs on the panel's transfer task once the buffer is off the bus.
+static void flush_done(void *ctx) {
+  uint32_t busUs = micros() - g_flushStartUs;
+  portENTER_CRITICAL(&g_statsMux);
+  g_refrFlushUs += busUs;
+  portEXIT_CRITICAL(&g_statsMux);
+  lv_disp_flush_ready(static_cast<lv_disp_drv_t *>(ctx));
+  if (g_flushDone) xSemaphoreGive(g_flushDone);
 }
 
 static void disp_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
   uint16_t w = area->x2 - area->x1 + 1;
   uint16_t h = area->y2 - area->y1 + 1;
-  static_cast<Display *>(disp_drv->user_data)->pushColors(area->x1, area->y1, w, h,
-                                                         reinterpret_cast<uint16_t *>(color_p));
+  Display *board = static_cast<Display *>(disp_drv->user_data);
+  uint16_t *data = reinterpret_cast<uint16_t *>(color_p);
+  g_refrPixels += (uint32_t)w * h;
+  ++g_refrAreas;
+#if DISPLAY_CIRCLE_CLIP
+  if (board->isRound()) {
+    g_refrSkipped += (uint32_t)w * h - circleSpanPixels(area->x1, area->y1, w, h, disp_drv->hor_res);
+  }
+#endif
+#if LVGL_LUMA_ACCOUNTING
+  if (g_lumaMap) lumaAccount(*board, area, data);
+#endif
+  g_flushStartUs = micros();
+#if LVGL_ASYNC_FLUSH
+  if (g_flushDone) {
+    board->pushColorsAsync(area->x1, area->y1, w, h, data, flush_done, disp_drv);
+    return;
+  }
+#endif
+  board->pushColors(area->x1, area->y1, w, h, data);
+  uint32_t busUs = micros() - g_flushStartUs;
+  portENTER_CRITICAL(&g_statsMux);
+  g_refrFlushUs += busUs;
+  g_refrStallUs += busUs;
+  portEXIT_CRITICAL(&g_statsMux);
   lv_disp_flush_ready(disp_drv);
 }
 
+// LVGL spins on this while a flush is outstanding; block instead so the core
+// is free until the transfer task signals completion.
+static void disp_wait(lv_disp_drv_t *disp_drv) {
+  (void)disp_drv;
+  uint32_t start = micros();
+  xSemaphoreTake(g_flushDone, pdMS_TO_TICKS(5));
+  uint32_t waitedUs = micros() - start;
+  portENTER_CRITICAL(&g_statsMux);
+  g_refrStallUs += waitedUs;
+  portEXIT_CRITICAL(&g_statsMux);
+}
+
+// Wraps LVGL's display refresh timer so a whole refresh can be timed; the
+// time not spent waiting for the bus is rendering. With async flushes a
+// transfer may finish after the refresh returns and is counted in the next.
+static void refr_timer_cb(lv_timer_t *timer) {
+  portENTER_CRITICAL(&g_statsMux);
+  g_refrFlushUs = 0;
+  g_refrStallUs = 0;
+  portEXIT_CRITICAL(&g_statsMux);
+  g_refrPixels = 0;
+  g_refrSkipped = 0;
+  g_refrAreas = 0;
+  uint32_t start = micros();
+  g_inRefresh = true;
+  g_refrTimerCb(timer);
+  g_inRefresh = false;
+  uint32_t total = micros() - start;
+  if (!g_refrAreas) return;
+
+  portENTER_CRITICAL(&g_statsMux);
+  uint32_t flushUs = g_refrFlushUs;
+  uint32_t stallUs = g_refrStallUs;
+  portEXIT_CRITICAL(&g_statsMux);
+  uint32_t renderUs = total > stallUs ? total - stallUs : 0;
+  ++g_stats.frames;
+  g_stats.areas += g_refrAreas;
+  g_stats.pixels += g_refrPixels;
+  g_stats.skippedPixels += g_refrSkipped;
+  g_stats.renderUs += renderUs;
+  g_stats.flushUs += flushUs;
+  g_stats.stallUs += stallUs;
+  g_stats.lastRenderUs = renderUs;
+  g_stats.lastFlushUs = flushUs;
+  g_stats.lastPixels = g_refrPixels;
+#if LVGL_LUMA_ACCOUNTING
+  if (g_lumaVisiblePx) {
+    g_stats.lastAplPermille = (uint16_t)((uint64_t)g_lumaTotal * 1000 / (255ULL * g_lumaVisiblePx));
+    g_stats.aplPermilleTotal += g_stats.lastAplPermille;
+  }
+#endif
+
+  if (g_profile) {
+    profileAdd(LvglMetric::RenderUs, renderUs);
+    profileAdd(LvglMetric::FlushUs, flushUs);
+    profileAdd(LvglMetric::FlushedPx, g_refrPixels);
+    profileAdd(LvglMetric::Areas, g_refrAreas);
+  }
+}
+
+static bool allocStripeBuffers(Display &board) {
+#if LVGL_DRAW_BUF_LINES > 0
+  uint32_t px = (uint32_t)board.width() * LVGL_DRAW_BUF_LINES;
+  size_t bytes = px * sizeof(lv_color_t);
+  const uint32_t caps = MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL;
+  buf = reinterpret_cast<lv_color_t *>(heap_caps_malloc(bytes, caps));
+  buf1 = reinterpret_cast<lv_color_t *>(heap_caps_malloc(bytes, caps));
+  if (buf && buf1) {
+    lv_disp_draw_buf_init(&draw_buf, buf, buf1, px);
+    LOG_INFO("LVGL partial mode: 2 x %u lines (%u bytes each) in internal SRAM",
+             (unsigned)LVGL_DRAW_BUF_LINES, (unsigned)bytes);
+    return true;
+  }
+  heap_caps_free(buf);
+  heap_caps_free(buf1);
+  buf = nullptr;
+  buf1 = nullptr;
+  LOG_WARN("LVGL stripe buffers unavailable; using full PSRAM buffers");
+#else
+  (void)board;
+#endif
+  return false;
+}
+
 static void touchpad_read(lv_indev_drv_t *indev_driver, lv_indev_data_t *data) {
   static int16_t x, y;
   uint8_t touched = static_cast<Display *>(indev_driver->user_data)->getPoint(&x, &y, 1);
@@ -75,15 +325,22 @@ void beginLvglHelper(Display &board, bool debug) {
   }
 #endif
 
-  size_t lv_buffer_size = board.width() * board.height() * sizeof(lv_color_t);
-  buf = reinterpret_cast<lv_color_t *>(ps_malloc(lv_buffer_size));
-  buf1 = reinterpret_cast<lv_color_t *>(ps_malloc(lv_buffer_size));
-  if (!buf || !buf1) {
-    LOG_ERROR("LVGL buffer allocation failed");
-    return;
+  g_partialMode = allocStripeBuffers(board);
+  if (!g_partialMode) {
+    size_t lv_buffer_size = board.width() * board.height() * sizeof(lv_color_t);
+    buf = reinterpret_cast<lv_color_t *>(ps_malloc(lv_buffer_size));
+    buf1 = reinterpret_cast<lv_color_t *>(ps_malloc(lv_buffer_size));
+    if (!buf || !buf1) {
+      LOG_ERROR("LVGL buffer allocation failed");
+      return;
+    }
+
+    lv_disp_draw_buf_init(&draw_buf, buf, buf1, board.width() * board.height());
   }
 
-  lv_disp_draw_buf_init(&draw_buf, buf, buf1, board.width() * board.height());
+#if LVGL_LUMA_ACCOUNTING
+  lumaInit(board);
+#endif
 
   lv_disp_drv_init(&disp_drv);
   disp_drv.hor_res = board.width();
@@ -91,10 +348,23 @@ void beginLvglHelper(Display &board, bool debug) {
   disp_drv.flush_cb = disp_flush;
   disp_drv.draw_buf = &draw_buf;
   disp_drv.full_refresh = 0;
-  disp_drv.direct_mode = 1;
+  disp_drv.direct_mode = g_partialMode ? 0 : 1;
   disp_drv.rounder_cb = rounder_cb;
+  disp_drv.monitor_cb = monitor_cb;
   disp_drv.user_data = &board;
-  lv_disp_drv_register(&disp_drv);
+#if LVGL_ASYNC_FLUSH
+  g_flushDone = xSemaphoreCreateBinary();
+  if (g_flushDone) {
+    disp_drv.wait_cb = disp_wait;
+  } else {
+    LOG_WARN("LVGL async flush unavailable; flushing synchronously");
+  }
+#endif
+  lv_disp_t *disp = lv_disp_drv_register(&disp_drv);
+  if (disp && disp->refr_timer) {
+    g_refrTimerCb = disp->refr_timer->timer_cb;
+    lv_timer_set_cb(disp->refr_timer, refr_timer_cb);
+  }
 
   lv_indev_drv_init(&indev_drv);
   indev_drv.type = LV_INDEV_TYPE_POINTER;
@@ -102,3 +372,52 @@ void beginLvglHelper(Display &board, bool debug) {
   indev_drv.user_data = &board;
   lv_indev_drv_register(&indev_drv);
 }
+
+bool lvglHelperPartialMode() { return g_partialMode; }
+
+LvglRenderStats lvglHelperGetStats() { return g_stats; }
+
+void lvglHelperResetStats() { g_stats = LvglRenderStats{}; }
+
+void lvglProfileEnable(bool enable) { g_profile = enable; }
+
+bool lvglProfileEnabled() { return g_profile; }
+
+const char *lvglMetricName(LvglMetric metric) {
+  switch (metric) {
+    case LvglMetric::RenderUs: return "render";
+    case LvglMetric::FlushUs: return "flush";
+    case LvglMetric::RenderedPx: return "rendered";
+    case LvglMetric::FlushedPx: return "flushed";
+    case LvglMetric::Areas: return "areas";
+    default: return "?";
+  }
+}
+
+bool lvglProfileGet(LvglMetric metric, LatencyHistogram &out) {
+  if (metric >= LvglMetric::Count) return false;
+  out = g_profileHist[(size_t)metric];
+  return true;
+}
+
+uint32_t lvglProfilePercentile(LvglMetric metric, const LatencyHistogram &h, uint8_t pct) {
+  return latencyHistogramPercentile(h, metricBounds(metric), pct);
+}
+
+void lvglProfileReset() {
+  for (size_t i = 0; i < kLvglMetricCount; ++i) g_profileHist[i] = LatencyHistogram{};
+}
+
+void lvglProfilePrint(Print &out) {
+  out.printf("lvgl profiling %s\n", g_profile ? "on" : "off");
+  out.println("metric        n      p50      p90      p99      max");
+  for (size_t i = 0; i < kLvglMetricCount; ++i) {
+    LvglMetric m = (LvglMetric)i;
+    const LatencyHistogram &h = g_profileHist[i];
+    if (!h.samples) continue;
+    out.printf("%-8s %6lu %8lu %8lu %8lu %8lu\n", lvglMetricName(m), (unsigned long)h.samples,
+               (unsigned long)lvglProfilePercentile(m, h, 50),
+               (unsigned long)lvglProfilePercentile(m, h, 90),
+               (unsigned long)lvglProfilePercentile(m, h, 99), (unsigned long)h.maxValue);
+  }
+}
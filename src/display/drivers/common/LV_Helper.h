@@ -10,6 +10,44 @@
 #include <Arduino.h>
 #include <lvgl.h>
 
+#include "latency_histogram.h"
+
+// Refresh timing, accumulated over refreshes that flushed at least one area.
+struct LvglRenderStats {
+  uint32_t frames = 0;
+  uint32_t areas = 0;
+  uint64_t pixels = 0;
+  uint64_t renderUs = 0;
+  uint64_t flushUs = 0;
+  uint64_t stallUs = 0;  // part of flushUs that LVGL spent waiting for the bus
+  uint64_t trimmedPixels = 0;  // invalidated outside the round panel, not rendered
+  uint64_t skippedPixels = 0;  // flushed areas outside the round panel, not sent
+  uint64_t invalidatedPixels = 0;  // summed invalidated areas, before merging
+  uint32_t lastRenderUs = 0;
+  uint32_t lastFlushUs = 0;
+  uint32_t lastPixels = 0;
+  // Average picture level: light the panel emits as a share of all visible
+  // pixels at full white, 0-1000, after the last refresh and summed per frame.
+  uint16_t lastAplPermille = 0;
+  uint64_t aplPermilleTotal = 0;
+};
+
+// Per-refresh histograms, recorded only while profiling is enabled. Render
+// and flush are in microseconds; rendered pixels come from LVGL's monitor_cb,
+// flushed pixels and areas from disp_flush.
+enum class LvglMetric : uint8_t { RenderUs, FlushUs, RenderedPx, FlushedPx, Areas, Count };
+constexpr size_t kLvglMetricCount = (size_t)LvglMetric::Count;
+
 void beginLvglHelper(Display &board, bool debug = false);
+bool lvglHelperPartialMode();
+LvglRenderStats lvglHelperGetStats();
+void lvglHelperResetStats();
+void lvglProfileEnable(bool enable);
+bool lvglProfileEnabled();
+const char *lvglMetricName(LvglMetric metric);
+bool lvglProfileGet(LvglMetric metric, LatencyHistogram &out);
+uint32_t lvglProfilePercentile(LvglMetric metric, const LatencyHistogram &h, uint8_t pct);
+void lvglProfileReset();
+void lvglProfilePrint(Print &out);
 String lvgl_helper_get_fs_filename(String filename);
 const char *lvgl_helper_get_fs_filename(const char *filename);
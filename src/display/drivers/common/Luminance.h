@@ -0,0 +1,42 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+// Relative light output of RGB565 pixels on an emissive panel, where power
+// follows what is lit rather than what is drawn. Each channel is linearised
+// (gamma 2.2) and weighted by its share of white (Rec. 709), so a white pixel
+// is about 255 and black is 0. Lookups only, cheap enough for the flush path.
+struct LumaTables {
+    uint8_t r[32];
+    uint8_t g[64];
+    uint8_t b[32];
+};
+
+inline void lumaBuildTables(LumaTables &t) {
+    for (int i = 0; i < 32; ++i) {
+        float lin = powf(i / 31.0f, 2.2f);
+        t.r[i] = (uint8_t)lroundf(lin * 0.2126f * 255.0f);
+        t.b[i] = (uint8_t)lroundf(lin * 0.0722f * 255.0f);
+    }
+    for (int i = 0; i < 64; ++i) {
+        t.g[i] = (uint8_t)lroundf(powf(i / 63.0f, 2.2f) * 0.7152f * 255.0f);
+    }
+}
+
+inline uint8_t lumaOf(const LumaTables &t, uint16_t c) {
+    return (uint8_t)(t.r[c >> 11] + t.g[(c >> 5) & 0x3F] + t.b[c & 0x1F]);
+}
+
+// Replaces n entries of a per-pixel luminance map with those of `px` and
+// returns how much the map's sum changed, so a frame total can be kept up to
+// date from partial flushes.
+inline int32_t lumaUpdateRow(const LumaTables &t, const uint16_t *px, uint8_t *map, int16_t n) {
+    int32_t delta = 0;
+    for (int16_t i = 0; i < n; ++i) {
+        uint8_t l = lumaOf(t, px[i]);
+        delta += (int32_t)l - map[i];
+        map[i] = l;
+    }
+    return delta;
+}
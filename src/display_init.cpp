@@ -4,8 +4,10 @@
 #include <algorithm>
 
 #include "app_config.h"
+#include "backoff.h"
 #include "config_hw.h"
 #include "log.h"
+#include "ui_wake.h"
 #include "display/drivers/AmoledDisplay/Amoled_DisplayPanel.h"
 #include "display/drivers/AmoledDisplay/pin_config.h"
 
@@ -23,12 +25,6 @@ static Amoled_DisplayPanel g_panel(kHwConfig);
 static Arduino_GFX *g_gfx = nullptr;
 static DisplayState g_state;
 
-static uint32_t backoffMs(uint8_t attempt, uint32_t base = 350, uint32_t cap = 6000) {
-  uint32_t exp = base << std::min<uint8_t>(attempt, 5);
-  uint32_t j = (exp >> 3) * (esp_random() & 0x7) / 7;  // ~±12.5% jitter
-  return std::min(cap, exp - (exp >> 4) + j);
-}
-
 static void waitMs(uint32_t durationMs) {
   uint32_t start = millis();
   while ((int32_t)(millis() - start) < (int32_t)durationMs) {
@@ -54,15 +50,17 @@ static void updateMetrics() {
 static bool initDisplayFresh() {
   for (uint8_t attempt = 0; attempt < 4; ++attempt) {
     if (g_panel.begin(AMOLED_COLOR_ORDER)) {
-      g_panel.setBrightness(clampBrightness(TOUCH_BRIGHTNESS_MIN));
+      g_panel.setBrightnessNow(clampBrightness(TOUCH_BRIGHTNESS_MIN));
       g_state.brightness = clampBrightness(TOUCH_BRIGHTNESS_MIN);
+      // First battery reading, so the UI has a value before the loop runs.
+      g_panel.sampleBattery(millis());
       g_gfx = g_panel.gfx();
       updateMetrics();
       g_gfx->fillScreen(g_gfx->color565(6, 7, 8));
       g_state.ready = true;
       return true;
     }
-    waitMs(backoffMs(attempt));
+    waitMs(backoffMs(attempt, 350, 6000));
   }
   return false;
 }
@@ -79,6 +77,8 @@ static bool initDisplayFromPanelReady() {
 
 bool displayInit() {
   g_state = DisplayState{};
+  // A touch ends the UI loop's idle wait so the first read is not delayed.
+  g_panel.setTouchIrqCallback(uiWakeFromIsr);
 
 #if defined(ESP32)
   auto rr = esp_reset_reason();
@@ -104,8 +104,9 @@ bool displayInit() {
     if (displayOk) {
       displayOk = initDisplayFromPanelReady();
       if (displayOk) {
-        g_panel.setBrightness(clampBrightness(TOUCH_BRIGHTNESS_MIN));
+        g_panel.setBrightnessNow(clampBrightness(TOUCH_BRIGHTNESS_MIN));
         g_state.brightness = clampBrightness(TOUCH_BRIGHTNESS_MIN);
+        g_panel.sampleBattery(millis());
         LOG_INFO("Display wakeup complete");
         return true;
       }
@@ -126,8 +127,24 @@ Arduino_GFX *displayGfx() { return g_gfx; }
 
 bool displayIsReady() { return g_state.ready; }
 
+DisplayPower displayGetPower() {
+  DisplayPower power;
+  // Filtered value kept up to date by the sampler in displayTick().
+  power.battMv = g_panel.getBattVoltage();
+  power.charging = g_panel.isCharging();
+  power.onBattery = g_panel.hasPowerManagement() && !g_panel.isVbusPresent();
+  return power;
+}
+
 void displaySetBrightness(uint8_t level) {
   uint8_t clamped = clampBrightness(level);
   g_panel.setBrightness(clamped);
   g_state.brightness = clamped;
 }
+
+bool displayTick() {
+  if (!g_state.ready) return false;
+  uint32_t now = millis();
+  g_panel.sampleBattery(now);
+  return g_panel.tickBrightness(now);
+}
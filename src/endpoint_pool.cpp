@@ -0,0 +1,152 @@
+#include "endpoint_pool.h"
+
+#include <Arduino.h>
+
+#include "app_config.h"
+#include "config_features.h"
+
+#ifndef API_BASE_MIRRORS
+#define API_BASE_MIRRORS API_BASE
+#endif
+
+static const char *const kBases[] = {API_BASE_MIRRORS};
+static constexpr size_t kBaseCount =
+    (sizeof(kBases) / sizeof(kBases[0])) < ENDPOINT_MAX ? (sizeof(kBases) / sizeof(kBases[0]))
+                                                        : ENDPOINT_MAX;
+
+static EndpointStats g_endpoints[kBaseCount];
+static bool g_init = false;
+static portMUX_TYPE g_poolMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void ensureInit() {
+  if (g_init) return;
+  for (size_t i = 0; i < kBaseCount; ++i) {
+    g_endpoints[i] = EndpointStats{};
+    g_endpoints[i].base = kBases[i];
+  }
+  g_init = true;
+}
+
+static float scoreOf(const EndpointStats &e) {
+  // Unsampled mirrors rank behind a measured-fast primary but ahead of a slow one.
+  float latency = e.ewmaMs > 0 ? e.ewmaMs : (float)ENDPOINT_DEFAULT_LATENCY_MS;
+  return latency * (1.0f + 4.0f * e.errorRate);
+}
+
+size_t endpointPoolCount() { return kBaseCount; }
+
+const char *endpointPoolBase(size_t idx) {
+  if (idx >= kBaseCount) return kBases[0];
+  return kBases[idx];
+}
+
+size_t endpointPoolRank(size_t *order, size_t maxOrder, uint32_t nowMs) {
+  float scores[kBaseCount];
+  bool cooling[kBaseCount];
+  size_t n = 0;
+
+  portENTER_CRITICAL(&g_poolMux);
+  ensureInit();
+  for (size_t i = 0; i < kBaseCount; ++i) {
+    scores[i] = scoreOf(g_endpoints[i]);
+    cooling[i] = g_endpoints[i].cooldownUntilMs != 0 &&
+                 (int32_t)(g_endpoints[i].cooldownUntilMs - nowMs) > 0;
+  }
+  portEXIT_CRITICAL(&g_poolMux);
+
+  // Healthy endpoints first by score; cooling-down ones are kept as a last resort.
+  for (int pass = 0; pass < 2; ++pass) {
+    bool wantCooling = pass == 1;
+    size_t start = n;
+    for (size_t i = 0; i < kBaseCount && n < maxOrder; ++i) {
+      if (cooling[i] != wantCooling) continue;
+      size_t j = n++;
+      while (j > start && scores[order[j - 1]] > scores[i]) {
+        order[j] = order[j - 1];
+        --j;
+      }
+      order[j] = i;
+    }
+  }
+  return n;
+}
+
+void endpointPoolRecordSuccess(size_t idx, uint32_t latencyMs) {
+  if (idx >= kBaseCount) return;
+  portENTER_CRITICAL(&g_poolMux);
+  ensureInit();
+  EndpointStats &e = g_endpoints[idx];
+  e.ewmaMs = e.ewmaMs > 0 ? e.ewmaMs + ENDPOINT_EWMA_ALPHA * ((float)latencyMs - e.ewmaMs)
+                          : (float)latencyMs;
+  e.errorRate -= ENDPOINT_EWMA_ALPHA * e.errorRate;
+  e.consecutiveFailures = 0;
+  e.cooldownUntilMs = 0;
+  e.recentMs[e.recentNext] = (uint16_t)min<uint32_t>(latencyMs, 0xFFFF);
+  e.recentNext = (e.recentNext + 1) % ENDPOINT_RECENT_SAMPLES;
+  if (e.recentCount < ENDPOINT_RECENT_SAMPLES) ++e.recentCount;
+  ++e.successes;
+  portEXIT_CRITICAL(&g_poolMux);
+}
+
+void endpointPoolRecordFailure(size_t idx, uint32_t nowMs) {
+  if (idx >= kBaseCount) return;
+  portENTER_CRITICAL(&g_poolMux);
+  ensureInit();
+  EndpointStats &e = g_endpoints[idx];
+  e.errorRate += ENDPOINT_EWMA_ALPHA * (1.0f - e.errorRate);
+  if (e.consecutiveFailures < 8) ++e.consecutiveFailures;
+  uint32_t cooldown = ENDPOINT_COOLDOWN_MS << min<uint8_t>(e.consecutiveFailures - 1, 4);
+  e.cooldownUntilMs = nowMs + cooldown;
+  if (e.cooldownUntilMs == 0) e.cooldownUntilMs = 1;
+  ++e.failures;
+  portEXIT_CRITICAL(&g_poolMux);
+}
+
+void endpointPoolRecordHedge(size_t idx, bool won) {
+  if (idx >= kBaseCount) return;
+  portENTER_CRITICAL(&g_poolMux);
+  ensureInit();
+  ++g_endpoints[idx].hedgesFired;
+  if (won) ++g_endpoints[idx].hedgeWins;
+  portEXIT_CRITICAL(&g_poolMux);
+}
+
+uint32_t endpointPoolHedgeDelayMs(size_t idx) {
+  if (idx >= kBaseCount) return ENDPOINT_HEDGE_DEFAULT_MS;
+  uint16_t samples[ENDPOINT_RECENT_SAMPLES];
+  uint8_t n = 0;
+  portENTER_CRITICAL(&g_poolMux);
+  ensureInit();
+  n = g_endpoints[idx].recentCount;
+  memcpy(samples, g_endpoints[idx].recentMs, sizeof(samples));
+  portEXIT_CRITICAL(&g_poolMux);
+
+  if (n < ENDPOINT_HEDGE_MIN_SAMPLES) return ENDPOINT_HEDGE_DEFAULT_MS;
+  for (uint8_t i = 1; i < n; ++i) {
+    uint16_t v = samples[i];
+    uint8_t j = i;
+    while (j > 0 && samples[j - 1] > v) {
+      samples[j] = samples[j - 1];
+      --j;
+    }
+    samples[j] = v;
+  }
+  uint8_t p90 = (uint8_t)((n * 9 + 9) / 10) - 1;
+  return max<uint32_t>(samples[p90], ENDPOINT_HEDGE_MIN_MS);
+}
+
+bool endpointPoolGetStats(size_t idx, EndpointStats &out) {
+  if (idx >= kBaseCount) return false;
+  portENTER_CRITICAL(&g_poolMux);
+  ensureInit();
+  out = g_endpoints[idx];
+  portEXIT_CRITICAL(&g_poolMux);
+  return true;
+}
+
+void endpointPoolReset() {
+  portENTER_CRITICAL(&g_poolMux);
+  g_init = false;
+  ensureInit();
+  portEXIT_CRITICAL(&g_poolMux);
+}
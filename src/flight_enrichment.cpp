@@ -2,13 +2,14 @@
 
 #include <Arduino.h>
 #include <HTTPClient.h>
-#include <WiFiClientSecure.h>
 #include <ArduinoJson.h>
 
 #include "aircraft_types.h"
 #include "app_config.h"
 #include "config_features.h"
+#include "http_transport.h"
 #include "log.h"
+#include "net_timing.h"
 
 struct MilCacheEntry {
   String hex;
@@ -37,6 +38,9 @@ struct HexDbCacheEntry {
 #ifndef HEXDB_MIN_HEAP
 #define HEXDB_MIN_HEAP 50000
 #endif
+#ifndef HEXDB_BASE
+#define HEXDB_BASE "https://hexdb.io"
+#endif
 static HexDbCacheEntry g_hexdbCache[HEXDB_CACHE_SIZE];
 static uint32_t g_hexdbLastFetchMs = 0;
 
@@ -46,13 +50,34 @@ struct RouteCacheEntry {
   uint32_t ts = 0;
 };
 static RouteCacheEntry g_routeCache;
-static const size_t kMilLookupMax = 48;
+
+#ifndef RTC_HEXDB_HOT
+#define RTC_HEXDB_HOT 4
+#endif
+static const uint32_t kMilCacheTtlMs = 6UL * 60UL * 60UL * 1000UL;
+
+// Fixed-size copies for RTC memory; ages are relative to the save.
+struct RtcMilEntry {
+  char hex[8];
+  uint32_t ageMs;
+  bool isMil;
+};
+struct RtcHexDbEntry {
+  char hex[8];
+  char name[32];
+  char icaoType[8];
+  char owner[24];
+  uint32_t ageMs;
+};
+RTC_DATA_ATTR static RtcMilEntry g_rtcMil[kMilCacheSize];
+RTC_DATA_ATTR static RtcHexDbEntry g_rtcHexDb[RTC_HEXDB_HOT];
+static bool g_hotDirty = false;
 
 bool flightEnrichmentIsMilitaryCached(const String &hex, bool &outIsMil) {
   uint32_t now = millis();
   for (size_t i = 0; i < kMilCacheSize; ++i) {
     if (g_milCache[i].hex == hex) {
-      if (now - g_milCache[i].ts < 6UL * 60UL * 60UL * 1000UL) {
+      if (now - g_milCache[i].ts < kMilCacheTtlMs) {
         outIsMil = g_milCache[i].isMil;
         return true;
       }
@@ -78,6 +103,7 @@ void flightEnrichmentStoreMilitary(const String &hex, bool isMil) {
   g_milCache[slot].hex = hex;
   g_milCache[slot].ts = millis();
   g_milCache[slot].isMil = isMil;
+  g_hotDirty = true;
 }
 
 bool flightEnrichmentFetchIsMilitary(const String &hex, bool &outIsMil) {
@@ -88,20 +114,25 @@ bool flightEnrichmentFetchIsMilitary(const String &hex, bool &outIsMil) {
   if (!url.startsWith("http")) url = String("https://") + url;
   url += "/v2/mil";
 
-  WiFiClientSecure client;
-  client.setInsecure();
-  client.setTimeout(10);
+  NetPhaseTimer timer(NetEndpoint::MilList);
+  HttpLease lease;
+  if (!httpTransportAcquire(url, lease, 8000)) return false;
+  timer.connected(lease);
+  lease.client().setTimeout(10);
   HTTPClient http;
   http.setConnectTimeout(8000);
   http.setTimeout(10000);
-  if (!http.begin(client, url)) return false;
+  if (!http.begin(lease.client(), url)) return false;
+  uint32_t sentMs = millis();
   int code = http.GET();
+  if (code > 0) lease.recordTtfb(millis() - sentMs);
+  timer.mark(NetPhase::Ttfb);
   if (code != HTTP_CODE_OK) {
     http.end();
     return false;
   }
 
-  Stream &stream = http.getStream();
+  TimedStream stream(http.getStream());
   String hexLower = hex;
   hexLower.toLowerCase();
   String hexUpper = hex;
@@ -140,9 +171,11 @@ bool flightEnrichmentFetchIsMilitary(const String &hex, bool &outIsMil) {
     else tail = chunk;
     yield();
   }
+  timer.markStream(stream);
   LOG_INFO("Mil list entries: %lu", (unsigned long)hexCount);
   http.end();
   outIsMil = found;
+  timer.ok();
   return true;
 }
 
@@ -156,116 +189,37 @@ bool flightEnrichmentFetchMilList(const String *hexes, size_t count, bool *outIs
   if (!url.startsWith("http")) url = String("https://") + url;
   url += "/v2/mil";
 
-  WiFiClientSecure client;
-  client.setInsecure();
-  client.setTimeout(10);
+  NetPhaseTimer timer(NetEndpoint::MilList);
+  HttpLease lease;
+  if (!httpTransportAcquire(url, lease, 8000)) return false;
+  timer.connected(lease);
+  lease.client().setTimeout(10);
   HTTPClient http;
   http.setConnectTimeout(8000);
   http.setTimeout(10000);
-  if (!http.begin(client, url)) return false;
+  if (!http.begin(lease.client(), url)) return false;
+  uint32_t sentMs = millis();
   int code = http.GET();
+  if (code > 0) lease.recordTtfb(millis() - sentMs);
+  timer.mark(NetPhase::Ttfb);
   if (code != HTTP_CODE_OK) {
     http.end();
     return false;
   }
 
-  Stream &stream = http.getStream();
-  auto hexNibble = [](char c) -> int8_t {
-    if (c >= '0' && c <= '9') return c - '0';
-    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
-    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
-    return -1;
-  };
-  auto parseHexString = [&](const String &s, uint32_t &out) -> bool {
-    uint32_t val = 0;
-    uint8_t digits = 0;
-    const char *p = s.c_str();
-    for (; *p; ++p) {
-      int8_t nib = hexNibble(*p);
-      if (nib < 0) continue;
-      if (digits >= 6) break;
-      val = (val << 4) | (uint32_t)nib;
-      ++digits;
-    }
-    if (digits == 0) return false;
-    out = val;
-    return true;
-  };
-
-  uint32_t candVals[kMilLookupMax];
-  for (size_t i = 0; i < count; ++i) {
-    candVals[i] = 0;
-    parseHexString(hexes[i], candVals[i]);
-  }
-
-  enum class ParseState : uint8_t { Search, InHex };
-  static const char *kNeedle = "\"hex\":\"";
-  static const uint8_t kNeedleLen = 7;
-  ParseState state = ParseState::Search;
-  uint8_t match = 0;
-  uint32_t curHex = 0;
-  uint8_t curDigits = 0;
-  uint32_t hexCount = 0;
-  size_t found = 0;
-  bool done = false;
-
-  auto consumeHex = [&]() {
-    if (curDigits == 0) return;
-    ++hexCount;
-    for (size_t i = 0; i < count; ++i) {
-      if (!outIsMil[i] && candVals[i] == curHex) {
-        outIsMil[i] = true;
-        ++found;
-      }
-    }
-    curHex = 0;
-    curDigits = 0;
-  };
-
+  TimedStream stream(http.getStream());
+  MilListMatcher matcher(hexes, count, outIsMil);
   char buf[160];
-  while (!done && (http.connected() || stream.available())) {
+  while (!matcher.done() && (http.connected() || stream.available())) {
     int n = stream.readBytes(buf, sizeof(buf));
     if (n <= 0) break;
-    for (int i = 0; i < n; ++i) {
-      char c = buf[i];
-      if (state == ParseState::Search) {
-        if (c == kNeedle[match]) {
-          ++match;
-          if (match == kNeedleLen) {
-            state = ParseState::InHex;
-            match = 0;
-            curHex = 0;
-            curDigits = 0;
-          }
-        } else {
-          match = (c == kNeedle[0]) ? 1 : 0;
-        }
-      } else {
-        if (c == '"') {
-          consumeHex();
-          state = ParseState::Search;
-        } else {
-          int8_t nib = hexNibble(c);
-          if (nib >= 0) {
-            if (curDigits < 6) {
-              curHex = (curHex << 4) | (uint32_t)nib;
-              ++curDigits;
-            }
-          } else {
-            curHex = 0;
-            curDigits = 0;
-            state = ParseState::Search;
-          }
-        }
-      }
-    }
-    if (found >= count) {
-      done = true;
-    }
+    matcher.feed(buf, (size_t)n);
     yield();
   }
-  LOG_INFO("Mil list entries: %lu", (unsigned long)hexCount);
+  timer.markStream(stream);
+  LOG_INFO("Mil list entries: %lu", (unsigned long)matcher.entries());
   http.end();
+  timer.ok();
 
   for (size_t i = 0; i < count; ++i) {
     flightEnrichmentStoreMilitary(hexes[i], outIsMil[i]);
@@ -309,6 +263,79 @@ static void hexDbCacheStore(const String &hex, const String &name, const String
   g_hexdbCache[slot].icaoType = type;
   g_hexdbCache[slot].owner = owner;
   g_hexdbCache[slot].ts = millis();
+  g_hotDirty = true;
+}
+
+static void copyField(char *dst, size_t cap, const String &src) {
+  strncpy(dst, src.c_str(), cap - 1);
+  dst[cap - 1] = '\0';
+}
+
+void flightEnrichmentSaveHot() {
+  if (!g_hotDirty) return;
+  g_hotDirty = false;
+  uint32_t now = millis();
+  for (size_t i = 0; i < kMilCacheSize; ++i) {
+    RtcMilEntry &r = g_rtcMil[i];
+    const MilCacheEntry &e = g_milCache[i];
+    if (!e.hex.length() || e.hex.length() >= sizeof(r.hex)) {
+      r.hex[0] = '\0';
+      continue;
+    }
+    copyField(r.hex, sizeof(r.hex), e.hex);
+    r.ageMs = now - e.ts;
+    r.isMil = e.isMil;
+  }
+
+  // Keep the most recently stored HexDB entries.
+  bool taken[HEXDB_CACHE_SIZE] = {};
+  for (size_t k = 0; k < RTC_HEXDB_HOT; ++k) {
+    int best = -1;
+    for (size_t i = 0; i < HEXDB_CACHE_SIZE; ++i) {
+      const HexDbCacheEntry &e = g_hexdbCache[i];
+      if (taken[i] || !e.hex.length() || e.hex.length() >= sizeof(g_rtcHexDb[k].hex)) continue;
+      if (best < 0 || now - e.ts < now - g_hexdbCache[best].ts) best = (int)i;
+    }
+    RtcHexDbEntry &r = g_rtcHexDb[k];
+    if (best < 0) {
+      r.hex[0] = '\0';
+      continue;
+    }
+    taken[best] = true;
+    const HexDbCacheEntry &e = g_hexdbCache[best];
+    copyField(r.hex, sizeof(r.hex), e.hex);
+    copyField(r.name, sizeof(r.name), e.name);
+    copyField(r.icaoType, sizeof(r.icaoType), e.icaoType);
+    copyField(r.owner, sizeof(r.owner), e.owner);
+    r.ageMs = now - e.ts;
+  }
+}
+
+void flightEnrichmentRestoreHot(uint32_t sleptMs) {
+  uint32_t now = millis();
+  size_t mil = 0;
+  size_t hexdb = 0;
+  for (size_t i = 0; i < kMilCacheSize; ++i) {
+    const RtcMilEntry &r = g_rtcMil[i];
+    if (!r.hex[0] || (uint64_t)r.ageMs + sleptMs >= kMilCacheTtlMs) continue;
+    g_milCache[mil].hex = r.hex;
+    g_milCache[mil].isMil = r.isMil;
+    g_milCache[mil].ts = now - (r.ageMs + sleptMs);
+    mil++;
+  }
+  for (size_t i = 0; i < RTC_HEXDB_HOT && hexdb < HEXDB_CACHE_SIZE; ++i) {
+    const RtcHexDbEntry &r = g_rtcHexDb[i];
+    if (!r.hex[0] || (uint64_t)r.ageMs + sleptMs >= HEXDB_CACHE_TTL_MS) continue;
+    g_hexdbCache[hexdb].hex = r.hex;
+    g_hexdbCache[hexdb].name = r.name;
+    g_hexdbCache[hexdb].icaoType = r.icaoType;
+    g_hexdbCache[hexdb].owner = r.owner;
+    g_hexdbCache[hexdb].ts = now - (r.ageMs + sleptMs);
+    hexdb++;
+  }
+  if (mil || hexdb) {
+    LOG_INFO("Restored %u MIL and %u HexDB cache entries from RTC", (unsigned)mil, (unsigned)hexdb);
+  }
 }
 
 bool flightEnrichmentLookupHexDb(const String &hex, String &outName, String &outType,
@@ -333,25 +360,33 @@ bool flightEnrichmentLookupHexDb(const String &hex, String &outName, String &out
 
   g_hexdbLastFetchMs = now;
 
-  String url = String("https://hexdb.io/api/v1/aircraft/") + hex;
+  String url = String(HEXDB_BASE) + "/api/v1/aircraft/" + hex;
 
-  WiFiClientSecure client;
-  client.setInsecure();
-  client.setTimeout(10);
+  NetPhaseTimer timer(NetEndpoint::HexDb);
+  HttpLease lease;
+  if (!httpTransportAcquire(url, lease, 8000)) return false;
+  timer.connected(lease);
+  lease.client().setTimeout(10);
   HTTPClient http;
   http.setConnectTimeout(8000);
   http.setTimeout(10000);
-  if (!http.begin(client, url)) return false;
+  if (!http.begin(lease.client(), url)) return false;
+  uint32_t sentMs = millis();
   int code = http.GET();
+  if (code > 0) lease.recordTtfb(millis() - sentMs);
+  timer.mark(NetPhase::Ttfb);
   if (code != HTTP_CODE_OK) {
     http.end();
     return false;
   }
 
   JsonDocument doc;
-  DeserializationError err = deserializeJson(doc, http.getStream());
+  TimedStream body(http.getStream());
+  DeserializationError err = deserializeJson(doc, body);
+  timer.markStream(body);
   http.end();
   if (err) return false;
+  timer.ok();
 
   String manufacturer = doc["Manufacturer"] | "";
   String type = doc["Type"] | "";
@@ -402,18 +437,23 @@ bool flightEnrichmentLookupRoute(const String &callsign, double lat, double lon,
   if (!isnan(lat)) p0["lat"] = lat;
   if (!isnan(lon)) p0["lng"] = lon;
 
-  WiFiClientSecure client;
-  client.setInsecure();
-  client.setTimeout(10);
+  NetPhaseTimer timer(NetEndpoint::Route);
+  HttpLease lease;
+  if (!httpTransportAcquire(url, lease, 8000)) return false;
+  timer.connected(lease);
+  lease.client().setTimeout(10);
   HTTPClient http;
   http.setConnectTimeout(8000);
   http.setTimeout(10000);
-  if (!http.begin(client, url)) return false;
+  if (!http.begin(lease.client(), url)) return false;
   http.addHeader("Content-Type", "application/json");
   String body;
   serializeJson(req, body);
   LOG_INFO("Route lookup POST %s callsign=%s", url.c_str(), callsign.c_str());
+  uint32_t sentMs = millis();
   int code = http.POST(body);
+  if (code > 0) lease.recordTtfb(millis() - sentMs);
+  timer.mark(NetPhase::Ttfb);
   LOG_INFO("Route lookup status: %d", code);
   if (code != HTTP_CODE_OK) {
     http.end();
@@ -421,11 +461,15 @@ bool flightEnrichmentLookupRoute(const String &callsign, double lat, double lon,
   }
 
   String resp = http.getString();
+  timer.mark(NetPhase::Body);
+  timer.addBytes(resp.length());
   http.end();
 
   JsonDocument doc;
   DeserializationError err = deserializeJson(doc, resp);
+  timer.mark(NetPhase::Parse);
   if (err) return false;
+  timer.ok();
   LOG_DEBUG("Route lookup JSON ok");
 
   String route;
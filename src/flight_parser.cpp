@@ -21,6 +21,21 @@ static double haversineKm(double lat1, double lon1, double lat2, double lon2) {
   return R * c;
 }
 
+double flightParserHomeDistanceKm(double lat, double lon) {
+  return haversineKm(HOME_LAT, HOME_LON, lat, lon);
+}
+
+// Initial great-circle bearing from HOME, 0..360 degrees clockwise from north.
+double flightParserHomeBearingDeg(double lat, double lon) {
+  double lat1 = deg2rad(HOME_LAT);
+  double lat2 = deg2rad(lat);
+  double dLon = deg2rad(lon - HOME_LON);
+  double y = sin(dLon) * cos(lat2);
+  double x = cos(lat1) * sin(lat2) - sin(lat1) * cos(lat2) * cos(dLon);
+  double deg = atan2(y, x) * 180.0 / PI;
+  return deg < 0 ? deg + 360.0 : deg;
+}
+
 bool flightParserExtractLatLon(JsonObject obj, double &outLat, double &outLon) {
   if (obj["seen_pos"].is<double>()) {
     double seenPos = obj["seen_pos"].as<double>();
@@ -73,7 +88,8 @@ bool flightParserParseAircraft(JsonObject obj, FlightInfo &res) {
   res.altitudeFt = alt;
   res.lat = lat;
   res.lon = lon;
-  res.distanceKm = haversineKm(HOME_LAT, HOME_LON, lat, lon);
+  res.distanceKm = flightParserHomeDistanceKm(lat, lon);
+  res.trackDeg = obj["track"].is<float>() ? obj["track"].as<float>() : NAN;
   res.hex = obj["hex"].is<const char *>() ? String(obj["hex"].as<const char *>()) : String("");
   res.hasCallsign = hasCallsign;
   res.route = String("");
@@ -0,0 +1,132 @@
+#include "MemoryDisplay.h"
+
+#include <string.h>
+
+namespace {
+
+uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t len) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= data[i];
+        for (int k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    return ~crc;
+}
+
+void putBe32(std::vector<uint8_t> &out, uint32_t v) {
+    out.push_back((uint8_t)(v >> 24));
+    out.push_back((uint8_t)(v >> 16));
+    out.push_back((uint8_t)(v >> 8));
+    out.push_back((uint8_t)v);
+}
+
+void putChunk(std::vector<uint8_t> &out, const char *type, const std::vector<uint8_t> &data) {
+    putBe32(out, (uint32_t)data.size());
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    putBe32(out, crc32Update(0, out.data() + start, out.size() - start));
+}
+
+}  // namespace
+
+MemoryDisplay::MemoryDisplay(uint16_t width, uint16_t height, bool round)
+    : _width(width), _height(height), _round(round), _fb((size_t)width * height, 0) {}
+
+void MemoryDisplay::pushColors(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *data) {
+    if (x >= _width || y >= _height) return;
+    uint16_t w = x + width > _width ? _width - x : width;
+    uint16_t h = y + height > _height ? _height - y : height;
+    for (uint16_t row = 0; row < h; ++row) {
+        memcpy(&_fb[(size_t)(y + row) * _width + x], data + (size_t)row * width, w * sizeof(uint16_t));
+    }
+
+    _damage.pixels += (uint32_t)w * h;
+    if (!_damage.areas++) {
+        _damage.x1 = x;
+        _damage.y1 = y;
+        _damage.x2 = x + w - 1;
+        _damage.y2 = y + h - 1;
+        return;
+    }
+    if (x < _damage.x1) _damage.x1 = x;
+    if (y < _damage.y1) _damage.y1 = y;
+    if (x + w - 1 > _damage.x2) _damage.x2 = x + w - 1;
+    if (y + h - 1 > _damage.y2) _damage.y2 = y + h - 1;
+}
+
+uint8_t MemoryDisplay::getPoint(int16_t *x, int16_t *y, uint8_t get_point) {
+    (void)get_point;
+    if (!_touched) return 0;
+    *x = _touchX;
+    *y = _touchY;
+    return 1;
+}
+
+void MemoryDisplay::setTouch(int16_t x, int16_t y, bool pressed) {
+    _touchX = x;
+    _touchY = y;
+    _touched = pressed;
+}
+
+MemoryDisplay::Damage MemoryDisplay::takeDamage() {
+    Damage d = _damage;
+    _damage = Damage{};
+    return d;
+}
+
+uint32_t MemoryDisplay::frameCrc() const {
+    return crc32Update(0, reinterpret_cast<const uint8_t *>(_fb.data()), _fb.size() * sizeof(uint16_t));
+}
+
+void MemoryDisplay::encodePng(std::vector<uint8_t> &out) const {
+    static const uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.assign(kSignature, kSignature + sizeof(kSignature));
+
+    std::vector<uint8_t> ihdr;
+    putBe32(ihdr, _width);
+    putBe32(ihdr, _height);
+    const uint8_t ihdrTail[5] = {8, 2, 0, 0, 0};  // 8-bit RGB, no interlace
+    ihdr.insert(ihdr.end(), ihdrTail, ihdrTail + sizeof(ihdrTail));
+    putChunk(out, "IHDR", ihdr);
+
+    // Raw scanlines: filter byte 0, then RGB888 expanded from RGB565.
+    std::vector<uint8_t> raw;
+    raw.reserve((size_t)_height * (1 + _width * 3));
+    for (uint16_t row = 0; row < _height; ++row) {
+        raw.push_back(0);
+        const uint16_t *src = &_fb[(size_t)row * _width];
+        for (uint16_t col = 0; col < _width; ++col) {
+            uint16_t c = src[col];
+            uint8_t r = (c >> 11) & 0x1F;
+            uint8_t g = (c >> 5) & 0x3F;
+            uint8_t b = c & 0x1F;
+            raw.push_back((uint8_t)((r << 3) | (r >> 2)));
+            raw.push_back((uint8_t)((g << 2) | (g >> 4)));
+            raw.push_back((uint8_t)((b << 3) | (b >> 2)));
+        }
+    }
+
+    std::vector<uint8_t> z;
+    z.push_back(0x78);
+    z.push_back(0x01);
+    uint32_t a = 1;
+    uint32_t b = 0;
+    for (uint8_t v : raw) {
+        a = (a + v) % 65521;
+        b = (b + a) % 65521;
+    }
+    for (size_t off = 0; off < raw.size() || off == 0; off += 65535) {
+        size_t len = raw.size() - off < 65535 ? raw.size() - off : 65535;
+        z.push_back(off + len >= raw.size() ? 1 : 0);
+        z.push_back((uint8_t)len);
+        z.push_back((uint8_t)(len >> 8));
+        z.push_back((uint8_t)~len);
+        z.push_back((uint8_t)(~len >> 8));
+        z.insert(z.end(), raw.begin() + off, raw.begin() + off + len);
+        if (raw.empty()) break;
+    }
+    putBe32(z, (b << 16) | a);
+    putChunk(out, "IDAT", z);
+    putChunk(out, "IEND", std::vector<uint8_t>());
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "display/drivers/common/Display.h"
+
+// Display backed by an in-memory RGB565 frame buffer instead of a panel. It
+// lets LV_Helper and the UI run without hardware: pushes are copied into the
+// buffer and accounted as damage, touches are injected, and the frame can be
+// exported as a PNG for golden-image comparisons.
+class MemoryDisplay : public Display {
+  public:
+    struct Damage {
+        uint32_t pixels = 0;
+        uint32_t areas = 0;
+        int16_t x1 = 0;
+        int16_t y1 = 0;
+        int16_t x2 = -1;
+        int16_t y2 = -1;
+    };
+
+    MemoryDisplay(uint16_t width, uint16_t height, bool round = true);
+
+    void pushColors(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *data) override;
+    uint16_t width() override { return _width; }
+    uint16_t height() override { return _height; }
+    uint8_t getPoint(int16_t *x, int16_t *y, uint8_t get_point) override;
+    bool supportsDirectMode() override { return true; }
+    bool isRound() override { return _round; }
+
+    void setTouch(int16_t x, int16_t y, bool pressed);
+    const uint16_t *pixels() const { return _fb.data(); }
+    // Pixels, areas and bounding box pushed since the previous call.
+    Damage takeDamage();
+    // CRC-32 of the frame buffer, for comparing frames without an image.
+    uint32_t frameCrc() const;
+    // Encodes the frame buffer as a 24-bit PNG using stored (uncompressed)
+    // deflate blocks, so no zlib is needed.
+    void encodePng(std::vector<uint8_t> &out) const;
+
+  private:
+    uint16_t _width;
+    uint16_t _height;
+    bool _round;
+    std::vector<uint16_t> _fb;
+    Damage _damage;
+    int16_t _touchX = 0;
+    int16_t _touchY = 0;
+    bool _touched = false;
+};
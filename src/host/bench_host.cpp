@@ -0,0 +1,224 @@
+// Host microbenchmarks (Google Benchmark) for code on the flush and poll
+// paths that does not need the panel or the network. Built by the
+// bench_host environment only; see "Microbenchmarks" in the README for the
+// capture and compare commands. List cases carry the same names as the
+// on-device `bench` command, so the two reports line up.
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <benchmark/benchmark.h>
+
+#include <stdint.h>
+#include <vector>
+
+#include "CircleClip.h"
+#include "Luminance.h"
+#include "aircraft_types.h"
+#include "bench_payloads.h"
+#include "flight_enrichment.h"
+#include "flight_parser.h"
+#include "network_client.h"
+#include "radar_targets.h"
+
+namespace {
+
+constexpr int16_t kPanelSize = 466;
+constexpr size_t kSampleFlights = 64;
+
+// Two full RGB565 frames from a fixed seed, so consecutive flushes change
+// every luminance entry the way a page switch does.
+struct LumaFrames {
+  LumaTables tables;
+  std::vector<uint16_t> frames[2];
+  std::vector<uint8_t> map;
+
+  LumaFrames() : map((size_t)kPanelSize * kPanelSize, 0) {
+    lumaBuildTables(tables);
+    uint32_t s = 0x9E3779B9;
+    for (auto &frame : frames) {
+      frame.resize((size_t)kPanelSize * kPanelSize);
+      for (uint16_t &px : frame) {
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        px = (uint16_t)s;
+      }
+    }
+  }
+};
+
+// A direct-mode flush of the whole panel as LV_Helper accounts it on a
+// round panel: only the circle's band spans, two rows per band.
+void BM_LumaFrameCircle(benchmark::State &state) {
+  LumaFrames f;
+  size_t next = 0;
+  int64_t pixels = 0;
+  for (auto _ : state) {
+    const uint16_t *data = f.frames[next].data();
+    next ^= 1;
+    int32_t delta = 0;
+    for (int16_t row = 0; row < kPanelSize; row += 2) {
+      int16_t a, b;
+      if (!circleBandSpan(row, kPanelSize, a, b)) continue;
+      for (int16_t r = row; r < row + 2; ++r) {
+        uint32_t off = (uint32_t)r * kPanelSize + a;
+        delta += lumaUpdateRow(f.tables, data + off, f.map.data() + off, b - a);
+        pixels += b - a;
+      }
+    }
+    benchmark::DoNotOptimize(delta);
+  }
+  state.SetItemsProcessed(pixels);
+}
+
+// The same flush without the circle spans, as on a rectangular panel.
+void BM_LumaFrameFull(benchmark::State &state) {
+  LumaFrames f;
+  size_t next = 0;
+  for (auto _ : state) {
+    const uint16_t *data = f.frames[next].data();
+    next ^= 1;
+    int32_t delta = 0;
+    for (int16_t r = 0; r < kPanelSize; ++r) {
+      uint32_t off = (uint32_t)r * kPanelSize;
+      delta += lumaUpdateRow(f.tables, data + off, f.map.data() + off, kPanelSize);
+    }
+    benchmark::DoNotOptimize(delta);
+  }
+  state.SetItemsProcessed(state.iterations() * kPanelSize * kPanelSize);
+}
+
+// One generated aircraft list, shared by the cases of its size.
+struct ListInput {
+  size_t n = 0;
+  String payload;
+  String hexes[kMilLookupMax];
+  size_t hexCount = 0;
+  String mil;
+};
+
+// Every generated aircraft has a position, so the scan takes the first
+// kMilLookupMax of them as MIL candidates in list order, as on the device.
+bool makeListInput(size_t n, ListInput &in) {
+  in.n = n;
+  if (!benchMakeAircraftList(n, in.payload)) return false;
+  in.hexCount = n < kMilLookupMax ? n : kMilLookupMax;
+  for (size_t i = 0; i < in.hexCount; ++i) {
+    char hex[12];
+    snprintf(hex, sizeof(hex), "%06lx", (unsigned long)benchHex(i));
+    in.hexes[i] = hex;
+  }
+  return benchMakeMilList(n, in.hexes, in.hexCount, in.mil);
+}
+
+void benchJson(benchmark::State &state, const ListInput *in) {
+  for (auto _ : state) {
+    JsonDocument doc;
+    benchmark::DoNotOptimize(deserializeJson(doc, in->payload.c_str(), in->payload.length()));
+  }
+  state.SetItemsProcessed(state.iterations() * in->n);
+}
+
+void benchParse(benchmark::State &state, const ListInput *in) {
+  JsonDocument doc;
+  deserializeJson(doc, in->payload.c_str(), in->payload.length());
+  JsonArray ac = doc["ac"].as<JsonArray>();
+  for (auto _ : state) {
+    FlightInfo fi;
+    for (JsonVariant v : ac) {
+      benchmark::DoNotOptimize(flightParserParseAircraft(v.as<JsonObject>(), fi));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * in->n);
+}
+
+void benchScan(benchmark::State &state, const ListInput *in) {
+  JsonDocument doc;
+  deserializeJson(doc, in->payload.c_str(), in->payload.length());
+  JsonArray ac = doc["ac"].as<JsonArray>();
+  std::vector<MilCandidate> cands(kMilLookupMax);
+  for (auto _ : state) {
+    RadarSnapshot radar;
+    AircraftScan scan;
+    scan.cands = cands.data();
+    scan.candCap = kMilLookupMax;
+    networkClientScanAircraft(ac, scan, &radar);
+    benchmark::DoNotOptimize(scan.candCount);
+  }
+  state.SetItemsProcessed(state.iterations() * in->n);
+}
+
+void benchMilMatch(benchmark::State &state, const ListInput *in) {
+  bool isMil[kMilLookupMax];
+  for (auto _ : state) {
+    memset(isMil, 0, sizeof(isMil));
+    MilListMatcher matcher(in->hexes, in->hexCount, isMil);
+    const char *p = in->mil.c_str();
+    size_t left = in->mil.length();
+    // Same chunk size as the HTTP read loop.
+    while (left && !matcher.done()) {
+      size_t chunk = left < 160 ? left : 160;
+      matcher.feed(p, chunk);
+      p += chunk;
+      left -= chunk;
+    }
+    benchmark::DoNotOptimize(isMil);
+  }
+  state.SetItemsProcessed(state.iterations() * in->n);
+}
+
+// Type codes of the sample flights, cycling through the generator's types.
+std::vector<String> sampleTypes() {
+  std::vector<String> types;
+  for (size_t i = 0; i < kSampleFlights; ++i) types.push_back(kBenchTypes[i % kBenchTypeCount]);
+  return types;
+}
+
+void BM_TypeName(benchmark::State &state) {
+  std::vector<String> types = sampleTypes();
+  for (auto _ : state) {
+    for (const String &t : types) benchmark::DoNotOptimize(aircraftFriendlyName(t));
+  }
+  state.SetItemsProcessed(state.iterations() * types.size());
+}
+
+void BM_SeatMax(benchmark::State &state) {
+  std::vector<String> types = sampleTypes();
+  for (auto _ : state) {
+    uint16_t seats = 0;
+    for (const String &t : types) benchmark::DoNotOptimize(aircraftSeatMax(t, seats));
+  }
+  state.SetItemsProcessed(state.iterations() * types.size());
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+  benchmark::RegisterBenchmark("luma/frame_circle", BM_LumaFrameCircle);
+  benchmark::RegisterBenchmark("luma/frame_full", BM_LumaFrameFull);
+
+  static ListInput inputs[sizeof(kBenchSizes) / sizeof(kBenchSizes[0])];
+  char name[32];
+  for (size_t i = 0; i < sizeof(kBenchSizes) / sizeof(kBenchSizes[0]); ++i) {
+    ListInput *in = &inputs[i];
+    if (!makeListInput(kBenchSizes[i], *in)) return 1;
+    snprintf(name, sizeof(name), "json/%u", (unsigned)in->n);
+    benchmark::RegisterBenchmark(name, benchJson, in);
+    snprintf(name, sizeof(name), "parse/%u", (unsigned)in->n);
+    benchmark::RegisterBenchmark(name, benchParse, in);
+    snprintf(name, sizeof(name), "scan/%u", (unsigned)in->n);
+    benchmark::RegisterBenchmark(name, benchScan, in);
+    snprintf(name, sizeof(name), "milmatch/%u", (unsigned)in->n);
+    benchmark::RegisterBenchmark(name, benchMilMatch, in);
+  }
+
+  benchmark::RegisterBenchmark("typename", BM_TypeName);
+  benchmark::RegisterBenchmark("seatmax", BM_SeatMax);
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
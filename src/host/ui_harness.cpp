@@ -0,0 +1,163 @@
+// Headless UI harness: runs ui.cpp and LVGL against MemoryDisplay on the
+// host, replays recorded flights through uiRenderFlight and reports what each
+// refresh cost. Built by the ui_host environment only.
+//
+//   ui_harness [flights.jsonl] [png-dir]
+//
+// Each input line is one FlightInfo as JSON, using the struct's field names;
+// "battMv", "charging" and "onBattery" update the battery label and theme
+// first. One CSV row is printed per frame; with png-dir every frame is also
+// written as frame_NNN.png.
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <lvgl.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "app_types.h"
+#include "display/drivers/common/LV_Helper.h"
+#include "display_init.h"
+#include "host/MemoryDisplay.h"
+#include "ui.h"
+
+static constexpr uint16_t kPanelSize = 466;
+static DisplayPower g_power;
+
+// The slice of display_init that ui.cpp uses.
+bool displayIsReady() { return true; }
+
+DisplayPower displayGetPower() { return g_power; }
+
+static void readString(JsonVariantConst v, String &out) {
+  if (v.is<const char *>()) out = v.as<const char *>();
+}
+
+static bool parseFlight(const std::string &line, FlightInfo &fi, bool &hasPower) {
+  JsonDocument doc;
+  if (deserializeJson(doc, line.c_str())) return false;
+  JsonObjectConst o = doc.as<JsonObjectConst>();
+  if (o.isNull()) return false;
+
+  fi = FlightInfo{};
+  readString(o["ident"], fi.ident);
+  readString(o["typeCode"], fi.typeCode);
+  readString(o["category"], fi.category);
+  readString(o["displayName"], fi.displayName);
+  readString(o["registeredOwner"], fi.registeredOwner);
+  readString(o["hex"], fi.hex);
+  readString(o["opClass"], fi.opClass);
+  readString(o["route"], fi.route);
+  fi.altitudeFt = o["altitudeFt"] | -1L;
+  fi.lat = o["lat"] | (double)NAN;
+  fi.lon = o["lon"] | (double)NAN;
+  fi.distanceKm = o["distanceKm"] | (double)NAN;
+  fi.trackDeg = o["trackDeg"] | NAN;
+  fi.hasCallsign = o["hasCallsign"] | (fi.ident.length() > 0);
+  fi.seatOverride = o["seatOverride"] | -1;
+  fi.valid = true;
+
+  hasPower = o["battMv"].is<int>() || o["charging"].is<bool>() || o["onBattery"].is<bool>();
+  if (hasPower) {
+    g_power.battMv = o["battMv"] | g_power.battMv;
+    g_power.charging = o["charging"] | g_power.charging;
+    g_power.onBattery = o["onBattery"] | g_power.onBattery;
+  }
+  return true;
+}
+
+// Runs LVGL's refresh timer now, through LV_Helper's wrapper so the refresh
+// lands in lvglHelperGetStats().
+static void refreshNow() {
+  lv_disp_t *disp = lv_disp_get_default();
+  lv_timer_ready(disp->refr_timer);
+  lv_timer_handler();
+}
+
+static bool writePng(const MemoryDisplay &board, const char *dir, unsigned frame) {
+  std::vector<uint8_t> png;
+  board.encodePng(png);
+  char path[512];
+  snprintf(path, sizeof(path), "%s/frame_%03u.png", dir, frame);
+  std::ofstream out(path, std::ios::binary);
+  out.write(reinterpret_cast<const char *>(png.data()), (std::streamsize)png.size());
+  return (bool)out;
+}
+
+int main(int argc, char **argv) {
+  const char *input = argc > 1 ? argv[1] : "tools/ui_flights.jsonl";
+  const char *pngDir = argc > 2 ? argv[2] : nullptr;
+  std::ifstream in(input);
+  if (!in) {
+    fprintf(stderr, "cannot open %s\n", input);
+    return 1;
+  }
+
+  MemoryDisplay board(kPanelSize, kPanelSize, true);
+  beginLvglHelper(board);
+
+  // Same metrics display_init derives from the panel.
+  DisplayMetrics metrics;
+  metrics.screenW = board.width();
+  metrics.screenH = board.height();
+  metrics.centerX = metrics.screenW / 2;
+  metrics.centerY = metrics.screenH / 2;
+  metrics.safeRadius = min(metrics.centerX, metrics.centerY) - 18;
+  UiState ui = uiInit(metrics);
+  if (!ui.ready) {
+    fprintf(stderr, "uiInit failed\n");
+    return 1;
+  }
+  uiRenderSplash(ui, "Flight Display", "replay");
+  refreshNow();
+  board.takeDamage();
+  lvglHelperResetStats();
+
+  printf("frame,ident,render_us,flush_us,invalidated_px,flushed_px,areas,widgets_changed,crc32\n");
+  unsigned frame = 0;
+  uint64_t renderTotal = 0;
+  uint32_t renderMax = 0;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    FlightInfo fi;
+    bool hasPower = false;
+    if (!parseFlight(line, fi, hasPower)) {
+      fprintf(stderr, "skipping unparsable line: %s\n", line.c_str());
+      continue;
+    }
+
+    LvglRenderStats before = lvglHelperGetStats();
+    UiRenderStats uiBefore = uiGetRenderStats();
+    if (hasPower) uiUpdateBattery(ui);
+    uiRenderFlight(ui, fi);
+    refreshNow();
+    LvglRenderStats after = lvglHelperGetStats();
+    UiRenderStats uiAfter = uiGetRenderStats();
+    MemoryDisplay::Damage damage = board.takeDamage();
+
+    bool refreshed = after.frames != before.frames;
+    uint32_t renderUs = refreshed ? after.lastRenderUs : 0;
+    renderTotal += renderUs;
+    if (renderUs > renderMax) renderMax = renderUs;
+    printf("%u,%s,%lu,%lu,%lu,%lu,%lu,%lu,%08lx\n", frame, fi.ident.c_str(), (unsigned long)renderUs,
+           (unsigned long)(refreshed ? after.lastFlushUs : 0),
+           (unsigned long)(after.invalidatedPixels - before.invalidatedPixels),
+           (unsigned long)damage.pixels, (unsigned long)damage.areas,
+           (unsigned long)(uiAfter.widgetsChanged - uiBefore.widgetsChanged),
+           (unsigned long)board.frameCrc());
+    if (pngDir && !writePng(board, pngDir, frame)) {
+      fprintf(stderr, "cannot write frame %u to %s\n", frame, pngDir);
+      return 1;
+    }
+    ++frame;
+  }
+
+  if (frame) {
+    fprintf(stderr, "%u frames, render mean %lu us, max %lu us\n", frame,
+            (unsigned long)(renderTotal / frame), (unsigned long)renderMax);
+  }
+  return 0;
+}
@@ -0,0 +1,502 @@
+#include "http_transport.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <lwip/sockets.h>
+#include <mbedtls/net_sockets.h>
+
+#include "config_features.h"
+#include "log.h"
+#include "tls_session_cache.h"
+
+#ifndef DNS_QUERY_TIMEOUT_MS
+#define DNS_QUERY_TIMEOUT_MS 1500
+#endif
+
+#ifndef DNS_CACHE_MIN_TTL_S
+#define DNS_CACHE_MIN_TTL_S 30
+#endif
+
+#ifndef DNS_CACHE_MAX_TTL_S
+#define DNS_CACHE_MAX_TTL_S 3600
+#endif
+
+#ifndef DNS_CACHE_FALLBACK_TTL_S
+#define DNS_CACHE_FALLBACK_TTL_S 300
+#endif
+
+namespace {
+constexpr size_t kHostMax = 64;
+constexpr size_t kDnsPacketMax = 512;
+
+// WiFiClientSecure performs setup and handshake in one call, leaving no
+// point to offer a cached session. This mirrors the core's insecure-mode
+// start_ssl_client() on the same context, so read/write/stop work unchanged.
+class PooledTlsClient : public WiFiClientSecure {
+ public:
+  bool connectResuming(IPAddress ip, uint16_t port, const char *host, uint32_t timeoutMs,
+                       bool &resumed, HttpConnectTiming &timing);
+
+ private:
+  bool openSocket(IPAddress ip, uint16_t port, uint32_t timeoutMs);
+};
+
+struct PoolSlot {
+  char host[kHostMax] = {0};
+  uint16_t port = 0;
+  bool inUse = false;
+  bool warm = false;
+  uint32_t connectedMs = 0;
+  uint32_t lastUseMs = 0;
+};
+
+struct DnsEntry {
+  char host[kHostMax] = {0};
+  IPAddress ip;
+  uint32_t expiresMs = 0;
+  uint32_t lastUseMs = 0;
+};
+}  // namespace
+
+static PooledTlsClient g_clients[HTTP_POOL_SLOTS];
+static PoolSlot g_slots[HTTP_POOL_SLOTS];
+static DnsEntry g_dns[DNS_CACHE_SIZE];
+static HttpTransportStats g_stats;
+static portMUX_TYPE g_transportMux = portMUX_INITIALIZER_UNLOCKED;
+
+bool PooledTlsClient::openSocket(IPAddress ip, uint16_t port, uint32_t timeoutMs) {
+  int fd = lwip_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd < 0) return false;
+  sslclient->socket = fd;
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = (uint32_t)ip;
+  addr.sin_port = htons(port);
+
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  int res = lwip_connect(fd, (struct sockaddr *)&addr, sizeof(addr));
+  if (res < 0 && errno != EINPROGRESS) return false;
+
+  fd_set fdset;
+  FD_ZERO(&fdset);
+  FD_SET(fd, &fdset);
+  struct timeval tv;
+  tv.tv_sec = timeoutMs / 1000;
+  tv.tv_usec = (timeoutMs % 1000) * 1000;
+  if (select(fd + 1, nullptr, &fdset, nullptr, &tv) <= 0) return false;
+  int sockErr = 0;
+  socklen_t errLen = sizeof(sockErr);
+  if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &sockErr, &errLen) < 0 || sockErr != 0) return false;
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+
+  int enable = 1;
+  lwip_setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  lwip_setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+  lwip_setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+  lwip_setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &enable, sizeof(enable));
+  return true;
+}
+
+bool PooledTlsClient::connectResuming(IPAddress ip, uint16_t port, const char *host,
+                                      uint32_t timeoutMs, bool &resumed,
+                                      HttpConnectTiming &timing) {
+  resumed = false;
+  stop();
+  mbedtls_ssl_init(&sslclient->ssl_ctx);
+  mbedtls_ssl_config_init(&sslclient->ssl_conf);
+  mbedtls_ctr_drbg_init(&sslclient->drbg_ctx);
+  mbedtls_entropy_init(&sslclient->entropy_ctx);
+
+  static const char kPers[] = "fd-tls";
+  uint32_t tcpStartUs = micros();
+  bool ok = openSocket(ip, port, timeoutMs);
+  uint32_t tlsStartUs = micros();
+  timing.tcpUs = tlsStartUs - tcpStartUs;
+  ok = ok &&
+       mbedtls_ctr_drbg_seed(&sslclient->drbg_ctx, mbedtls_entropy_func, &sslclient->entropy_ctx,
+                             (const unsigned char *)kPers, sizeof(kPers) - 1) == 0 &&
+       mbedtls_ssl_config_defaults(&sslclient->ssl_conf, MBEDTLS_SSL_IS_CLIENT,
+                                   MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT) == 0;
+  if (ok) {
+    mbedtls_ssl_conf_authmode(&sslclient->ssl_conf, MBEDTLS_SSL_VERIFY_NONE);
+    mbedtls_ssl_conf_rng(&sslclient->ssl_conf, mbedtls_ctr_drbg_random, &sslclient->drbg_ctx);
+    ok = mbedtls_ssl_setup(&sslclient->ssl_ctx, &sslclient->ssl_conf) == 0 &&
+         mbedtls_ssl_set_hostname(&sslclient->ssl_ctx, host) == 0;
+  }
+
+  // The master secret carries over on resumption, so it tells the two apart.
+  bool offered = false;
+  uint8_t offeredMaster[48];
+  if (ok) {
+    mbedtls_ssl_session cached;
+    if (tlsSessionLoad(host, cached)) {
+      offered = mbedtls_ssl_set_session(&sslclient->ssl_ctx, &cached) == 0;
+      memcpy(offeredMaster, cached.master, sizeof(offeredMaster));
+      mbedtls_ssl_session_free(&cached);
+    }
+    mbedtls_ssl_set_bio(&sslclient->ssl_ctx, &sslclient->socket, mbedtls_net_send,
+                        mbedtls_net_recv, nullptr);
+  }
+
+  uint32_t start = millis();
+  int ret = ok ? mbedtls_ssl_handshake(&sslclient->ssl_ctx) : -1;
+  while (ok && ret != 0) {
+    if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+      ok = false;
+    } else if ((millis() - start) > timeoutMs) {
+      ok = false;
+    } else {
+      vTaskDelay(2);
+      ret = mbedtls_ssl_handshake(&sslclient->ssl_ctx);
+    }
+  }
+  if (!ok) {
+    LOG_DEBUG("TLS handshake with %s failed (%d)", host, ret);
+    // A server that chokes on the offered session gets a full handshake next time.
+    if (offered) tlsSessionForget(host);
+    stop();
+    return false;
+  }
+
+  mbedtls_ssl_session fresh;
+  mbedtls_ssl_session_init(&fresh);
+  if (mbedtls_ssl_get_session(&sslclient->ssl_ctx, &fresh) == 0) {
+    resumed = offered && !memcmp(fresh.master, offeredMaster, sizeof(offeredMaster));
+    tlsSessionStore(host, fresh);
+  }
+  mbedtls_ssl_session_free(&fresh);
+  timing.tlsUs = micros() - tlsStartUs;
+  _connected = true;
+  return true;
+}
+
+static size_t buildDnsQuery(uint8_t *buf, size_t cap, const char *host, uint16_t id) {
+  if (cap < 12) return 0;
+  memset(buf, 0, 12);
+  buf[0] = (uint8_t)(id >> 8);
+  buf[1] = (uint8_t)id;
+  buf[2] = 0x01;  // recursion desired
+  buf[5] = 1;     // one question
+  size_t pos = 12;
+  const char *label = host;
+  while (*label) {
+    const char *dot = strchr(label, '.');
+    size_t len = dot ? (size_t)(dot - label) : strlen(label);
+    if (len == 0 || len > 63 || pos + 1 + len + 5 > cap) return 0;
+    buf[pos++] = (uint8_t)len;
+    memcpy(buf + pos, label, len);
+    pos += len;
+    label += len;
+    if (*label == '.') ++label;
+  }
+  buf[pos++] = 0;
+  buf[pos++] = 0;
+  buf[pos++] = 1;  // QTYPE A
+  buf[pos++] = 0;
+  buf[pos++] = 1;  // QCLASS IN
+  return pos;
+}
+
+static bool skipDnsName(const uint8_t *buf, size_t len, size_t &pos) {
+  while (pos < len) {
+    uint8_t l = buf[pos];
+    if ((l & 0xC0) == 0xC0) {
+      pos += 2;
+      return pos <= len;
+    }
+    if (l & 0xC0) return false;
+    pos += 1 + l;
+    if (l == 0) return pos <= len;
+  }
+  return false;
+}
+
+static bool parseDnsResponse(const uint8_t *buf, size_t len, uint16_t id, IPAddress &out,
+                             uint32_t &ttlS) {
+  if (len < 12) return false;
+  if ((((uint16_t)buf[0] << 8) | buf[1]) != id) return false;
+  if (!(buf[2] & 0x80)) return false;
+  if ((buf[3] & 0x0F) != 0) return false;
+  uint16_t qd = ((uint16_t)buf[4] << 8) | buf[5];
+  uint16_t an = ((uint16_t)buf[6] << 8) | buf[7];
+  size_t pos = 12;
+  for (uint16_t i = 0; i < qd; ++i) {
+    if (!skipDnsName(buf, len, pos)) return false;
+    pos += 4;
+  }
+  uint32_t minTtl = UINT32_MAX;
+  for (uint16_t i = 0; i < an; ++i) {
+    if (!skipDnsName(buf, len, pos) || pos + 10 > len) return false;
+    uint16_t type = ((uint16_t)buf[pos] << 8) | buf[pos + 1];
+    uint32_t ttl = ((uint32_t)buf[pos + 4] << 24) | ((uint32_t)buf[pos + 5] << 16) |
+                   ((uint32_t)buf[pos + 6] << 8) | buf[pos + 7];
+    uint16_t rdlen = ((uint16_t)buf[pos + 8] << 8) | buf[pos + 9];
+    pos += 10;
+    if (pos + rdlen > len) return false;
+    // A CNAME chain is only as fresh as its shortest-lived link.
+    if (ttl < minTtl) minTtl = ttl;
+    if (type == 1 && rdlen == 4) {
+      out = IPAddress(buf[pos], buf[pos + 1], buf[pos + 2], buf[pos + 3]);
+      ttlS = minTtl;
+      return true;
+    }
+    pos += rdlen;
+  }
+  return false;
+}
+
+// lwIP's resolver does not expose record TTLs, so A lookups go straight to
+// the DHCP-provided server; hostByName() remains the fallback.
+static bool queryDns(const char *host, IPAddress &out, uint32_t &ttlS) {
+  IPAddress server = WiFi.dnsIP(0);
+  if ((uint32_t)server == 0) return false;
+  uint8_t buf[kDnsPacketMax];
+  uint16_t id = (uint16_t)esp_random();
+  size_t qlen = buildDnsQuery(buf, sizeof(buf), host, id);
+  if (!qlen) return false;
+
+  WiFiUDP udp;
+  bool ok = false;
+  if (udp.beginPacket(server, 53) && udp.write(buf, qlen) == qlen && udp.endPacket()) {
+    uint32_t start = millis();
+    while ((int32_t)(millis() - start) < (int32_t)DNS_QUERY_TIMEOUT_MS) {
+      if (udp.parsePacket() > 0) {
+        int n = udp.read(buf, sizeof(buf));
+        if (n > 0 && parseDnsResponse(buf, (size_t)n, id, out, ttlS)) {
+          ok = true;
+          break;
+        }
+      }
+      vTaskDelay(pdMS_TO_TICKS(5));
+    }
+  }
+  udp.stop();
+  return ok;
+}
+
+static void dnsStore(const char *host, const IPAddress &ip, uint32_t ttlS, uint32_t now) {
+  if (strlen(host) >= kHostMax) return;
+  ttlS = constrain(ttlS, (uint32_t)DNS_CACHE_MIN_TTL_S, (uint32_t)DNS_CACHE_MAX_TTL_S);
+  portENTER_CRITICAL(&g_transportMux);
+  size_t slot = 0;
+  for (size_t i = 0; i < DNS_CACHE_SIZE; ++i) {
+    if (!strcmp(g_dns[i].host, host) || !g_dns[i].host[0]) {
+      slot = i;
+      break;
+    }
+    if (g_dns[i].lastUseMs < g_dns[slot].lastUseMs) slot = i;
+  }
+  strcpy(g_dns[slot].host, host);
+  g_dns[slot].ip = ip;
+  g_dns[slot].expiresMs = now + ttlS * 1000UL;
+  g_dns[slot].lastUseMs = now;
+  portEXIT_CRITICAL(&g_transportMux);
+}
+
+static void dnsInvalidate(const char *host) {
+  portENTER_CRITICAL(&g_transportMux);
+  for (size_t i = 0; i < DNS_CACHE_SIZE; ++i) {
+    if (!strcmp(g_dns[i].host, host)) g_dns[i].host[0] = '\0';
+  }
+  portEXIT_CRITICAL(&g_transportMux);
+}
+
+bool httpTransportResolve(const char *host, IPAddress &out) {
+  if (out.fromString(host)) return true;
+  uint32_t now = millis();
+  bool hit = false;
+  portENTER_CRITICAL(&g_transportMux);
+  for (size_t i = 0; i < DNS_CACHE_SIZE; ++i) {
+    DnsEntry &e = g_dns[i];
+    if (e.host[0] && !strcmp(e.host, host) && (int32_t)(e.expiresMs - now) > 0) {
+      out = e.ip;
+      e.lastUseMs = now;
+      ++g_stats.dnsHits;
+      hit = true;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&g_transportMux);
+  if (hit) return true;
+
+  uint32_t ttlS = 0;
+  if (!queryDns(host, out, ttlS)) {
+    if (!WiFi.hostByName(host, out)) {
+      portENTER_CRITICAL(&g_transportMux);
+      ++g_stats.dnsFailures;
+      portEXIT_CRITICAL(&g_transportMux);
+      LOG_WARN("DNS lookup failed for %s", host);
+      return false;
+    }
+    ttlS = DNS_CACHE_FALLBACK_TTL_S;
+  }
+  LOG_DEBUG("DNS %s -> %s ttl=%lus", host, out.toString().c_str(), (unsigned long)ttlS);
+  dnsStore(host, out, ttlS, millis());
+  portENTER_CRITICAL(&g_transportMux);
+  ++g_stats.dnsMisses;
+  portEXIT_CRITICAL(&g_transportMux);
+  return true;
+}
+
+static bool parseUrlHost(const String &url, char *host, size_t cap, uint16_t &port) {
+  if (!url.startsWith("https://")) return false;
+  int start = 8;
+  int end = start;
+  int len = (int)url.length();
+  while (end < len && url[end] != '/' && url[end] != ':' && url[end] != '?') ++end;
+  if (end == start || (size_t)(end - start) >= cap) return false;
+  memcpy(host, url.c_str() + start, end - start);
+  host[end - start] = '\0';
+  port = 443;
+  if (end < len && url[end] == ':') port = (uint16_t)atoi(url.c_str() + end + 1);
+  return port != 0;
+}
+
+static int8_t claimSlot(const char *host, uint16_t port, uint32_t now, bool &warm) {
+  int8_t slot = -1;
+  portENTER_CRITICAL(&g_transportMux);
+  // Prefer this host's idle slot (it may hold a pre-warmed connection),
+  // otherwise recycle the least recently used free one.
+  for (size_t i = 0; i < HTTP_POOL_SLOTS; ++i) {
+    if (!g_slots[i].inUse && g_slots[i].port == port && !strcmp(g_slots[i].host, host)) {
+      slot = (int8_t)i;
+      break;
+    }
+  }
+  if (slot < 0) {
+    for (size_t i = 0; i < HTTP_POOL_SLOTS; ++i) {
+      if (g_slots[i].inUse) continue;
+      if (slot < 0 || g_slots[i].lastUseMs < g_slots[slot].lastUseMs) slot = (int8_t)i;
+    }
+  }
+  if (slot >= 0) {
+    PoolSlot &s = g_slots[slot];
+    warm = s.warm && s.port == port && !strcmp(s.host, host) &&
+           (now - s.connectedMs) < HTTP_PREWARM_MAX_IDLE_MS;
+    s.inUse = true;
+    s.warm = false;
+    strcpy(s.host, host);
+    s.port = port;
+    s.lastUseMs = now;
+  }
+  portEXIT_CRITICAL(&g_transportMux);
+  return slot;
+}
+
+static void releaseSlot(int8_t slot, bool warm) {
+  portENTER_CRITICAL(&g_transportMux);
+  g_slots[slot].warm = warm;
+  if (warm) g_slots[slot].connectedMs = millis();
+  g_slots[slot].inUse = false;
+  portEXIT_CRITICAL(&g_transportMux);
+}
+
+static bool connectSlot(int8_t slot, const char *host, uint16_t port, uint32_t timeoutMs,
+                        HttpConnectTiming &timing) {
+  PooledTlsClient &c = g_clients[slot];
+  c.stop();
+  IPAddress ip;
+  uint32_t dnsStartUs = micros();
+  bool resolved = httpTransportResolve(host, ip);
+  timing.dnsUs = micros() - dnsStartUs;
+  if (!resolved) return false;
+  c.setInsecure();
+  bool resumed = false;
+  if (!c.connectResuming(ip, port, host, timeoutMs, resumed, timing)) {
+    // The cached address may have moved; resolve afresh next time.
+    dnsInvalidate(host);
+    portENTER_CRITICAL(&g_transportMux);
+    ++g_stats.connectFailures;
+    portEXIT_CRITICAL(&g_transportMux);
+    LOG_WARN("TLS connect to %s:%u failed", host, (unsigned)port);
+    return false;
+  }
+  uint32_t elapsed = timing.tlsUs / 1000;
+  portENTER_CRITICAL(&g_transportMux);
+  if (resumed) {
+    ++g_stats.resumedHandshakes;
+    g_stats.resumedHandshakeMsTotal += elapsed;
+  } else {
+    ++g_stats.fullHandshakes;
+    g_stats.fullHandshakeMsTotal += elapsed;
+  }
+  portEXIT_CRITICAL(&g_transportMux);
+  return true;
+}
+
+HttpLease::~HttpLease() {
+  if (_slot < 0) return;
+  // Requests send "Connection: close", so free the TLS context now rather
+  // than holding its buffers until the slot is reused.
+  g_clients[_slot].stop();
+  releaseSlot(_slot, false);
+}
+
+void HttpLease::recordTtfb(uint32_t ttfbMs) {
+  portENTER_CRITICAL(&g_transportMux);
+  if (_warm) {
+    ++g_stats.warmRequests;
+    g_stats.warmTtfbMsTotal += ttfbMs;
+  } else {
+    ++g_stats.coldRequests;
+    g_stats.coldTtfbMsTotal += ttfbMs;
+    g_stats.coldConnectMsTotal += (_timing.dnsUs + _timing.tcpUs + _timing.tlsUs) / 1000;
+  }
+  portEXIT_CRITICAL(&g_transportMux);
+}
+
+bool httpTransportAcquire(const String &url, HttpLease &lease, uint32_t connectTimeoutMs) {
+  char host[kHostMax];
+  uint16_t port = 0;
+  if (!parseUrlHost(url, host, sizeof(host), port)) {
+    LOG_ERROR("Unsupported URL: %s", url.c_str());
+    return false;
+  }
+  bool warm = false;
+  int8_t slot = claimSlot(host, port, millis(), warm);
+  if (slot < 0) {
+    LOG_WARN("HTTP pool exhausted");
+    return false;
+  }
+  lease._slot = slot;
+  lease._client = &g_clients[slot];
+  if (warm && g_clients[slot].connected()) {
+    lease._warm = true;
+    return true;
+  }
+  return connectSlot(slot, host, port, connectTimeoutMs, lease._timing);
+}
+
+bool httpTransportPrewarm(const String &url, uint32_t connectTimeoutMs) {
+  char host[kHostMax];
+  uint16_t port = 0;
+  if (!parseUrlHost(url, host, sizeof(host), port)) return false;
+  bool warm = false;
+  int8_t slot = claimSlot(host, port, millis(), warm);
+  if (slot < 0) return false;
+  if (warm && g_clients[slot].connected()) {
+    releaseSlot(slot, true);
+    return true;
+  }
+  HttpConnectTiming timing;
+  bool ok = connectSlot(slot, host, port, connectTimeoutMs, timing);
+  if (ok) {
+    portENTER_CRITICAL(&g_transportMux);
+    ++g_stats.prewarms;
+    portEXIT_CRITICAL(&g_transportMux);
+  } else {
+    g_clients[slot].stop();
+  }
+  releaseSlot(slot, ok);
+  return ok;
+}
+
+HttpTransportStats httpTransportGetStats() {
+  portENTER_CRITICAL(&g_transportMux);
+  HttpTransportStats s = g_stats;
+  portEXIT_CRITICAL(&g_transportMux);
+  return s;
+}
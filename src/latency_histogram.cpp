@@ -0,0 +1,25 @@
+#include "latency_histogram.h"
+
+void latencyHistogramAdd(LatencyHistogram &h, const uint32_t *bounds, uint32_t value) {
+  uint8_t i = 0;
+  while (i < LATENCY_HIST_BUCKETS - 1 && value > bounds[i]) ++i;
+  ++h.counts[i];
+  ++h.samples;
+  if (value > h.maxValue) h.maxValue = value;
+}
+
+uint32_t latencyHistogramPercentile(const LatencyHistogram &h, const uint32_t *bounds,
+                                    uint8_t pct) {
+  if (h.samples == 0) return 0;
+  uint32_t rank = (uint32_t)(((uint64_t)h.samples * pct + 99) / 100);
+  if (rank == 0) rank = 1;
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < LATENCY_HIST_BUCKETS; ++i) {
+    seen += h.counts[i];
+    if (seen >= rank) {
+      if (i == LATENCY_HIST_BUCKETS - 1) return h.maxValue;
+      return min(bounds[i], h.maxValue);
+    }
+  }
+  return h.maxValue;
+}
@@ -8,10 +8,14 @@
 
 #include "app_config.h"
 #include "app_controller.h"
+#include "boot_profiler.h"
+#include "config_hw.h"
 #include "display/drivers/common/LV_Helper.h"
+#include "display/drivers/AmoledDisplay/Amoled_DisplayPanel.h"
 #include "display_init.h"
 #include "log.h"
 #include "networking.h"
+#include "rtc_state.h"
 #include "ui.h"
 
 static void waitMs(uint32_t durationMs) {
@@ -21,11 +25,35 @@ static void waitMs(uint32_t durationMs) {
   }
 }
 
+static void networkBringUp() {
+  bootPhaseBegin(BootPhase::Network);
+  networkingInit();
+  networkingStartFetchTask();
+  bootPhaseEnd(BootPhase::Network);
+}
+
+#if BOOT_PARALLEL_WIFI
+static void networkInitTask(void *arg) {
+  (void)arg;
+  networkBringUp();
+  vTaskDelete(nullptr);
+}
+#endif
+
 void setup() {
+  bootProfilerInit();
   Serial.begin(115200);
   waitMs(20);
   LOG_INFO("Boot: Flight Display starting...");
+  rtcStateInit();
 
+#if BOOT_PARALLEL_WIFI
+  // Wi-Fi has nothing to share with the panel or LVGL, so its start-up
+  // (including the supply settle wait) overlaps theirs.
+  xTaskCreatePinnedToCore(networkInitTask, "netInit", 6144, nullptr, 2, nullptr, 0);
+#endif
+
+  bootPhaseBegin(BootPhase::Display);
   if (!displayInit()) {
     while (true) {
       LOG_ERROR("Display init failed");
@@ -33,15 +61,28 @@ void setup() {
     }
   }
 
+  bootPhaseEnd(BootPhase::Display);
+
+  bootPhaseBegin(BootPhase::Lvgl);
   beginLvglHelper(displayPanel(), false);
+  bootPhaseEnd(BootPhase::Lvgl);
+  bootPhaseBegin(BootPhase::Ui);
   DisplayMetrics metrics = displayGetMetrics();
   UiState ui = uiInit(metrics);
   if (ui.ready) {
-    uiRenderSplash(ui, "Booting...", nullptr);
+    // After deep sleep the last flight is on the first frame, not a splash.
+    FlightInfo retained;
+    if (rtcStateLoadFlight(retained)) {
+      uiRenderFlight(ui, retained);
+    } else {
+      uiRenderSplash(ui, "Booting...", nullptr);
+    }
   }
+  bootPhaseEnd(BootPhase::Ui);
 
-  networkingInit();
-  networkingStartFetchTask();
+#if !BOOT_PARALLEL_WIFI
+  networkBringUp();
+#endif
   appControllerInit(ui);
 }
 
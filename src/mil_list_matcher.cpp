@@ -0,0 +1,84 @@
+// The /v2/mil matcher and the hex address parser it shares with the rest of
+// flight_enrichment, kept apart from the HTTP code so they build on the host.
+#include "flight_enrichment.h"
+
+#include <Arduino.h>
+
+static int8_t hexNibble(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+bool flightEnrichmentParseHex(const String &s, uint32_t &out) {
+  uint32_t val = 0;
+  uint8_t digits = 0;
+  for (const char *p = s.c_str(); *p; ++p) {
+    int8_t nib = hexNibble(*p);
+    if (nib < 0) continue;
+    if (digits >= 6) break;
+    val = (val << 4) | (uint32_t)nib;
+    ++digits;
+  }
+  if (digits == 0) return false;
+  out = val;
+  return true;
+}
+
+MilListMatcher::MilListMatcher(const String *hexes, size_t count, bool *outIsMil)
+    : _outIsMil(outIsMil), _count(count < kMilLookupMax ? count : kMilLookupMax) {
+  for (size_t i = 0; i < _count; ++i) {
+    _cand[i] = 0;
+    flightEnrichmentParseHex(hexes[i], _cand[i]);
+  }
+}
+
+void MilListMatcher::consumeHex() {
+  if (_curDigits == 0) return;
+  ++_entries;
+  for (size_t i = 0; i < _count; ++i) {
+    if (!_outIsMil[i] && _cand[i] == _curHex) {
+      _outIsMil[i] = true;
+      ++_found;
+    }
+  }
+  _curHex = 0;
+  _curDigits = 0;
+}
+
+void MilListMatcher::feed(const char *buf, size_t n) {
+  static const char *kNeedle = "\"hex\":\"";
+  static const uint8_t kNeedleLen = 7;
+  for (size_t i = 0; i < n; ++i) {
+    char c = buf[i];
+    if (!_inHex) {
+      if (c == kNeedle[_match]) {
+        ++_match;
+        if (_match == kNeedleLen) {
+          _inHex = true;
+          _match = 0;
+          _curHex = 0;
+          _curDigits = 0;
+        }
+      } else {
+        _match = (c == kNeedle[0]) ? 1 : 0;
+      }
+    } else if (c == '"') {
+      consumeHex();
+      _inHex = false;
+    } else {
+      int8_t nib = hexNibble(c);
+      if (nib >= 0) {
+        if (_curDigits < 6) {
+          _curHex = (_curHex << 4) | (uint32_t)nib;
+          ++_curDigits;
+        }
+      } else {
+        _curHex = 0;
+        _curDigits = 0;
+        _inHex = false;
+      }
+    }
+  }
+}
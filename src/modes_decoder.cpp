@@ -0,0 +1,429 @@
+#include "modes_decoder.h"
+
+#include <Arduino.h>
+#include <limits.h>
+#include <math.h>
+
+#include "aircraft_table.h"
+#include "app_config.h"
+#include "flight_parser.h"
+
+namespace {
+constexpr uint32_t kModesPoly = 0xFFF409;
+constexpr uint8_t kBeastEsc = 0x1A;
+constexpr double kCprScale = 131072.0;  // 2^17
+
+struct CrcTable {
+  uint32_t v[256];
+  constexpr CrcTable() : v() {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i << 16;
+      for (int b = 0; b < 8; ++b) {
+        c = (c & 0x800000) ? ((c << 1) ^ kModesPoly) : (c << 1);
+      }
+      v[i] = c & 0xFFFFFF;
+    }
+  }
+};
+constexpr CrcTable kCrcTable;
+
+// Latitude where NL() drops from 59 - i to 58 - i (NZ = 15).
+constexpr float kNlThresholds[] = {
+    10.47047130f, 14.82817437f, 18.18626357f, 21.02939493f, 23.54504487f, 25.82924707f,
+    27.93898710f, 29.91135686f, 31.77209708f, 33.53993436f, 35.22899598f, 36.85025108f,
+    38.41241892f, 39.92256684f, 41.38651832f, 42.80914012f, 44.19454951f, 45.54626723f,
+    46.86733252f, 48.16039128f, 49.42776439f, 50.67150166f, 51.89342469f, 53.09516153f,
+    54.27817472f, 55.44378444f, 56.59318756f, 57.72747354f, 58.84763776f, 59.95459277f,
+    61.04917774f, 62.13216659f, 63.20427479f, 64.26616523f, 65.31845310f, 66.36171008f,
+    67.39646774f, 68.42322022f, 69.44242631f, 70.45451075f, 71.45986473f, 72.45884545f,
+    73.45177442f, 74.43893416f, 75.42056257f, 76.39684391f, 77.36789461f, 78.33374083f,
+    79.29428225f, 80.24923213f, 81.19801349f, 82.13956981f, 83.07199445f, 83.99173563f,
+    84.89166191f, 85.75541621f, 86.53536998f, 87.00000000f,
+};
+
+static const char kIdentChars[] =
+    "#ABCDEFGHIJKLMNOPQRSTUVWXYZ##### ###############0123456789######";
+
+static ModesStats g_stats;
+
+static double cprMod(double a, double b) {
+  double r = a - b * floor(a / b);
+  return r < 0 ? r + b : r;
+}
+
+static double normalizeLon(double lon) {
+  lon = cprMod(lon + 180.0, 360.0) - 180.0;
+  return lon;
+}
+
+static int8_t hexNibble(uint8_t c) {
+  if (c >= '0' && c <= '9') return (int8_t)(c - '0');
+  if (c >= 'a' && c <= 'f') return (int8_t)(c - 'a' + 10);
+  if (c >= 'A' && c <= 'F') return (int8_t)(c - 'A' + 10);
+  return -1;
+}
+
+static void emitFrame(ModesFramer &f, ModesFrameCallback cb, void *ctx) {
+  ++f.frames;
+  if (cb) cb(f.buf, f.pos, ctx);
+}
+
+enum BeastState : uint8_t { kBeastSync, kBeastType, kBeastBody };
+enum AvrState : uint8_t { kAvrSync, kAvrBody };
+
+static void beastStartType(ModesFramer &f, uint8_t type) {
+  f.pos = 0;
+  f.skip = 7;  // 48-bit MLAT timestamp + signal level
+  f.escaped = false;
+  switch (type) {
+    case '1': f.need = 2; f.emit = false; break;  // Mode A/C
+    case '2': f.need = kModesShortBytes; f.emit = true; break;
+    case '3': f.need = kModesLongBytes; f.emit = true; break;
+    default:
+      f.state = kBeastSync;
+      if (type != kBeastEsc) ++f.dropped;
+      else f.state = kBeastType;
+      return;
+  }
+  f.state = kBeastBody;
+}
+
+static void beastFeed(ModesFramer &f, const uint8_t *data, size_t len, ModesFrameCallback cb,
+                      void *ctx) {
+  for (size_t i = 0; i < len; ++i) {
+    uint8_t c = data[i];
+    switch (f.state) {
+      case kBeastSync:
+        if (c == kBeastEsc) f.state = kBeastType;
+        break;
+      case kBeastType:
+        beastStartType(f, c);
+        break;
+      case kBeastBody:
+        if (f.escaped) {
+          f.escaped = false;
+          if (c != kBeastEsc) {
+            // A lone 0x1A inside a body is the start of the next frame.
+            ++f.dropped;
+            beastStartType(f, c);
+            break;
+          }
+        } else if (c == kBeastEsc) {
+          f.escaped = true;
+          break;
+        }
+        if (f.skip > 0) {
+          --f.skip;
+          break;
+        }
+        f.buf[f.pos++] = c;
+        if (f.pos >= f.need) {
+          if (f.emit) emitFrame(f, cb, ctx);
+          f.state = kBeastSync;
+        }
+        break;
+      default:
+        f.state = kBeastSync;
+        break;
+    }
+  }
+}
+
+static void avrFeed(ModesFramer &f, const uint8_t *data, size_t len, ModesFrameCallback cb,
+                    void *ctx) {
+  for (size_t i = 0; i < len; ++i) {
+    uint8_t c = data[i];
+    if (c == '*' || c == '@') {
+      if (f.state == kAvrBody) ++f.dropped;
+      f.state = kAvrBody;
+      f.pos = 0;
+      f.nibble = 0;
+      f.skip = (c == '@') ? 12 : 0;  // "@" frames carry a 48-bit hex timestamp
+      continue;
+    }
+    if (f.state != kAvrBody) continue;
+
+    if (c == ';') {
+      if ((f.pos == kModesShortBytes || f.pos == kModesLongBytes) && f.nibble == 0) {
+        emitFrame(f, cb, ctx);
+      } else {
+        ++f.dropped;
+      }
+      f.state = kAvrSync;
+      continue;
+    }
+    int8_t nib = hexNibble(c);
+    if (nib < 0) {
+      ++f.dropped;
+      f.state = kAvrSync;
+      continue;
+    }
+    if (f.skip > 0) {
+      --f.skip;
+      continue;
+    }
+    if (f.nibble == 0) {
+      f.nibble = 0x10 | (uint8_t)nib;
+      continue;
+    }
+    if (f.pos >= kModesLongBytes) {
+      ++f.dropped;
+      f.state = kAvrSync;
+      continue;
+    }
+    f.buf[f.pos++] = (uint8_t)(((f.nibble & 0x0F) << 4) | (uint8_t)nib);
+    f.nibble = 0;
+  }
+}
+
+// Returned for an altitude field that carries no value, so a valid earlier
+// altitude is kept rather than overwritten.
+constexpr long kNoAltitude = LONG_MIN;
+
+static long decodeAc12(uint32_t ac12) {
+  if (ac12 == 0) return kNoAltitude;       // altitude not available
+  if (!(ac12 & 0x10)) return kNoAltitude;  // Gillham-coded (Q=0) altitudes are not decoded
+  uint32_t n = ((ac12 & 0xFE0) >> 1) | (ac12 & 0x0F);
+  return (long)n * 25 - 1000;
+}
+
+static bool applyPosition(TrackedAircraft &ac, uint32_t cprLat, uint32_t cprLon, bool odd,
+                          bool surface, uint32_t nowMs) {
+  uint8_t idx = odd ? 1 : 0;
+  if (ac.cprSurface != surface) {
+    ac.cprMs[0] = 0;
+    ac.cprMs[1] = 0;
+    ac.cprSurface = surface;
+  }
+  ac.cprLat[idx] = cprLat;
+  ac.cprLon[idx] = cprLon;
+  ac.cprMs[idx] = nowMs;
+
+  double refLat = HOME_LAT;
+  double refLon = HOME_LON;
+  if (!isnan(ac.lat) && !isnan(ac.lon) && nowMs - ac.lastPosMs < MODES_LOCAL_REF_MAX_MS) {
+    refLat = ac.lat;
+    refLon = ac.lon;
+  }
+
+  double lat = NAN;
+  double lon = NAN;
+  bool ok = false;
+  uint8_t other = idx ^ 1;
+  if (ac.cprMs[other] != 0 && nowMs - ac.cprMs[other] <= MODES_CPR_PAIR_MAX_MS) {
+    ok = modesCprGlobal(ac.cprLat[0], ac.cprLon[0], ac.cprLat[1], ac.cprLon[1], odd, surface,
+                        refLat, refLon, lat, lon);
+    if (ok) ++g_stats.positionsGlobal;
+  }
+  if (!ok) {
+    ok = modesCprLocal(cprLat, cprLon, odd, surface, refLat, refLon, lat, lon);
+    if (ok) ++g_stats.positionsLocal;
+  }
+  // Receiver-relative decoding is only unambiguous within half a CPR zone.
+  if (!ok || flightParserHomeDistanceKm(lat, lon) > MODES_MAX_RANGE_KM) {
+    ++g_stats.positionsRejected;
+    return false;
+  }
+  ac.lat = lat;
+  ac.lon = lon;
+  ac.lastPosMs = nowMs;
+  return true;
+}
+
+static void decodeVelocity(TrackedAircraft &ac, uint64_t me) {
+  uint8_t subtype = (uint8_t)((me >> 48) & 0x7);
+  if (subtype == 1 || subtype == 2) {
+    uint32_t vew = (uint32_t)((me >> 32) & 0x3FF);
+    uint32_t vns = (uint32_t)((me >> 21) & 0x3FF);
+    if (vew == 0 || vns == 0) return;
+    int mult = subtype == 2 ? 4 : 1;
+    double vx = (double)((int)(vew - 1) * mult);
+    double vy = (double)((int)(vns - 1) * mult);
+    if ((me >> 42) & 1) vx = -vx;
+    if ((me >> 31) & 1) vy = -vy;
+    ac.groundSpeedKt = (float)sqrt(vx * vx + vy * vy);
+    ac.trackDeg = (float)cprMod(atan2(vx, vy) * 180.0 / PI, 360.0);
+  } else if (subtype == 3 || subtype == 4) {
+    if (!((me >> 42) & 1)) return;  // heading not available
+    uint32_t hdg = (uint32_t)((me >> 32) & 0x3FF);
+    uint32_t as = (uint32_t)((me >> 21) & 0x3FF);
+    ac.trackDeg = (float)(hdg * 360.0 / 1024.0);
+    if (as != 0) ac.groundSpeedKt = (float)((as - 1) * (subtype == 4 ? 4 : 1));
+  } else {
+    return;
+  }
+  ++g_stats.velocities;
+}
+}  // namespace
+
+void modesFramerReset(ModesFramer &framer, ModesFeedFormat format) {
+  framer = ModesFramer{};
+  framer.format = format;
+}
+
+void modesFramerFeed(ModesFramer &framer, const uint8_t *data, size_t len, ModesFrameCallback cb,
+                     void *ctx) {
+  if (framer.format == ModesFeedFormat::Beast) {
+    beastFeed(framer, data, len, cb, ctx);
+  } else {
+    avrFeed(framer, data, len, cb, ctx);
+  }
+}
+
+uint32_t modesCrc(const uint8_t *msg, uint8_t len) {
+  uint32_t rem = 0;
+  for (uint8_t i = 0; i + 3 < len; ++i) {
+    rem = ((rem << 8) ^ kCrcTable.v[((rem >> 16) ^ msg[i]) & 0xFF]) & 0xFFFFFF;
+  }
+  return rem;
+}
+
+int modesCprNL(double lat) {
+  if (lat < 0) lat = -lat;
+  for (size_t i = 0; i < sizeof(kNlThresholds) / sizeof(kNlThresholds[0]); ++i) {
+    if (lat < kNlThresholds[i]) return 59 - (int)i;
+  }
+  return 1;
+}
+
+bool modesCprGlobal(uint32_t evenLat, uint32_t evenLon, uint32_t oddLat, uint32_t oddLon,
+                    bool oddNewest, bool surface, double refLat, double refLon, double &outLat,
+                    double &outLon) {
+  const double span = surface ? 90.0 : 360.0;
+  const double latE = evenLat / kCprScale;
+  const double lonE = evenLon / kCprScale;
+  const double latO = oddLat / kCprScale;
+  const double lonO = oddLon / kCprScale;
+
+  double j = floor(59.0 * latE - 60.0 * latO + 0.5);
+  double rlatE = (span / 60.0) * (cprMod(j, 60.0) + latE);
+  double rlatO = (span / 59.0) * (cprMod(j, 59.0) + latO);
+  if (surface) {
+    // Surface zones repeat every 90 degrees; pick the solution nearest the reference.
+    if (fabs(rlatE - 90.0 - refLat) < fabs(rlatE - refLat)) rlatE -= 90.0;
+    if (fabs(rlatO - 90.0 - refLat) < fabs(rlatO - refLat)) rlatO -= 90.0;
+  } else {
+    if (rlatE >= 270.0) rlatE -= 360.0;
+    if (rlatO >= 270.0) rlatO -= 360.0;
+  }
+  if (rlatE < -90.0 || rlatE > 90.0 || rlatO < -90.0 || rlatO > 90.0) return false;
+  int nl = modesCprNL(rlatE);
+  if (nl != modesCprNL(rlatO)) return false;
+
+  double lat = oddNewest ? rlatO : rlatE;
+  int ni = oddNewest ? nl - 1 : nl;
+  if (ni < 1) ni = 1;
+  double m = floor(lonE * (nl - 1) - lonO * nl + 0.5);
+  double lon = (span / ni) * (cprMod(m, ni) + (oddNewest ? lonO : lonE));
+  if (surface) {
+    double best = lon;
+    for (int k = 1; k < 4; ++k) {
+      double cand = lon + 90.0 * k;
+      if (fabs(normalizeLon(cand - refLon)) < fabs(normalizeLon(best - refLon))) best = cand;
+    }
+    lon = best;
+  }
+  outLat = lat;
+  outLon = normalizeLon(lon);
+  return true;
+}
+
+bool modesCprLocal(uint32_t cprLat, uint32_t cprLon, bool odd, bool surface, double refLat,
+                   double refLon, double &outLat, double &outLon) {
+  const double span = surface ? 90.0 : 360.0;
+  const double latC = cprLat / kCprScale;
+  const double lonC = cprLon / kCprScale;
+
+  double dLat = span / (odd ? 59.0 : 60.0);
+  double j = floor(refLat / dLat) + floor(0.5 + cprMod(refLat, dLat) / dLat - latC);
+  double lat = dLat * (j + latC);
+  if (lat < -90.0 || lat > 90.0) return false;
+
+  int ni = modesCprNL(lat) - (odd ? 1 : 0);
+  if (ni < 1) ni = 1;
+  double dLon = span / ni;
+  double m = floor(refLon / dLon) + floor(0.5 + cprMod(refLon, dLon) / dLon - lonC);
+  outLat = lat;
+  outLon = normalizeLon(dLon * (m + lonC));
+  return true;
+}
+
+bool modesDecodeFrame(const uint8_t *msg, uint8_t len, uint32_t nowMs) {
+  ++g_stats.frames;
+  uint8_t df = msg[0] >> 3;
+  if (len != kModesLongBytes || (df != 17 && df != 18)) {
+    ++g_stats.ignored;
+    return false;
+  }
+  if (df == 18) {
+    uint8_t cf = msg[0] & 0x7;
+    if (cf != 0 && cf != 1 && cf != 2 && cf != 6) {
+      ++g_stats.ignored;
+      return false;
+    }
+  }
+  uint32_t parity = ((uint32_t)msg[11] << 16) | ((uint32_t)msg[12] << 8) | msg[13];
+  if (modesCrc(msg, len) != parity) {
+    ++g_stats.crcErrors;
+    return false;
+  }
+
+  uint32_t icao = ((uint32_t)msg[1] << 16) | ((uint32_t)msg[2] << 8) | msg[3];
+  // DF18 CF=1 carries an address that is not an ICAO 24-bit address.
+  if (df == 18 && (msg[0] & 0x7) == 1) icao |= kAircraftNonIcao;
+  uint64_t me = 0;
+  for (uint8_t i = 4; i < 11; ++i) me = (me << 8) | msg[i];
+  uint8_t tc = (uint8_t)(me >> 51);
+
+  TrackedAircraft *ac = aircraftTableUpsert(icao, nowMs);
+  if (!ac) return false;
+
+  if (tc >= 1 && tc <= 4) {
+    char cs[9];
+    for (uint8_t i = 0; i < 8; ++i) {
+      cs[i] = kIdentChars[(me >> (42 - 6 * i)) & 0x3F];
+      if (cs[i] == '#') cs[i] = ' ';
+    }
+    uint8_t n = 8;
+    while (n > 0 && cs[n - 1] == ' ') --n;
+    cs[n] = '\0';
+    if (n > 0) {
+      memcpy(ac->callsign, cs, sizeof(ac->callsign));
+      ++g_stats.idents;
+    }
+    return true;
+  }
+
+  if (tc >= 5 && tc <= 8) {
+    ac->onGround = true;
+    ac->altitudeFt = 0;
+    uint8_t mov = (uint8_t)((me >> 44) & 0x7F);
+    if (mov == 1) ac->groundSpeedKt = 0;
+    if ((me >> 43) & 1) ac->trackDeg = (float)(((me >> 36) & 0x7F) * 360.0 / 128.0);
+    bool odd = (me >> 34) & 1;
+    applyPosition(*ac, (uint32_t)((me >> 17) & 0x1FFFF), (uint32_t)(me & 0x1FFFF), odd, true,
+                  nowMs);
+    return true;
+  }
+
+  if ((tc >= 9 && tc <= 18) || (tc >= 20 && tc <= 22)) {
+    // TC 20-22 carry GNSS height in the same AC12 encoding as barometric altitude.
+    long alt = decodeAc12((uint32_t)((me >> 36) & 0xFFF));
+    if (alt != kNoAltitude) ac->altitudeFt = alt;
+    ac->onGround = false;
+    bool odd = (me >> 34) & 1;
+    applyPosition(*ac, (uint32_t)((me >> 17) & 0x1FFFF), (uint32_t)(me & 0x1FFFF), odd, false,
+                  nowMs);
+    return true;
+  }
+
+  if (tc == 19) {
+    decodeVelocity(*ac, me);
+    return true;
+  }
+
+  ++g_stats.ignored;
+  return true;
+}
+
+ModesStats modesGetStats() { return g_stats; }
@@ -0,0 +1,163 @@
+#include "net_timing.h"
+
+#include "http_transport.h"
+
+static const uint32_t kBoundsMs[LATENCY_HIST_BUCKETS - 1] = {
+    1, 2, 5, 10, 20, 50, 100, 200, 300, 500, 750, 1000, 1500, 2000, 3000, 5000, 10000};
+
+static LatencyHistogram g_hist[kNetEndpointCount][kNetPhaseCount];
+static uint64_t g_bytesRead = 0;
+static portMUX_TYPE g_timingMux = portMUX_INITIALIZER_UNLOCKED;
+
+int TimedStream::available() {
+  if (aborted()) return 0;
+  uint32_t start = micros();
+  int n = _inner.available();
+  _busyUs += micros() - start;
+  return n;
+}
+
+int TimedStream::read() {
+  if (aborted()) return -1;
+  uint32_t start = micros();
+  int c = _inner.read();
+  _busyUs += micros() - start;
+  if (c >= 0) ++_bytes;
+  return c;
+}
+
+int TimedStream::peek() {
+  if (aborted()) return -1;
+  uint32_t start = micros();
+  int c = _inner.peek();
+  _busyUs += micros() - start;
+  return c;
+}
+
+size_t TimedStream::readBytes(char *buffer, size_t length) {
+  if (aborted()) return 0;
+  uint32_t start = micros();
+  size_t n = _inner.readBytes(buffer, length);
+  _busyUs += micros() - start;
+  _bytes += n;
+  return n;
+}
+
+NetPhaseTimer::NetPhaseTimer(NetEndpoint endpoint)
+    : _endpoint(endpoint), _startUs(micros()), _lastUs(_startUs) {
+  memset(_phaseUs, 0, sizeof(_phaseUs));
+  memset(_seen, 0, sizeof(_seen));
+}
+
+NetPhaseTimer::~NetPhaseTimer() {
+  if (_ok) {
+    _phaseUs[(size_t)NetPhase::Total] = micros() - _startUs;
+    _seen[(size_t)NetPhase::Total] = true;
+  }
+  size_t ep = (size_t)_endpoint;
+  portENTER_CRITICAL(&g_timingMux);
+  for (size_t p = 0; p < kNetPhaseCount; ++p) {
+    if (_seen[p]) latencyHistogramAdd(g_hist[ep][p], kBoundsMs, (_phaseUs[p] + 500) / 1000);
+  }
+  g_bytesRead += _bytes;
+  portEXIT_CRITICAL(&g_timingMux);
+}
+
+void NetPhaseTimer::connected(const HttpLease &lease) {
+  // A warm lease skipped setup entirely; only cold requests feed these phases.
+  if (!lease.warm()) {
+    const HttpConnectTiming &t = lease.timing();
+    _phaseUs[(size_t)NetPhase::Dns] = t.dnsUs;
+    _phaseUs[(size_t)NetPhase::Connect] = t.tcpUs;
+    _phaseUs[(size_t)NetPhase::Tls] = t.tlsUs;
+    _seen[(size_t)NetPhase::Dns] = true;
+    _seen[(size_t)NetPhase::Connect] = true;
+    _seen[(size_t)NetPhase::Tls] = true;
+  }
+  _lastUs = micros();
+}
+
+void NetPhaseTimer::mark(NetPhase phase) {
+  uint32_t now = micros();
+  _phaseUs[(size_t)phase] += now - _lastUs;
+  _seen[(size_t)phase] = true;
+  _lastUs = now;
+}
+
+void NetPhaseTimer::markStream(const TimedStream &stream) {
+  uint32_t now = micros();
+  uint32_t elapsed = now - _lastUs;
+  uint32_t body = min(stream.busyUs(), elapsed);
+  _phaseUs[(size_t)NetPhase::Body] += body;
+  _phaseUs[(size_t)NetPhase::Parse] += elapsed - body;
+  _seen[(size_t)NetPhase::Body] = true;
+  _seen[(size_t)NetPhase::Parse] = true;
+  _bytes += stream.bytes();
+  _lastUs = now;
+}
+
+const char *netEndpointName(NetEndpoint endpoint) {
+  switch (endpoint) {
+    case NetEndpoint::AircraftList: return "list";
+    case NetEndpoint::MilList: return "mil";
+    case NetEndpoint::HexDb: return "hexdb";
+    case NetEndpoint::Route: return "route";
+    default: return "?";
+  }
+}
+
+const char *netPhaseName(NetPhase phase) {
+  switch (phase) {
+    case NetPhase::Dns: return "dns";
+    case NetPhase::Connect: return "connect";
+    case NetPhase::Tls: return "tls";
+    case NetPhase::Ttfb: return "ttfb";
+    case NetPhase::Body: return "body";
+    case NetPhase::Parse: return "parse";
+    case NetPhase::Total: return "total";
+    default: return "?";
+  }
+}
+
+bool netTimingGet(NetEndpoint endpoint, NetPhase phase, LatencyHistogram &out) {
+  if (endpoint >= NetEndpoint::Count || phase >= NetPhase::Count) return false;
+  portENTER_CRITICAL(&g_timingMux);
+  out = g_hist[(size_t)endpoint][(size_t)phase];
+  portEXIT_CRITICAL(&g_timingMux);
+  return true;
+}
+
+uint32_t netTimingPercentile(const LatencyHistogram &h, uint8_t pct) {
+  return latencyHistogramPercentile(h, kBoundsMs, pct);
+}
+
+uint64_t netTimingBytesRead() {
+  portENTER_CRITICAL(&g_timingMux);
+  uint64_t bytes = g_bytesRead;
+  portEXIT_CRITICAL(&g_timingMux);
+  return bytes;
+}
+
+void netTimingReset() {
+  portENTER_CRITICAL(&g_timingMux);
+  for (size_t e = 0; e < kNetEndpointCount; ++e) {
+    for (size_t p = 0; p < kNetPhaseCount; ++p) g_hist[e][p] = LatencyHistogram{};
+  }
+  portEXIT_CRITICAL(&g_timingMux);
+}
+
+void netTimingPrint(Print &out) {
+  out.println("endpoint phase      n    p50    p90    p99    max (ms)");
+  for (size_t e = 0; e < kNetEndpointCount; ++e) {
+    for (size_t p = 0; p < kNetPhaseCount; ++p) {
+      LatencyHistogram h;
+      netTimingGet((NetEndpoint)e, (NetPhase)p, h);
+      if (!h.samples) continue;
+      out.printf("%-8s %-7s %6lu %6lu %6lu %6lu %6lu\n", netEndpointName((NetEndpoint)e),
+                 netPhaseName((NetPhase)p), (unsigned long)h.samples,
+                 (unsigned long)netTimingPercentile(h, 50),
+                 (unsigned long)netTimingPercentile(h, 90),
+                 (unsigned long)netTimingPercentile(h, 99), (unsigned long)h.maxValue);
+    }
+  }
+}
@@ -4,14 +4,20 @@
 #include <ArduinoJson.h>
 #include <HTTPClient.h>
 #include <WiFi.h>
-#include <WiFiClientSecure.h>
 
+#include <utility>
+
+#include "aircraft_table.h"
 #include "aircraft_types.h"
 #include "app_config.h"
 #include "config_features.h"
+#include "endpoint_pool.h"
 #include "flight_enrichment.h"
 #include "flight_parser.h"
+#include "http_transport.h"
 #include "log.h"
+#include "net_timing.h"
+#include "radar_targets.h"
 
 #ifndef FEATURE_HEXDB_LOOKUP
 #define FEATURE_HEXDB_LOOKUP 1
@@ -29,55 +35,52 @@ static uint16_t radiusNmFromKm(double km) {
 namespace {
 constexpr size_t kMilCandidateMax = 48;
 
-struct MilCandidate {
-  FlightInfo fi;
-  bool inFlight = false;
-  bool isMil = false;
-};
-
 static MilCandidate g_milCands[kMilCandidateMax];
 static String g_milFetchHexes[kMilCandidateMax];
 static size_t g_milFetchMap[kMilCandidateMax];
 static bool g_milFetchIsMil[kMilCandidateMax];
 }  // namespace
 
-bool networkClientFetchNearestFlight(FlightInfo &out, bool allowEnrichment) {
-  if (WiFi.status() != WL_CONNECTED) return false;
+static String buildAircraftUrl(const char *apiBase) {
+  String base = String(apiBase);
+  if (base.startsWith("http://")) base.replace("http://", "https://");
+  if (!base.startsWith("http")) base = String("https://") + base;
+  base += "/v2/lat/";
+  base += String(HOME_LAT, 6);
+  base += "/lon/";
+  base += String(HOME_LON, 6);
+  base += "/dist/";
+  base += String(radiusNmFromKm(SEARCH_RADIUS_KM));
+  return base;
+}
 
-  auto buildUrl = [](bool tls) {
-    String base = String(API_BASE);
-    if (tls) {
-      if (base.startsWith("http://")) base.replace("http://", "https://");
-      if (!base.startsWith("http")) base = String("https://") + base;
-    } else {
-      if (base.startsWith("https://")) base.replace("https://", "http://");
-      if (!base.startsWith("http")) base = String("http://") + base;
-    }
-    base += "/v2/lat/";
-    base += String(HOME_LAT, 6);
-    base += "/lon/";
-    base += String(HOME_LON, 6);
-    base += "/dist/";
-    base += String(radiusNmFromKm(SEARCH_RADIUS_KM));
-    return base;
-  };
-
-  String url = buildUrl(true);
+// `cancel`, when given, abandons the request at the next step once it turns
+// true; the body parse stops at its next read.
+static bool fetchAircraftDoc(const char *apiBase, JsonDocument &doc,
+                             const volatile bool *cancel) {
+  String url = buildAircraftUrl(apiBase);
   LOG_INFO("HTTP GET %s", url.c_str());
   LOG_DEBUG("WiFi RSSI: %d dBm", WiFi.RSSI());
   LOG_DEBUG("Free heap: %u", (unsigned)ESP.getFreeHeap());
 
+  NetPhaseTimer timer(NetEndpoint::AircraftList);
+  HttpLease lease;
+  if (!httpTransportAcquire(url, lease, HTTP_CONNECT_TIMEOUT_MS)) {
+    LOG_ERROR("HTTP connect failed (TLS)");
+    return false;
+  }
+  timer.connected(lease);
+  if (cancel && *cancel) return false;
+
   HTTPClient http;
   http.setReuse(false);
   http.setConnectTimeout(HTTP_CONNECT_TIMEOUT_MS);
   http.setTimeout(HTTP_READ_TIMEOUT_MS);
   http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
 
-  WiFiClientSecure client;
-  client.setInsecure();
   uint32_t clientTimeoutSec = (HTTP_READ_TIMEOUT_MS + 999) / 1000;
-  client.setTimeout(clientTimeoutSec);
-  if (!http.begin(client, url)) {
+  lease.client().setTimeout(clientTimeoutSec);
+  if (!http.begin(lease.client(), url)) {
     LOG_ERROR("HTTP begin failed (TLS)");
     return false;
   }
@@ -86,13 +89,20 @@ bool networkClientFetchNearestFlight(FlightInfo &out, bool allowEnrichment) {
   http.addHeader("Connection", "close");
   http.addHeader("User-Agent", "ESP32-FlightDisplay/2.0");
 
+  uint32_t sentMs = millis();
   int code = http.GET();
-  LOG_INFO("HTTP status: %d", code);
+  if (code > 0) lease.recordTtfb(millis() - sentMs);
+  timer.mark(NetPhase::Ttfb);
+  LOG_INFO("HTTP status: %d%s", code, lease.warm() ? " (pre-warmed)" : "");
   if (code != HTTP_CODE_OK) {
     LOG_WARN("HTTP error: %s", http.errorToString(code).c_str());
     http.end();
     return false;
   }
+  if (cancel && *cancel) {
+    http.end();
+    return false;
+  }
 
   size_t contentLength = http.getSize();
   LOG_DEBUG("HTTP Content-Length: %u", (unsigned)contentLength);
@@ -111,10 +121,11 @@ bool networkClientFetchNearestFlight(FlightInfo &out, bool allowEnrichment) {
   acObj["lon"] = true;
   acObj["category"] = true;
   acObj["seen_pos"] = true;
+  acObj["track"] = true;
 
-  JsonDocument doc;
-  DeserializationError err = deserializeJson(doc, http.getStream(),
-                                             DeserializationOption::Filter(filter));
+  TimedStream body(http.getStream(), cancel);
+  DeserializationError err = deserializeJson(doc, body, DeserializationOption::Filter(filter));
+  timer.markStream(body);
   http.end();
   if (err) {
     LOG_WARN("JSON parse error (streamed): %s", err.c_str());
@@ -126,112 +137,158 @@ bool networkClientFetchNearestFlight(FlightInfo &out, bool allowEnrichment) {
     LOG_INFO("No valid aircraft list in response");
     return false;
   }
-  JsonArray ac = root.as<JsonObject>()["ac"].as<JsonArray>();
+  timer.ok();
+  return true;
+}
 
-  FlightInfo bestAir;
-  FlightInfo bestGround;
-  FlightInfo bestMilAir;
-  FlightInfo bestMilGround;
-  bool hasAir = false;
-  bool hasGround = false;
-  bool hasMilAir = false;
-  bool hasMilGround = false;
-
-  size_t milCount = 0;
-  bool milTruncated = false;
-
-  for (JsonVariant v : ac) {
-    if (!v.is<JsonObject>()) continue;
-    FlightInfo fi;
-    if (!flightParserParseAircraft(v.as<JsonObject>(), fi)) continue;
-    bool inFlight = fi.altitudeFt > 0;
-    if (inFlight) {
-      if (!hasAir || fi.distanceKm < bestAir.distanceKm) {
-        bestAir = fi;
-        hasAir = true;
-      }
-    } else {
-      if (!hasGround || fi.distanceKm < bestGround.distanceKm) {
-        bestGround = fi;
-        hasGround = true;
-      }
-    }
-    if (fi.hex.length()) {
-      if (milCount < kMilCandidateMax) {
-        g_milCands[milCount].fi = fi;
-        g_milCands[milCount].inFlight = inFlight;
-        g_milCands[milCount].isMil = false;
-        ++milCount;
-      } else {
-        milTruncated = true;
-      }
-    }
+// A cancelled request lost a race rather than failed, so it leaves the
+// endpoint statistics alone.
+static bool fetchFromEndpoint(size_t idx, JsonDocument &doc,
+                              const volatile bool *cancel = nullptr) {
+  uint32_t start = millis();
+  bool ok = fetchAircraftDoc(endpointPoolBase(idx), doc, cancel);
+  uint32_t now = millis();
+  if (cancel && *cancel) return false;
+  if (ok) {
+    endpointPoolRecordSuccess(idx, now - start);
+  } else {
+    endpointPoolRecordFailure(idx, now);
   }
+  return ok;
+}
 
-  if (milTruncated) {
-    LOG_WARN("MIL candidate list truncated at %u", (unsigned)kMilCandidateMax);
+#if FEATURE_HEDGED_REQUESTS
+// The primary and the hedged request each run on their own worker task with
+// their own document, so the first good answer wins while the fetch task only
+// waits. The other request is then cancelled; a straggler keeps its slot busy
+// until it unwinds, and that slot's request runs inline on the next poll.
+struct FetchJob {
+  size_t endpoint = 0;
+  JsonDocument doc;
+  bool ok = false;
+  uint32_t gen = 0;
+  volatile bool cancel = false;
+  volatile bool busy = false;
+  TaskHandle_t task = nullptr;
+};
+struct FetchDone {
+  uint8_t slot;
+  uint32_t gen;
+};
+constexpr uint8_t kPrimaryJob = 0;
+constexpr uint8_t kHedgeJob = 1;
+constexpr size_t kFetchJobCount = 2;
+static FetchJob g_fetchJobs[kFetchJobCount];
+static QueueHandle_t g_fetchDone = nullptr;
+static uint32_t g_fetchGen = 0;
+
+static void fetchWorkerTask(void *arg) {
+  uint8_t slot = (uint8_t)(uintptr_t)arg;
+  FetchJob &job = g_fetchJobs[slot];
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    FetchDone done{slot, job.gen};
+    job.ok = fetchFromEndpoint(job.endpoint, job.doc, &job.cancel);
+    job.busy = false;
+    xQueueSend(g_fetchDone, &done, 0);
   }
+}
 
-  if (allowEnrichment && FEATURE_MIL_LOOKUP && milCount > 0) {
-    size_t fetchCount = 0;
+static bool startFetchJob(uint8_t slot, size_t endpoint) {
+  FetchJob &job = g_fetchJobs[slot];
+  if (job.busy) return false;
+  if (!g_fetchDone) {
+    g_fetchDone = xQueueCreate(kFetchJobCount * 2, sizeof(FetchDone));
+    if (!g_fetchDone) return false;
+  }
+  if (!job.task &&
+      xTaskCreatePinnedToCore(fetchWorkerTask, slot == kPrimaryJob ? "fetchPrimary" : "fetchHedge",
+                              12288, (void *)(uintptr_t)slot, 1, &job.task, 0) != pdPASS) {
+    job.task = nullptr;
+    return false;
+  }
+  job.endpoint = endpoint;
+  job.ok = false;
+  job.gen = g_fetchGen;
+  job.cancel = false;
+  job.busy = true;
+  xTaskNotifyGive(job.task);
+  return true;
+}
 
-    for (size_t i = 0; i < milCount; ++i) {
-      bool isMil = false;
-      if (flightEnrichmentIsMilitaryCached(g_milCands[i].fi.hex, isMil)) {
-        g_milCands[i].isMil = isMil;
-      } else {
-        g_milFetchHexes[fetchCount] = g_milCands[i].fi.hex;
-        g_milFetchMap[fetchCount] = i;
-        ++fetchCount;
-      }
-    }
+// Next job of this poll to finish, skipping completions left over from
+// earlier polls.
+static bool waitFetchJob(uint8_t &slot, uint32_t waitMs) {
+  uint32_t start = millis();
+  for (;;) {
+    uint32_t elapsed = millis() - start;
+    if (elapsed > waitMs) return false;
+    FetchDone done;
+    if (xQueueReceive(g_fetchDone, &done, pdMS_TO_TICKS(waitMs - elapsed)) != pdTRUE) return false;
+    if (done.gen != g_fetchGen) continue;
+    slot = done.slot;
+    return true;
+  }
+}
 
-    if (fetchCount > 0) {
-      for (size_t i = 0; i < fetchCount; ++i) {
-        g_milFetchIsMil[i] = false;
-      }
-      if (flightEnrichmentFetchMilList(g_milFetchHexes, fetchCount, g_milFetchIsMil)) {
-        for (size_t i = 0; i < fetchCount; ++i) {
-          g_milCands[g_milFetchMap[i]].isMil = g_milFetchIsMil[i];
-        }
-      }
-    }
+static bool fetchHedged(const size_t *order, size_t &next, JsonDocument &doc) {
+  ++g_fetchGen;
+  if (!startFetchJob(kPrimaryJob, order[0])) return false;
+  next = 1;
 
-    for (size_t i = 0; i < milCount; ++i) {
-      if (!g_milCands[i].isMil) continue;
-      if (g_milCands[i].inFlight) {
-        if (!hasMilAir || g_milCands[i].fi.distanceKm < bestMilAir.distanceKm) {
-          bestMilAir = g_milCands[i].fi;
-          hasMilAir = true;
-        }
-      } else {
-        if (!hasMilGround || g_milCands[i].fi.distanceKm < bestMilGround.distanceKm) {
-          bestMilGround = g_milCands[i].fi;
-          hasMilGround = true;
-        }
-      }
-    }
+  int winner = -1;
+  size_t running = 1;
+  bool hedged = false;
+  uint8_t slot = 0;
+  uint32_t hedgeMs = endpointPoolHedgeDelayMs(order[0]);
+  if (waitFetchJob(slot, hedgeMs)) {
+    running = 0;
+    if (g_fetchJobs[slot].ok) winner = slot;
+  } else if (ESP.getFreeHeap() < ENDPOINT_HEDGE_MIN_HEAP) {
+    // A second TLS session would not fit beside the primary's.
+    LOG_INFO("Hedge skipped: %u B free", (unsigned)ESP.getFreeHeap());
+  } else if (startFetchJob(kHedgeJob, order[1])) {
+    LOG_INFO("Hedging: %s slower than %lu ms, trying %s", endpointPoolBase(order[0]),
+             (unsigned long)hedgeMs, endpointPoolBase(order[1]));
+    hedged = true;
+    next = 2;
+    ++running;
   }
 
-  if (!hasAir && !hasGround) {
-    LOG_INFO("No valid aircraft found in response");
-    return false;
+  while (winner < 0 && running > 0) {
+    if (!waitFetchJob(slot, HTTP_CONNECT_TIMEOUT_MS + HTTP_READ_TIMEOUT_MS)) break;
+    --running;
+    if (g_fetchJobs[slot].ok) winner = slot;
+  }
+  if (hedged) endpointPoolRecordHedge(order[1], winner == kHedgeJob);
+  for (FetchJob &job : g_fetchJobs) {
+    if (job.busy) job.cancel = true;
   }
+  if (winner < 0) return false;
+  doc = std::move(g_fetchJobs[winner].doc);
+  return true;
+}
+#endif
 
-  FlightInfo closest;
-  if (hasMilAir) {
-    closest = bestMilAir;
-    LOG_INFO("Selected military airborne %s  dist %.2f km", closest.ident.c_str(),
-             closest.distanceKm);
-  } else {
-    closest = hasAir ? bestAir : bestGround;
-    if (hasAir) {
-      LOG_INFO("Closest airborne %s  dist %.2f km", closest.ident.c_str(), closest.distanceKm);
-    } else {
-      LOG_INFO("Closest grounded %s  dist %.2f km", closest.ident.c_str(), closest.distanceKm);
-    }
+static bool fetchAircraftList(JsonDocument &doc) {
+  size_t order[ENDPOINT_MAX];
+  size_t count = endpointPoolRank(order, ENDPOINT_MAX, millis());
+  size_t next = 0;
+
+#if FEATURE_HEDGED_REQUESTS
+  // On failure, continue with plain failover past the endpoints tried.
+  if (count > 1 && fetchHedged(order, next, doc)) return true;
+#endif
+
+  for (; next < count; ++next) {
+    if (next > 0) LOG_WARN("Failing over to %s", endpointPoolBase(order[next]));
+    if (fetchFromEndpoint(order[next], doc)) return true;
   }
+  return false;
+}
 
+bool networkClientEnrichFlight(FlightInfo &closest, bool allowEnrichment) {
+  bool complete = true;
   if (allowEnrichment && FEATURE_HEXDB_LOOKUP && closest.hex.length()) {
     bool typeKnown = closest.typeCode.length() && aircraftFriendlyName(closest.typeCode).length();
     bool needOwner = !closest.route.length();
@@ -245,6 +302,8 @@ bool networkClientFetchNearestFlight(FlightInfo &out, bool allowEnrichment) {
         }
         if (name.length()) closest.displayName = name;
         if (owner.length()) closest.registeredOwner = owner;
+      } else {
+        complete = false;
       }
     }
   }
@@ -258,10 +317,99 @@ bool networkClientFetchNearestFlight(FlightInfo &out, bool allowEnrichment) {
       closest.route = route;
     } else {
       LOG_WARN("Route lookup failed for %s", closest.ident.c_str());
+      complete = false;
     }
   } else if (allowEnrichment && FEATURE_ROUTE_LOOKUP && !closest.hasCallsign) {
     LOG_INFO("Route lookup skipped: no callsign for %s", closest.ident.c_str());
   }
+  return complete;
+}
+
+void networkClientPrewarm() {
+  if (WiFi.status() != WL_CONNECTED) return;
+  size_t order[ENDPOINT_MAX];
+  if (!endpointPoolRank(order, ENDPOINT_MAX, millis())) return;
+  httpTransportPrewarm(buildAircraftUrl(endpointPoolBase(order[0])), HTTP_CONNECT_TIMEOUT_MS);
+}
+
+bool networkClientNearestMilitary(MilCandidate *cands, size_t count, bool allowFetch,
+                                  FlightInfo &out) {
+  if (count > kMilCandidateMax) count = kMilCandidateMax;
+  size_t fetchCount = 0;
+  for (size_t i = 0; i < count; ++i) {
+    bool isMil = false;
+    if (flightEnrichmentIsMilitaryCached(cands[i].fi.hex, isMil)) {
+      cands[i].isMil = isMil;
+    } else {
+      g_milFetchHexes[fetchCount] = cands[i].fi.hex;
+      g_milFetchMap[fetchCount] = i;
+      g_milFetchIsMil[fetchCount] = false;
+      ++fetchCount;
+    }
+  }
+
+  if (allowFetch && fetchCount > 0 &&
+      flightEnrichmentFetchMilList(g_milFetchHexes, fetchCount, g_milFetchIsMil)) {
+    for (size_t i = 0; i < fetchCount; ++i) {
+      cands[g_milFetchMap[i]].isMil = g_milFetchIsMil[i];
+    }
+  }
+
+  const MilCandidate *best = nullptr;
+  for (size_t i = 0; i < count; ++i) {
+    if (!cands[i].isMil || !cands[i].inFlight) continue;
+    if (!best || cands[i].fi.distanceKm < best->fi.distanceKm) best = &cands[i];
+  }
+  if (!best) return false;
+  out = best->fi;
+  return true;
+}
+
+bool networkClientFetchNearestFlight(FlightInfo &out, bool allowEnrichment) {
+  if (WiFi.status() != WL_CONNECTED) return false;
+
+  JsonDocument doc;
+  if (!fetchAircraftList(doc)) return false;
+  JsonArray ac = doc["ac"].as<JsonArray>();
+
+  AircraftScan scan;
+  scan.cands = g_milCands;
+  scan.candCap = kMilCandidateMax;
+#if FEATURE_RADAR_VIEW
+  RadarSnapshot radar;
+  networkClientScanAircraft(ac, scan, &radar);
+  radarTargetsPublish(radar);
+#else
+  networkClientScanAircraft(ac, scan, nullptr);
+#endif
+  if (scan.candTruncated) {
+    LOG_WARN("MIL candidate list truncated at %u", (unsigned)kMilCandidateMax);
+  }
+
+  FlightInfo bestMilAir;
+  bool hasMilAir = allowEnrichment && FEATURE_MIL_LOOKUP &&
+                   networkClientNearestMilitary(g_milCands, scan.candCount, true, bestMilAir);
+
+  if (!scan.hasAir && !scan.hasGround) {
+    LOG_INFO("No valid aircraft found in response");
+    return false;
+  }
+
+  FlightInfo closest;
+  if (hasMilAir) {
+    closest = bestMilAir;
+    LOG_INFO("Selected military airborne %s  dist %.2f km", closest.ident.c_str(),
+             closest.distanceKm);
+  } else {
+    closest = scan.hasAir ? scan.bestAir : scan.bestGround;
+    if (scan.hasAir) {
+      LOG_INFO("Closest airborne %s  dist %.2f km", closest.ident.c_str(), closest.distanceKm);
+    } else {
+      LOG_INFO("Closest grounded %s  dist %.2f km", closest.ident.c_str(), closest.distanceKm);
+    }
+  }
+
+  networkClientEnrichFlight(closest, allowEnrichment);
 
   out = closest;
   return true;
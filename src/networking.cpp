@@ -2,14 +2,23 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
+#include <esp_heap_caps.h>
+#include <esp_wifi.h>
 
 #include "app_config.h"
+#include "backoff.h"
+#include "boot_profiler.h"
 #include "config_features.h"
 #include "config_hw.h"
+#include "flight_enrichment.h"
 #include "log.h"
+#include "net_timing.h"
 #include "network_client.h"
+#include "rtc_state.h"
+#include "stream_ingest.h"
+#include "ui_wake.h"
 
-static bool wifiInitialized = false;
+static volatile bool wifiInitialized = false;
 static bool wifiEverBegun = false;
 static uint32_t g_nextReconnectMs = 0;
 static uint8_t g_reconnectAttempt = 0;
@@ -20,67 +29,226 @@ static portMUX_TYPE g_flightMux = portMUX_INITIALIZER_UNLOCKED;
 static FlightInfo g_pendingFlight;
 static bool g_pendingValid = false;
 static uint32_t g_pendingSeq = 0;
+static NetworkingFetchStats g_fetchStats;
+// Guards g_wifiStats, written from the Wi-Fi event task and read from the
+// loop, and the claim on g_wifiConnecting.
+static portMUX_TYPE g_wifiMux = portMUX_INITIALIZER_UNLOCKED;
+static NetworkingWifiStats g_wifiStats;
+static uint32_t g_connectStartMs = 0;
+static bool g_fastAttempt = false;
+static bool g_staticIpSet = false;
 
-static void waitMs(uint32_t durationMs) {
-  uint32_t start = millis();
-  while ((int32_t)(millis() - start) < (int32_t)durationMs) {
-    yield();
-  }
-}
+// Sleep mode while associated: full-power radio normally, modem sleep
+// (waking every WIFI_LISTEN_INTERVAL beacons) in power-save builds.
+static wifi_ps_type_t runSleepType() { return POWER_SAVE ? WIFI_PS_MAX_MODEM : WIFI_PS_NONE; }
 
-static uint32_t backoffMs(uint8_t attempt, uint32_t base = 500, uint32_t cap = 8000) {
-  uint32_t exp = base << min<uint8_t>(attempt, 5);
-  uint32_t j = (exp >> 3) * (esp_random() & 0x7) / 7;
-  return min(cap, exp - (exp >> 4) + j);
+// Blocks rather than spins: networkingInit may run on core 0 beside the
+// Wi-Fi driver and must not starve it or the idle task.
+static void waitMs(uint32_t durationMs) { vTaskDelay(pdMS_TO_TICKS(durationMs)); }
+
+// Static config from config.h, else the cached lease on the fast path (when
+// WIFI_REUSE_DHCP_LEASE), else DHCP.
+static void applyIpConfig(const RtcWifiHint *hint) {
+#if defined(WIFI_STATIC_IP)
+  (void)hint;
+  IPAddress ip, gateway, netmask, dns;
+  ip.fromString(WIFI_STATIC_IP);
+  gateway.fromString(WIFI_STATIC_GATEWAY);
+  netmask.fromString(WIFI_STATIC_NETMASK);
+  dns.fromString(WIFI_STATIC_DNS);
+  g_staticIpSet = WiFi.config(ip, gateway, netmask, dns);
+#else
+  if (WIFI_REUSE_DHCP_LEASE && hint && hint->ip) {
+    g_staticIpSet = WiFi.config(IPAddress(hint->ip), IPAddress(hint->gateway),
+                                IPAddress(hint->netmask), IPAddress(hint->dns));
+  } else if (g_staticIpSet) {
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+    g_staticIpSet = false;
+  }
+#endif
 }
 
 static void connectWiFi() {
   if (WiFi.status() == WL_CONNECTED) return;
   if (!wifiInitialized) return;
-  if (g_wifiConnecting) return;
+  // networkingInit() on the netInit task and the loop's
+  // networkingEnsureConnected() can both get here; only the one that claims
+  // the flag calls WiFi.begin() until the attempt ends.
+  portENTER_CRITICAL(&g_wifiMux);
+  bool claimed = !g_wifiConnecting;
+  if (claimed) {
+    g_wifiConnecting = true;
+    g_fastAttempt = false;
+  }
+  portEXIT_CRITICAL(&g_wifiMux);
+  if (!claimed) return;
 #if WIFI_FAST_CONNECT
   WiFi.setTxPower(WIFI_RUN_TXPOWER);
   WiFi.setSleep(false);
 #endif
-  LOG_INFO("WiFi connecting to %s", WIFI_SSID);
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  RtcWifiHint hint;
+  bool fast = WIFI_FAST_RECONNECT && rtcStateLoadWifi(hint) && hint.channel != 0;
+  applyIpConfig(fast ? &hint : nullptr);
+  const uint8_t *bssid = fast ? hint.bssid : nullptr;
+  int32_t channel = fast ? hint.channel : 0;
+  if (fast) {
+    LOG_INFO("WiFi connecting to %s via %02X:%02X:%02X:%02X:%02X:%02X ch %d", WIFI_SSID,
+             bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5], (int)channel);
+  } else {
+    LOG_INFO("WiFi connecting to %s", WIFI_SSID);
+  }
+  g_fastAttempt = fast;
+  g_connectStartMs = millis();
+#if POWER_SAVE
+  // begin() rebuilds the station config, so set the listen interval between
+  // configuring and connecting.
+  WiFi.begin(WIFI_SSID, WIFI_PASSWORD, channel, bssid, false);
+  wifi_config_t conf;
+  if (esp_wifi_get_config(WIFI_IF_STA, &conf) == ESP_OK) {
+    conf.sta.listen_interval = WIFI_LISTEN_INTERVAL;
+    esp_wifi_set_config(WIFI_IF_STA, &conf);
+  }
+  esp_wifi_connect();
+#else
+  WiFi.begin(WIFI_SSID, WIFI_PASSWORD, channel, bssid);
+#endif
   wifiEverBegun = true;
-  g_wifiConnecting = true;
 }
 
+static void publishFlight(bool ok, const FlightInfo &fi) {
+  portENTER_CRITICAL(&g_flightMux);
+  g_pendingValid = ok;
+  if (ok) {
+    g_pendingFlight = fi;
+  }
+  g_pendingSeq++;
+  portEXIT_CRITICAL(&g_flightMux);
+  bootMilestone(BootPhase::FirstFetch);
+  uiWake();
+}
+
+static void recordFetch(uint32_t startUs) {
+  uint32_t us = micros() - startUs;
+  portENTER_CRITICAL(&g_flightMux);
+  g_fetchStats.fetches++;
+  g_fetchStats.activeUs += us;
+  portEXIT_CRITICAL(&g_flightMux);
+}
+
+#if FEATURE_FETCH_TRACE && !FEATURE_STREAM_INGEST
+// Heap blocks and bytes still allocated after the poll (positive when the
+// heap grew) include caches it filled, so a steady non-zero value over
+// repeated cycles points at a leak.
+struct FetchTrace {
+  uint64_t bytes;
+  multi_heap_info_t heap;
+};
+
+static void fetchTraceBegin(FetchTrace &t) {
+  t.bytes = netTimingBytesRead();
+  heap_caps_get_info(&t.heap, MALLOC_CAP_8BIT);
+}
+
+static void fetchTraceEnd(const FetchTrace &t, uint32_t startUs, bool ok, const FlightInfo &fi) {
+  uint32_t us = micros() - startUs;
+  multi_heap_info_t heap;
+  heap_caps_get_info(&heap, MALLOC_CAP_8BIT);
+  LOG_INFO("Fetch cycle %s %lums read=%luB blocks=%+ld used=%+ldB target=%s %s",
+           ok ? "ok" : "failed", (unsigned long)(us / 1000),
+           (unsigned long)(netTimingBytesRead() - t.bytes),
+           (long)heap.allocated_blocks - (long)t.heap.allocated_blocks,
+           (long)t.heap.total_free_bytes - (long)heap.total_free_bytes,
+           ok ? fi.hex.c_str() : "-", ok ? fi.ident.c_str() : "");
+}
+#endif
+
+#if FEATURE_STREAM_INGEST
+static void fetchTask(void *arg) {
+  (void)arg;
+  uint32_t lastPublish = 0;
+  bool firstFetch = true;
+  streamIngestInit();
+  for (;;) {
+    streamIngestService();
+    uint32_t now = millis();
+    if (g_forceFetch) {
+      g_forceFetch = false;
+      lastPublish = 0;
+    }
+    if ((int32_t)(now - lastPublish) >= (int32_t)STREAM_PUBLISH_INTERVAL_MS || lastPublish == 0) {
+      lastPublish = now;
+      FlightInfo fi;
+      bool allowEnrichment = !FAST_FIRST_FETCH || !firstFetch;
+      uint32_t startUs = micros();
+      bool ok = streamIngestSelect(fi, allowEnrichment);
+      recordFetch(startUs);
+      flightEnrichmentSaveHot();
+      if (ok) firstFetch = false;
+      publishFlight(ok, fi);
+    }
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+}
+#else
 static void fetchTask(void *arg) {
   (void)arg;
   uint32_t lastFetch = 0;
   bool firstFetch = true;
+  bool prewarmed = false;
   for (;;) {
     uint32_t now = millis();
     if (g_forceFetch) {
       g_forceFetch = false;
       lastFetch = 0;
     }
+#if FEATURE_HTTP_PREWARM
+    // Resolve and open the TLS connection just ahead of the poll so the poll
+    // itself starts at request-send.
+    if (!prewarmed && lastFetch != 0 &&
+        (int32_t)(now - lastFetch) >= (int32_t)(FETCH_INTERVAL_MS - HTTP_PREWARM_LEAD_MS)) {
+      prewarmed = true;
+      networkClientPrewarm();
+      now = millis();
+    }
+#endif
     if ((int32_t)(now - lastFetch) >= (int32_t)FETCH_INTERVAL_MS || lastFetch == 0) {
       lastFetch = now;
+      prewarmed = false;
       FlightInfo fi;
       bool allowEnrichment = !FAST_FIRST_FETCH || !firstFetch;
+#if FEATURE_FETCH_TRACE
+      FetchTrace trace;
+      fetchTraceBegin(trace);
+#endif
+      uint32_t startUs = micros();
       bool ok = networkClientFetchNearestFlight(fi, allowEnrichment);
-      portENTER_CRITICAL(&g_flightMux);
-      g_pendingValid = ok;
-      if (ok) {
-        g_pendingFlight = fi;
-        firstFetch = false;
-      }
-      g_pendingSeq++;
-      portEXIT_CRITICAL(&g_flightMux);
+      recordFetch(startUs);
+#if FEATURE_FETCH_TRACE
+      fetchTraceEnd(trace, startUs, ok, fi);
+#endif
+      flightEnrichmentSaveHot();
+      if (ok) firstFetch = false;
+      publishFlight(ok, fi);
     }
     vTaskDelay(pdMS_TO_TICKS(50));
   }
 }
+#endif
 
 void networkingInit() {
   WiFi.onEvent([](WiFiEvent_t event, WiFiEventInfo_t info) {
     switch (event) {
       case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
         LOG_WARN("WiFi disconnected. Reason: %d", info.wifi_sta_disconnected.reason);
+        if (g_wifiConnecting && g_fastAttempt) {
+          // The cached AP did not take us; scan on the next attempt.
+          LOG_WARN("WiFi fast reconnect failed; falling back to a scan");
+          rtcStateForgetWifi();
+          portENTER_CRITICAL(&g_wifiMux);
+          g_wifiStats.fastFailures++;
+          portEXIT_CRITICAL(&g_wifiMux);
+          g_fastAttempt = false;
+        }
         WiFi.setTxPower(WIFI_BOOT_TXPOWER);
         WiFi.setSleep(true);
         g_nextReconnectMs = 0;
@@ -95,10 +263,37 @@ void networkingInit() {
         {
           IPAddress ip(info.got_ip.ip_info.ip.addr);
           String ipStr = ip.toString();
-          LOG_INFO("WiFi got IP: %s", ipStr.c_str());
+          bootMilestone(BootPhase::WifiIp);
+          if (g_wifiConnecting) {
+            uint32_t ms = millis() - g_connectStartMs;
+            portENTER_CRITICAL(&g_wifiMux);
+            g_wifiStats.lastConnectMs = ms;
+            if (g_fastAttempt) {
+              g_wifiStats.fastConnects++;
+              g_wifiStats.fastConnectMsTotal += ms;
+            } else {
+              g_wifiStats.slowConnects++;
+              g_wifiStats.slowConnectMsTotal += ms;
+            }
+            portEXIT_CRITICAL(&g_wifiMux);
+            LOG_INFO("WiFi got IP: %s in %lums (%s)", ipStr.c_str(), (unsigned long)ms,
+                     g_fastAttempt ? "cached AP" : "scan");
+          } else {
+            LOG_INFO("WiFi got IP: %s", ipStr.c_str());
+          }
+        }
+        if (const uint8_t *bssid = WiFi.BSSID()) {
+          RtcWifiHint hint;
+          memcpy(hint.bssid, bssid, sizeof(hint.bssid));
+          hint.channel = (uint8_t)WiFi.channel();
+          hint.ip = info.got_ip.ip_info.ip.addr;
+          hint.gateway = info.got_ip.ip_info.gw.addr;
+          hint.netmask = info.got_ip.ip_info.netmask.addr;
+          hint.dns = (uint32_t)WiFi.dnsIP();
+          rtcStateSaveWifi(hint);
         }
         WiFi.setTxPower(WIFI_RUN_TXPOWER);
-        WiFi.setSleep(false);
+        WiFi.setSleep(runSleepType());
         g_reconnectAttempt = 0;
         g_forceFetch = true;
         g_wifiConnecting = false;
@@ -117,14 +312,17 @@ void networkingInit() {
   WiFi.setTxPower(WIFI_BOOT_TXPOWER);
   WiFi.setSleep(true);
 #endif
+  // Supply settling only matters on a cold start; after deep sleep the
+  // rails never went down. The loop may already be calling
+  // networkingEnsureConnected(), so only open the gate afterwards.
+  if (!rtcStateSleptMs()) waitMs(BOOT_POWER_SETTLE_MS);
   wifiInitialized = true;
-
-  waitMs(BOOT_POWER_SETTLE_MS);
   connectWiFi();
   g_forceFetch = true;
 }
 
 void networkingStartFetchTask() {
+  flightEnrichmentRestoreHot(rtcStateSleptMs());
   xTaskCreatePinnedToCore(fetchTask, "fetchTask", 12288, nullptr, 1, nullptr, 0);
 }
 
@@ -138,6 +336,20 @@ void networkingEnsureConnected() {
   connectWiFi();
 }
 
+NetworkingWifiStats networkingGetWifiStats() {
+  portENTER_CRITICAL(&g_wifiMux);
+  NetworkingWifiStats stats = g_wifiStats;
+  portEXIT_CRITICAL(&g_wifiMux);
+  return stats;
+}
+
+NetworkingFetchStats networkingGetFetchStats() {
+  portENTER_CRITICAL(&g_flightMux);
+  NetworkingFetchStats stats = g_fetchStats;
+  portEXIT_CRITICAL(&g_flightMux);
+  return stats;
+}
+
 bool networkingGetLatest(FlightInfo &out, bool &outValid, uint32_t &outSeq) {
   portENTER_CRITICAL(&g_flightMux);
   outSeq = g_pendingSeq;
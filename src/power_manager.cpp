@@ -3,8 +3,16 @@
 #include <Arduino.h>
 
 #include "config_hw.h"
+#include "display/drivers/AmoledDisplay/Amoled_DisplayPanel.h"
 #include "display_init.h"
 #include "log.h"
+#include "rtc_state.h"
+
+#if POWER_SAVE && defined(ESP32)
+#include <esp_pm.h>
+#endif
+
+static PowerSaveMode g_powerSaveMode = PowerSaveMode::Off;
 
 static uint8_t clampBrightness(int value) {
   if (value < 1) return 1;
@@ -19,10 +27,58 @@ static void waitMs(uint32_t durationMs) {
   }
 }
 
+static void enterIdleSleep() {
+  displayPanel().enableTouchWakeup();
+  displayPanel().setWakeupTimer((uint64_t)DUTY_CYCLE_WAKE_S * 1000000ULL);
+  rtcStateMarkSleep();
+  displayPanel().sleep();
+}
+
 void powerManagerInit(PowerManagerState &state) {
   pinMode(SLEEP_BUTTON_PIN, INPUT_PULLUP);
   state.lastTouchMs = millis();
   state.lastBrightness = displayGetState().brightness;
+  state.dutyWake = DUTY_CYCLE_WAKE_S > 0 && rtcStateTimerWake();
+}
+
+void powerManagerFetchDone(PowerManagerState &state, bool ok) {
+  if (ok || WiFi.status() == WL_CONNECTED) state.dutyFetchDone = true;
+}
+
+void powerSaveInit() {
+#if POWER_SAVE
+  g_powerSaveMode = PowerSaveMode::ModemSleep;
+#if defined(ESP32) && defined(CONFIG_PM_ENABLE)
+  esp_pm_config_esp32s3_t pm = {};
+  pm.max_freq_mhz = POWER_SAVE_CPU_MAX_MHZ;
+  pm.min_freq_mhz = POWER_SAVE_CPU_MIN_MHZ;
+  pm.light_sleep_enable = POWER_SAVE_LIGHT_SLEEP != 0;
+  esp_err_t err = esp_pm_configure(&pm);
+  if (err == ESP_ERR_NOT_SUPPORTED && pm.light_sleep_enable) {
+    // Automatic light sleep needs a tickless-idle FreeRTOS build.
+    LOG_WARN("Light sleep not supported by this core; clock scaling only");
+    pm.light_sleep_enable = false;
+    err = esp_pm_configure(&pm);
+  }
+  if (err != ESP_OK) {
+    LOG_WARN("Power management unavailable (%d); modem sleep only", (int)err);
+  } else if (pm.light_sleep_enable) {
+    displayPanel().enableTouchLightSleepWake();
+    g_powerSaveMode = PowerSaveMode::LightSleep;
+  }
+#endif
+  LOG_INFO("Power save: %s", powerSaveModeName(g_powerSaveMode));
+#endif
+}
+
+PowerSaveMode powerSaveMode() { return g_powerSaveMode; }
+
+const char *powerSaveModeName(PowerSaveMode mode) {
+  switch (mode) {
+    case PowerSaveMode::ModemSleep: return "modem sleep";
+    case PowerSaveMode::LightSleep: return "light sleep";
+    default: return "off";
+  }
 }
 
 void powerManagerTick(PowerManagerState &state, const FlightInfo *lastShown) {
@@ -34,6 +90,25 @@ void powerManagerTick(PowerManagerState &state, const FlightInfo *lastShown) {
     LOG_INFO("Touch %s", touched ? "ON" : "OFF");
     state.lastTouch = touched;
   }
+  if (state.dutyWake) {
+    if (touched) {
+      LOG_INFO("Touched during timer wake; staying awake");
+      state.dutyWake = false;
+    } else {
+      // millis() starts at boot, so it is the whole wake including init.
+      bool overBudget = now >= DUTY_CYCLE_BUDGET_MS;
+      if (state.dutyFetchDone || overBudget) {
+        rtcStateRecordDutyWake(now, !state.dutyFetchDone);
+        RtcDutyStats duty = rtcStateGetDutyStats();
+        LOG_INFO("Timer wake %s in %lums (wakes=%lu over budget=%lu avg=%lums)",
+                 state.dutyFetchDone ? "fetched" : "timed out", (unsigned long)now,
+                 (unsigned long)duty.wakes, (unsigned long)duty.overBudget,
+                 (unsigned long)(duty.totalAwakeMs / duty.wakes));
+        enterIdleSleep();
+      }
+      return;
+    }
+  }
   if (touched) {
     state.lastTouchMs = now;
     if (TOUCH_BRIGHTNESS_MS > 0) {
@@ -59,8 +134,7 @@ void powerManagerTick(PowerManagerState &state, const FlightInfo *lastShown) {
     bool charging = displayPanel().hasPowerManagement() && displayPanel().isCharging();
     if (!charging && (int32_t)(now - state.lastTouchMs) >= (int32_t)TOUCH_IDLE_SLEEP_MS) {
       LOG_INFO("Idle timeout reached; entering deep sleep");
-      displayPanel().enableTouchWakeup();
-      displayPanel().sleep();
+      enterIdleSleep();
     }
   }
 
@@ -78,6 +152,9 @@ void powerManagerTick(PowerManagerState &state, const FlightInfo *lastShown) {
         }
         waitMs(20);
       }
+      // Switched off by hand: no periodic wake-ups.
+      displayPanel().setWakeupTimer(0);
+      rtcStateMarkSleep();
       displayPanel().sleep();
     }
   } else {
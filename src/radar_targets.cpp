@@ -0,0 +1,46 @@
+#include "radar_targets.h"
+
+#include <math.h>
+
+#include "flight_parser.h"
+#include "ui_wake.h"
+
+static portMUX_TYPE g_radarMux = portMUX_INITIALIZER_UNLOCKED;
+static RadarSnapshot g_latest;
+static uint32_t g_seq = 0;
+
+void radarSnapshotOffer(RadarSnapshot &snap, uint32_t id, double lat, double lon, float trackDeg,
+                        bool airborne) {
+  if (isnan(lat) || isnan(lon)) return;
+  float km = (float)flightParserHomeDistanceKm(lat, lon);
+  size_t pos = snap.count;
+  while (pos > 0 && snap.blips[pos - 1].rangeKm > km) --pos;
+  if (pos >= RADAR_MAX_BLIPS) return;
+
+  size_t last = snap.count < RADAR_MAX_BLIPS ? snap.count : RADAR_MAX_BLIPS - 1;
+  for (size_t i = last; i > pos; --i) snap.blips[i] = snap.blips[i - 1];
+  if (snap.count < RADAR_MAX_BLIPS) ++snap.count;
+
+  RadarBlip &b = snap.blips[pos];
+  b.id = id;
+  b.rangeKm = km;
+  b.bearingDeg = (float)flightParserHomeBearingDeg(lat, lon);
+  b.trackDeg = trackDeg;
+  b.airborne = airborne;
+}
+
+void radarTargetsPublish(const RadarSnapshot &snap) {
+  portENTER_CRITICAL(&g_radarMux);
+  g_latest = snap;
+  ++g_seq;
+  portEXIT_CRITICAL(&g_radarMux);
+  uiWake();
+}
+
+bool radarTargetsGetLatest(RadarSnapshot &out, uint32_t &outSeq) {
+  portENTER_CRITICAL(&g_radarMux);
+  out = g_latest;
+  outSeq = g_seq;
+  portEXIT_CRITICAL(&g_radarMux);
+  return outSeq != 0;
+}
@@ -0,0 +1,195 @@
+#include "rtc_state.h"
+
+#include <esp_sleep.h>
+#include <sys/time.h>
+
+#include "log.h"
+
+namespace {
+constexpr uint32_t kRtcMagic = 0x52544331;  // "RTC1"
+
+struct RtcFlight {
+  char ident[16];
+  char typeCode[8];
+  char category[4];
+  char displayName[40];
+  char registeredOwner[40];
+  char hex[8];
+  char opClass[4];
+  char route[32];
+  int32_t altitudeFt;
+  float lat;
+  float lon;
+  float distanceKm;
+  float trackDeg;
+  int16_t seatOverride;
+  bool hasCallsign;
+  bool valid;
+};
+
+struct RtcWifi {
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t netmask;
+  uint32_t dns;
+};
+
+struct RtcState {
+  uint32_t magic;
+  bool haveFlight;
+  bool haveWifi;
+  RtcFlight flight;
+  RtcWifi wifi;
+  int64_t sleepEnterUs;
+  // Plain fields rather than RtcDutyStats, so the struct stays trivially
+  // constructible and is never re-initialized on wake.
+  uint32_t dutyWakes;
+  uint32_t dutyOverBudget;
+  uint32_t dutyLastAwakeMs;
+  uint64_t dutyTotalAwakeMs;
+};
+}  // namespace
+
+RTC_DATA_ATTR static RtcState g_rtc;
+static portMUX_TYPE g_rtcMux = portMUX_INITIALIZER_UNLOCKED;
+static bool g_timerWake = false;
+static uint32_t g_sleptMs = 0;
+
+// Wall-clock time keeps counting through deep sleep on the RTC timer.
+static int64_t wallUs() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+static void copyField(char *dst, size_t cap, const String &src) {
+  strncpy(dst, src.c_str(), cap - 1);
+  dst[cap - 1] = '\0';
+}
+
+void rtcStateInit() {
+  if (g_rtc.magic != kRtcMagic) {
+    memset(&g_rtc, 0, sizeof(g_rtc));
+    g_rtc.magic = kRtcMagic;
+    return;
+  }
+  g_timerWake = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER;
+  if (g_rtc.sleepEnterUs) {
+    int64_t slept = wallUs() - g_rtc.sleepEnterUs;
+    g_sleptMs = slept > 0 ? (uint32_t)(slept / 1000) : 0;
+    g_rtc.sleepEnterUs = 0;
+  }
+  LOG_INFO("RTC state: %s wake after %lums, flight=%d wifi=%d",
+           g_timerWake ? "timer" : "other", (unsigned long)g_sleptMs, (int)g_rtc.haveFlight,
+           (int)g_rtc.haveWifi);
+}
+
+bool rtcStateTimerWake() { return g_timerWake; }
+
+uint32_t rtcStateSleptMs() { return g_sleptMs; }
+
+void rtcStateMarkSleep() { g_rtc.sleepEnterUs = wallUs(); }
+
+void rtcStateSaveFlight(const FlightInfo &fi) {
+  RtcFlight f;
+  copyField(f.ident, sizeof(f.ident), fi.ident);
+  copyField(f.typeCode, sizeof(f.typeCode), fi.typeCode);
+  copyField(f.category, sizeof(f.category), fi.category);
+  copyField(f.displayName, sizeof(f.displayName), fi.displayName);
+  copyField(f.registeredOwner, sizeof(f.registeredOwner), fi.registeredOwner);
+  copyField(f.hex, sizeof(f.hex), fi.hex);
+  copyField(f.opClass, sizeof(f.opClass), fi.opClass);
+  copyField(f.route, sizeof(f.route), fi.route);
+  f.altitudeFt = (int32_t)fi.altitudeFt;
+  f.lat = (float)fi.lat;
+  f.lon = (float)fi.lon;
+  f.distanceKm = (float)fi.distanceKm;
+  f.trackDeg = fi.trackDeg;
+  f.seatOverride = (int16_t)fi.seatOverride;
+  f.hasCallsign = fi.hasCallsign;
+  f.valid = fi.valid;
+
+  portENTER_CRITICAL(&g_rtcMux);
+  g_rtc.flight = f;
+  g_rtc.haveFlight = true;
+  portEXIT_CRITICAL(&g_rtcMux);
+}
+
+bool rtcStateLoadFlight(FlightInfo &out) {
+  RtcFlight f;
+  portENTER_CRITICAL(&g_rtcMux);
+  bool have = g_rtc.haveFlight;
+  f = g_rtc.flight;
+  portEXIT_CRITICAL(&g_rtcMux);
+  if (!have) return false;
+
+  out = FlightInfo{};
+  out.ident = f.ident;
+  out.typeCode = f.typeCode;
+  out.category = f.category;
+  out.displayName = f.displayName;
+  out.registeredOwner = f.registeredOwner;
+  out.hex = f.hex;
+  out.opClass = f.opClass;
+  out.route = f.route;
+  out.altitudeFt = f.altitudeFt;
+  out.lat = f.lat;
+  out.lon = f.lon;
+  out.distanceKm = f.distanceKm;
+  out.trackDeg = f.trackDeg;
+  out.seatOverride = f.seatOverride;
+  out.hasCallsign = f.hasCallsign;
+  out.valid = f.valid;
+  return true;
+}
+
+void rtcStateSaveWifi(const RtcWifiHint &hint) {
+  portENTER_CRITICAL(&g_rtcMux);
+  RtcWifi &w = g_rtc.wifi;
+  memcpy(w.bssid, hint.bssid, sizeof(w.bssid));
+  w.channel = hint.channel;
+  w.ip = hint.ip;
+  w.gateway = hint.gateway;
+  w.netmask = hint.netmask;
+  w.dns = hint.dns;
+  g_rtc.haveWifi = true;
+  portEXIT_CRITICAL(&g_rtcMux);
+}
+
+bool rtcStateLoadWifi(RtcWifiHint &out) {
+  portENTER_CRITICAL(&g_rtcMux);
+  bool have = g_rtc.haveWifi;
+  const RtcWifi &w = g_rtc.wifi;
+  memcpy(out.bssid, w.bssid, sizeof(out.bssid));
+  out.channel = w.channel;
+  out.ip = w.ip;
+  out.gateway = w.gateway;
+  out.netmask = w.netmask;
+  out.dns = w.dns;
+  portEXIT_CRITICAL(&g_rtcMux);
+  return have;
+}
+
+void rtcStateForgetWifi() {
+  portENTER_CRITICAL(&g_rtcMux);
+  g_rtc.haveWifi = false;
+  portEXIT_CRITICAL(&g_rtcMux);
+}
+
+void rtcStateRecordDutyWake(uint32_t awakeMs, bool overBudget) {
+  g_rtc.dutyWakes++;
+  if (overBudget) g_rtc.dutyOverBudget++;
+  g_rtc.dutyLastAwakeMs = awakeMs;
+  g_rtc.dutyTotalAwakeMs += awakeMs;
+}
+
+RtcDutyStats rtcStateGetDutyStats() {
+  RtcDutyStats d;
+  d.wakes = g_rtc.dutyWakes;
+  d.overBudget = g_rtc.dutyOverBudget;
+  d.lastAwakeMs = g_rtc.dutyLastAwakeMs;
+  d.totalAwakeMs = g_rtc.dutyTotalAwakeMs;
+  return d;
+}
@@ -0,0 +1,159 @@
+#include "sbs_parser.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+// MSG,type,session,aircraft,hex,flight,dgen,tgen,dlog,tlog,callsign,alt,gs,trk,lat,lon,vr,sqk,
+// alert,emerg,spi,ground
+constexpr uint8_t kFieldCount = 22;
+constexpr uint8_t kFieldType = 1;
+constexpr uint8_t kFieldHex = 4;
+constexpr uint8_t kFieldCallsign = 10;
+constexpr uint8_t kFieldAltitude = 11;
+constexpr uint8_t kFieldGroundSpeed = 12;
+constexpr uint8_t kFieldTrack = 13;
+constexpr uint8_t kFieldLat = 14;
+constexpr uint8_t kFieldLon = 15;
+constexpr uint8_t kFieldSquawk = 17;
+constexpr uint8_t kFieldGround = 21;
+
+static bool parseLong(const char *s, long &out) {
+  if (!s || !*s) return false;
+  char *end = nullptr;
+  long v = strtol(s, &end, 10);
+  if (end == s) return false;
+  out = v;
+  return true;
+}
+
+static bool parseDouble(const char *s, double &out) {
+  if (!s || !*s) return false;
+  char *end = nullptr;
+  double v = strtod(s, &end);
+  if (end == s) return false;
+  out = v;
+  return true;
+}
+
+// Feeders mark addresses that are not ICAO 24-bit addresses (TIS-B,
+// anonymous, ground vehicles) with a leading '~'. The same six digits can
+// belong to a real ICAO address, so the marker is reported, not dropped.
+static bool parseIcao(const char *s, uint32_t &out, bool &nonIcao) {
+  uint32_t v = 0;
+  uint8_t digits = 0;
+  nonIcao = *s == '~';
+  if (nonIcao) ++s;
+  for (; *s; ++s) {
+    char c = *s;
+    uint8_t nib;
+    if (c >= '0' && c <= '9') nib = (uint8_t)(c - '0');
+    else if (c >= 'a' && c <= 'f') nib = (uint8_t)(c - 'a' + 10);
+    else if (c >= 'A' && c <= 'F') nib = (uint8_t)(c - 'A' + 10);
+    else return false;
+    if (++digits > 6) return false;
+    v = (v << 4) | nib;
+  }
+  if (digits == 0 || v == 0) return false;
+  out = v;
+  return true;
+}
+}  // namespace
+
+void sbsParserReset(SbsParser &parser) {
+  parser.len = 0;
+  parser.overflow = false;
+}
+
+bool sbsParseLine(char *line, size_t len, SbsMessage &out) {
+  if (len < 4 || memcmp(line, "MSG,", 4) != 0) return false;
+
+  const char *fields[kFieldCount];
+  uint8_t count = 0;
+  char *p = line;
+  char *end = line + len;
+  fields[count++] = p;
+  for (; p < end && count < kFieldCount; ++p) {
+    if (*p == ',') {
+      *p = '\0';
+      fields[count++] = p + 1;
+    }
+  }
+  *end = '\0';
+  if (count <= kFieldHex) return false;
+  for (uint8_t i = count; i < kFieldCount; ++i) fields[i] = "";
+
+  out = SbsMessage{};
+  long type = 0;
+  if (!parseLong(fields[kFieldType], type) || type < 1 || type > 8) return false;
+  out.transmissionType = (uint8_t)type;
+  if (!parseIcao(fields[kFieldHex], out.icao, out.nonIcao)) return false;
+
+  const char *cs = fields[kFieldCallsign];
+  if (*cs) {
+    size_t n = 0;
+    for (; cs[n] && n < sizeof(out.callsign) - 1; ++n) out.callsign[n] = cs[n];
+    while (n > 0 && out.callsign[n - 1] == ' ') --n;
+    out.callsign[n] = '\0';
+    out.hasCallsign = n > 0;
+  }
+
+  out.hasAltitude = parseLong(fields[kFieldAltitude], out.altitudeFt);
+
+  double gs = NAN;
+  double trk = NAN;
+  bool hasGs = parseDouble(fields[kFieldGroundSpeed], gs);
+  bool hasTrk = parseDouble(fields[kFieldTrack], trk);
+  if (hasGs || hasTrk) {
+    out.groundSpeedKt = (float)gs;
+    out.trackDeg = (float)trk;
+    out.hasVelocity = true;
+  }
+
+  if (parseDouble(fields[kFieldLat], out.lat) && parseDouble(fields[kFieldLon], out.lon)) {
+    out.hasPosition = !(out.lat == 0.0 && out.lon == 0.0);
+  }
+
+  long sq = 0;
+  if (parseLong(fields[kFieldSquawk], sq) && sq >= 0 && sq <= 7777) {
+    out.squawk = (uint16_t)sq;
+    out.hasSquawk = true;
+  }
+
+  long ground = 0;
+  if (parseLong(fields[kFieldGround], ground)) {
+    out.onGround = ground != 0;
+    out.hasGround = true;
+  }
+  return true;
+}
+
+void sbsParserFeed(SbsParser &parser, const uint8_t *data, size_t len, SbsMessageCallback cb,
+                   void *ctx) {
+  for (size_t i = 0; i < len; ++i) {
+    char c = (char)data[i];
+    if (c == '\r') continue;
+    if (c != '\n') {
+      if (parser.len < sizeof(parser.line) - 1) {
+        parser.line[parser.len++] = c;
+      } else {
+        parser.overflow = true;
+      }
+      continue;
+    }
+
+    ++parser.lines;
+    if (!parser.overflow && parser.len > 0) {
+      SbsMessage msg;
+      if (sbsParseLine(parser.line, parser.len, msg)) {
+        ++parser.messages;
+        if (cb) cb(msg, ctx);
+      } else {
+        ++parser.rejected;
+      }
+    } else if (parser.overflow) {
+      ++parser.rejected;
+    }
+    sbsParserReset(parser);
+  }
+}
@@ -0,0 +1,193 @@
+#include "stream_ingest.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#include "aircraft_table.h"
+#include "app_config.h"
+#include "backoff.h"
+#include "config_features.h"
+#include "flight_enrichment.h"
+#include "log.h"
+#include "modes_decoder.h"
+#include "network_client.h"
+#include "sbs_parser.h"
+
+#ifndef STREAM_HOST
+#define STREAM_HOST ""
+#endif
+#ifndef STREAM_PORT
+#if STREAM_FORMAT == STREAM_FORMAT_BEAST
+#define STREAM_PORT 30005
+#elif STREAM_FORMAT == STREAM_FORMAT_AVR
+#define STREAM_PORT 30002
+#else
+#define STREAM_PORT 30003
+#endif
+#endif
+
+static WiFiClient g_client;
+static SbsParser g_sbs;
+static ModesFramer g_modes;
+static StreamIngestStats g_stats;
+static uint32_t g_nextConnectMs = 0;
+static uint32_t g_lastRxMs = 0;
+static uint8_t g_connectAttempt = 0;
+static FlightInfo g_enriched;
+// When a failed lookup for g_enriched is tried again; 0 once it succeeded.
+static uint32_t g_enrichRetryMs = 0;
+static MilCandidate g_milCands[kMilLookupMax];
+// MIL status comes from the cache on every select; uncached candidates are
+// looked up at most once per STREAM_ENRICH_RETRY_MS.
+static uint32_t g_milFetchMs = 0;
+
+static void applySbs(const SbsMessage &msg, void *ctx) {
+  aircraftTableApplySbs(msg, *static_cast<uint32_t *>(ctx));
+}
+
+static void applyModes(const uint8_t *msg, uint8_t len, void *ctx) {
+  modesDecodeFrame(msg, len, *static_cast<uint32_t *>(ctx));
+}
+
+static void resetDecoder() {
+#if STREAM_FORMAT == STREAM_FORMAT_BEAST
+  modesFramerReset(g_modes, ModesFeedFormat::Beast);
+#elif STREAM_FORMAT == STREAM_FORMAT_AVR
+  modesFramerReset(g_modes, ModesFeedFormat::Avr);
+#else
+  sbsParserReset(g_sbs);
+#endif
+}
+
+static void feedDecoder(const uint8_t *data, size_t len, uint32_t &now) {
+#if STREAM_FORMAT == STREAM_FORMAT_BEAST || STREAM_FORMAT == STREAM_FORMAT_AVR
+  modesFramerFeed(g_modes, data, len, applyModes, &now);
+#else
+  sbsParserFeed(g_sbs, data, len, applySbs, &now);
+#endif
+}
+
+static bool ensureConnected(uint32_t now) {
+  if (g_client.connected()) return true;
+  g_stats.connected = false;
+  if (WiFi.status() != WL_CONNECTED) return false;
+  if ((int32_t)(now - g_nextConnectMs) < 0) return false;
+  if (!strlen(STREAM_HOST)) {
+    LOG_ERROR("Stream ingest enabled but STREAM_HOST is empty");
+    g_nextConnectMs = now + 60000;
+    return false;
+  }
+
+  g_client.stop();
+  LOG_INFO("Stream connecting to %s:%u", STREAM_HOST, (unsigned)STREAM_PORT);
+  if (!g_client.connect(STREAM_HOST, STREAM_PORT, STREAM_CONNECT_TIMEOUT_MS)) {
+    g_connectAttempt = min<uint8_t>(g_connectAttempt + 1, 10);
+    g_nextConnectMs = now + backoffMs(g_connectAttempt);
+    LOG_WARN("Stream connect failed; retry in %lu ms",
+             (unsigned long)(g_nextConnectMs - now));
+    return false;
+  }
+  g_client.setNoDelay(true);
+  resetDecoder();
+  g_connectAttempt = 0;
+  g_lastRxMs = millis();
+  g_stats.connected = true;
+  ++g_stats.connects;
+  LOG_INFO("Stream connected");
+  return true;
+}
+
+void streamIngestInit() {
+  g_stats = StreamIngestStats{};
+  resetDecoder();
+  g_nextConnectMs = 0;
+  g_connectAttempt = 0;
+  g_enriched = FlightInfo{};
+  g_enrichRetryMs = 0;
+  g_milFetchMs = 0;
+}
+
+void streamIngestService() {
+  uint32_t now = millis();
+  if (!ensureConnected(now)) return;
+
+  uint8_t buf[256];
+  size_t budget = STREAM_READ_BUDGET_BYTES;
+  while (budget > 0) {
+    int avail = g_client.available();
+    if (avail <= 0) break;
+    size_t want = min((size_t)avail, min(sizeof(buf), budget));
+    int n = g_client.read(buf, want);
+    if (n <= 0) break;
+    feedDecoder(buf, (size_t)n, now);
+    g_stats.bytes += (uint32_t)n;
+    budget -= (size_t)n;
+    g_lastRxMs = now;
+  }
+
+  if ((int32_t)(now - g_lastRxMs) >= (int32_t)STREAM_IDLE_TIMEOUT_MS) {
+    LOG_WARN("Stream idle for %lu ms; reconnecting", (unsigned long)(now - g_lastRxMs));
+    g_client.stop();
+    g_stats.connected = false;
+  }
+}
+
+bool streamIngestSelect(FlightInfo &out, bool allowEnrichment) {
+  uint32_t now = millis();
+  aircraftTableExpire(now);
+#if FEATURE_RADAR_VIEW
+  RadarSnapshot radar;
+  aircraftTableRadar(radar, now);
+  radarTargetsPublish(radar);
+#endif
+  FlightInfo fi;
+  if (!aircraftTableNearest(fi, now)) return false;
+
+  // Same preference as the polled path: the nearest airborne military
+  // aircraft wins over the nearest aircraft.
+  if (allowEnrichment && FEATURE_MIL_LOOKUP) {
+    size_t count = aircraftTableCandidates(g_milCands, kMilLookupMax, now);
+    bool fetch = (int32_t)(now - g_milFetchMs) >= 0;
+    if (fetch) g_milFetchMs = now + STREAM_ENRICH_RETRY_MS;
+    FlightInfo mil;
+    if (networkClientNearestMilitary(g_milCands, count, fetch, mil)) fi = mil;
+  }
+
+  // Enrichment is keyed on hex + ident so the (slow) HTTP lookups only run
+  // when the selected target or its callsign changes, or when a failed
+  // lookup is due for another try.
+  bool same = g_enriched.valid && g_enriched.hex == fi.hex && g_enriched.ident == fi.ident;
+  bool retry = same && allowEnrichment && g_enrichRetryMs &&
+               (int32_t)(now - g_enrichRetryMs) >= 0;
+  if (!same || retry) {
+    FlightInfo enriched = fi;
+    bool complete = networkClientEnrichFlight(enriched, allowEnrichment);
+    if (allowEnrichment) {
+      g_enriched = enriched;
+      g_enrichRetryMs = complete ? 0 : (millis() + STREAM_ENRICH_RETRY_MS) | 1;
+    }
+    fi = enriched;
+  } else {
+    fi.typeCode = g_enriched.typeCode;
+    fi.displayName = g_enriched.displayName;
+    fi.registeredOwner = g_enriched.registeredOwner;
+    fi.opClass = g_enriched.opClass;
+    fi.route = g_enriched.route;
+  }
+  out = fi;
+  return true;
+}
+
+StreamIngestStats streamIngestGetStats() {
+  StreamIngestStats s = g_stats;
+#if STREAM_FORMAT == STREAM_FORMAT_BEAST || STREAM_FORMAT == STREAM_FORMAT_AVR
+  ModesStats ms = modesGetStats();
+  s.messages = ms.frames;
+  s.rejected = ms.crcErrors + g_modes.dropped;
+#else
+  s.messages = g_sbs.messages;
+  s.rejected = g_sbs.rejected;
+#endif
+  s.tracked = aircraftTableCount();
+  return s;
+}
@@ -0,0 +1,102 @@
+#include "tls_session_cache.h"
+
+#include <Arduino.h>
+#include <mbedtls/x509_crt.h>
+
+#include "log.h"
+
+namespace {
+constexpr uint32_t kSessionMagic = 0x544C5331;  // "TLS1"
+constexpr size_t kHostMax = 48;
+
+struct RtcTlsSession {
+  uint32_t magic;
+  uint32_t stamp;
+  uint16_t len;
+  char host[kHostMax];
+  uint8_t data[TLS_SESSION_BLOB_MAX];
+};
+}  // namespace
+
+RTC_DATA_ATTR static RtcTlsSession g_sessions[TLS_SESSION_SLOTS];
+RTC_DATA_ATTR static uint32_t g_sessionStamp;
+static portMUX_TYPE g_sessionMux = portMUX_INITIALIZER_UNLOCKED;
+
+static int findSlot(const char *host) {
+  for (size_t i = 0; i < TLS_SESSION_SLOTS; ++i) {
+    const RtcTlsSession &s = g_sessions[i];
+    if (s.magic == kSessionMagic && s.len <= TLS_SESSION_BLOB_MAX &&
+        !strncmp(s.host, host, kHostMax)) {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+bool tlsSessionLoad(const char *host, mbedtls_ssl_session &out) {
+  uint8_t blob[TLS_SESSION_BLOB_MAX];
+  uint16_t len = 0;
+  portENTER_CRITICAL(&g_sessionMux);
+  int slot = findSlot(host);
+  if (slot >= 0) {
+    len = g_sessions[slot].len;
+    memcpy(blob, g_sessions[slot].data, len);
+  }
+  portEXIT_CRITICAL(&g_sessionMux);
+  if (slot < 0 || len == 0) return false;
+
+  mbedtls_ssl_session_init(&out);
+  if (mbedtls_ssl_session_load(&out, blob, len) != 0) {
+    mbedtls_ssl_session_free(&out);
+    tlsSessionForget(host);
+    return false;
+  }
+  return true;
+}
+
+void tlsSessionStore(const char *host, mbedtls_ssl_session &session) {
+  if (strlen(host) >= kHostMax) return;
+#if defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
+  // The certificate is not needed to resume and would not fit in RTC memory.
+  if (session.peer_cert) {
+    mbedtls_x509_crt_free(session.peer_cert);
+    mbedtls_free(session.peer_cert);
+    session.peer_cert = nullptr;
+  }
+#endif
+  uint8_t blob[TLS_SESSION_BLOB_MAX];
+  size_t len = 0;
+  int ret = mbedtls_ssl_session_save(&session, blob, sizeof(blob), &len);
+  if (ret != 0) {
+    LOG_DEBUG("TLS session for %s not cached (%d, %u bytes)", host, ret, (unsigned)len);
+    return;
+  }
+
+  portENTER_CRITICAL(&g_sessionMux);
+  int slot = findSlot(host);
+  if (slot < 0) {
+    // Replace an invalid slot first, otherwise the least recently stored one.
+    slot = 0;
+    for (size_t i = 0; i < TLS_SESSION_SLOTS; ++i) {
+      if (g_sessions[i].magic != kSessionMagic) {
+        slot = (int)i;
+        break;
+      }
+      if ((int32_t)(g_sessions[i].stamp - g_sessions[slot].stamp) < 0) slot = (int)i;
+    }
+  }
+  RtcTlsSession &s = g_sessions[slot];
+  s.magic = kSessionMagic;
+  s.stamp = ++g_sessionStamp;
+  s.len = (uint16_t)len;
+  strncpy(s.host, host, kHostMax);
+  memcpy(s.data, blob, len);
+  portEXIT_CRITICAL(&g_sessionMux);
+}
+
+void tlsSessionForget(const char *host) {
+  portENTER_CRITICAL(&g_sessionMux);
+  int slot = findSlot(host);
+  if (slot >= 0) g_sessions[slot].magic = 0;
+  portEXIT_CRITICAL(&g_sessionMux);
+}
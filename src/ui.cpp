@@ -5,6 +5,10 @@
 #include <math.h>
 
 #include "aircraft_types.h"
+#include "app_config.h"
+#include "config_features.h"
+#include "config_hw.h"
+#include "display/drivers/common/LV_Helper.h"
 #include "display_init.h"
 #include "log.h"
 
@@ -40,7 +44,39 @@ struct UiLvWidgets {
   lv_obj_t *ledLbl[3] = {nullptr, nullptr, nullptr};
 };
 
+#if FEATURE_RADAR_VIEW
+// Blip boxes are even-sized so moving one invalidates two 2x2-aligned rects.
+static constexpr int16_t kBlipBox = 24;
+static constexpr int16_t kBlipDot = 8;
+static constexpr int16_t kTickLen = 11;
+
+struct UiRadarBlip {
+  lv_obj_t *box = nullptr;
+  lv_obj_t *dot = nullptr;
+  lv_obj_t *tick = nullptr;
+  lv_point_t tickPts[2];
+  uint32_t id = 0;
+  bool used = false;
+  bool airborne = false;
+  int16_t x = 0;
+  int16_t y = 0;
+  int16_t tickDeg = -1;
+};
+
+struct UiRadar {
+  lv_obj_t *layer = nullptr;
+  lv_obj_t *rings = nullptr;
+  lv_color_t *ringBuf = nullptr;
+  int16_t size = 0;
+  float rangeKm = 0;
+  UiRadarBlip blips[RADAR_MAX_BLIPS];
+};
+
+static UiRadar g_radar;
+#endif
+
 static UiLvColors g_lvColors;
+static bool g_lowPower = false;
 static UiLvWidgets g_lv;
 static bool g_lvReady = false;
 static DisplayMetrics g_metrics;
@@ -65,15 +101,85 @@ static void computeLayout() {
   g_labelY = g_windowY + g_windowH + 18;
 }
 
+static UiRenderStats g_uiStats;
+static int8_t g_activeOp = -2;  // index of the lit LED, -1 none, -2 never set
+static const char *kOpLabels[3] = {"PVT", "COM", "MIL"};
+
+// The low-power palette keeps the layout but lights far fewer pixels: black
+// panels, dimmer text and greens, and LEDs drawn as outlines.
+static void uiSetPalette(bool lowPower) {
+  if (!lowPower) {
+    g_lvColors.bg = lv_color_hex(0x0A0B0C);
+    g_lvColors.bezel = lv_color_hex(0x000000);
+    g_lvColors.bezelBorder = lv_color_hex(0x000000);
+    g_lvColors.screen = lv_color_hex(0x0A100B);
+    g_lvColors.screenBorder = lv_color_hex(0x000000);
+    g_lvColors.text = lv_color_hex(0xE6E6E6);
+    g_lvColors.muted = lv_color_hex(0x9AA0A6);
+    g_lvColors.label = lv_color_hex(0x7C7C7C);
+    g_lvColors.green = lv_color_hex(0x64FF78);
+    g_lvColors.greenDim = lv_color_hex(0x3CAA50);
+    g_lvColors.pvt = lv_color_hex(0xE6E6E6);
+    g_lvColors.com = lv_color_hex(0xFAF5EB);
+    g_lvColors.mil = lv_color_hex(0xD21E1E);
+    g_lvColors.ledOff = lv_color_hex(0x2F3336);
+    return;
+  }
+  g_lvColors.bg = lv_color_hex(0x000000);
+  g_lvColors.bezel = lv_color_hex(0x000000);
+  g_lvColors.bezelBorder = lv_color_hex(0x000000);
+  g_lvColors.screen = lv_color_hex(0x000000);
+  g_lvColors.screenBorder = lv_color_hex(0x1A3320);
+  g_lvColors.text = lv_color_hex(0xA0A0A0);
+  g_lvColors.muted = lv_color_hex(0x646A6E);
+  g_lvColors.label = lv_color_hex(0x4A4A4A);
+  g_lvColors.green = lv_color_hex(0x32B446);
+  g_lvColors.greenDim = lv_color_hex(0x1A5A26);
+  g_lvColors.pvt = lv_color_hex(0xA0A0A0);
+  g_lvColors.com = lv_color_hex(0xB4B0A8);
+  g_lvColors.mil = lv_color_hex(0xB41A1A);
+  g_lvColors.ledOff = lv_color_hex(0x000000);
+}
+
+// Label text lives in the widget, so comparing against it is the cache;
+// lv_label_set_text() invalidates the label even when the text is equal.
+static void uiSetLabel(lv_obj_t *label, const char *text) {
+  if (!strcmp(lv_label_get_text(label), text)) {
+    ++g_uiStats.widgetsUnchanged;
+    return;
+  }
+  lv_label_set_text(label, text);
+  ++g_uiStats.widgetsChanged;
+}
+
+static void uiSetTextColor(lv_obj_t *obj, lv_color_t color) {
+  if (lv_color_to32(lv_obj_get_style_text_color(obj, LV_PART_MAIN)) == lv_color_to32(color)) {
+    ++g_uiStats.widgetsUnchanged;
+    return;
+  }
+  lv_obj_set_style_text_color(obj, color, LV_PART_MAIN);
+  ++g_uiStats.widgetsChanged;
+}
+
 static void uiSetOpClass(const char *op) {
   if (!g_lvReady) return;
-  const char *labels[3] = {"PVT", "COM", "MIL"};
+  int8_t active = -1;
+  for (int i = 0; i < 3; ++i) {
+    if (op && strcmp(op, kOpLabels[i]) == 0) active = (int8_t)i;
+  }
+  if (active == g_activeOp) {
+    g_uiStats.widgetsUnchanged += 3;
+    return;
+  }
+  g_activeOp = active;
+  g_uiStats.widgetsChanged += 3;
   lv_color_t colors[3] = {g_lvColors.pvt, g_lvColors.com, g_lvColors.mil};
   for (int i = 0; i < 3; ++i) {
-    bool isActive = op && strcmp(op, labels[i]) == 0;
-    lv_color_t fill = isActive ? colors[i] : g_lvColors.ledOff;
+    bool isActive = i == active;
+    bool filled = isActive && !g_lowPower;
+    lv_color_t fill = filled ? colors[i] : g_lvColors.ledOff;
     lv_color_t border = isActive ? colors[i] : g_lvColors.label;
-    lv_color_t text = isActive ? lv_color_hex(0x000000) : g_lvColors.muted;
+    lv_color_t text = filled ? lv_color_hex(0x000000) : (isActive ? colors[i] : g_lvColors.muted);
     lv_obj_set_style_bg_color(g_lv.ledBtn[i], fill, LV_PART_MAIN);
     lv_obj_set_style_border_color(g_lv.ledBtn[i], border, LV_PART_MAIN);
     lv_obj_set_style_text_color(g_lv.ledLbl[i], text, LV_PART_MAIN);
@@ -82,37 +188,226 @@ static void uiSetOpClass(const char *op) {
 
 static void uiSetTitle(const String &title, const String &subtitle) {
   if (!g_lvReady) return;
-  lv_label_set_text(g_lv.title, title.c_str());
-  lv_label_set_text(g_lv.subtitle, subtitle.c_str());
+  uiSetLabel(g_lv.title, title.c_str());
+  uiSetLabel(g_lv.subtitle, subtitle.c_str());
 }
 
 static void uiSetMetrics(const char *dist, const char *seats, const char *alt) {
   if (!g_lvReady) return;
-  lv_label_set_text(g_lv.metricVal[0], dist);
-  lv_label_set_text(g_lv.metricVal[1], seats);
-  lv_label_set_text(g_lv.metricVal[2], alt);
+  uiSetLabel(g_lv.metricVal[0], dist);
+  uiSetLabel(g_lv.metricVal[1], seats);
+  uiSetLabel(g_lv.metricVal[2], alt);
 }
 
 static void uiSetRoute(const String &route) {
   if (!g_lvReady || !g_lv.route) return;
-  lv_label_set_text(g_lv.route, route.c_str());
+  uiSetLabel(g_lv.route, route.c_str());
 }
 
 static void uiSetBatteryMv(uint16_t mv, bool charging) {
   if (!g_lvReady || !g_lv.battLbl) return;
   if (mv == 0) {
-    lv_label_set_text(g_lv.battLbl, "--.-V");
-    lv_obj_set_style_text_color(g_lv.battLbl, g_lvColors.muted, LV_PART_MAIN);
+    uiSetLabel(g_lv.battLbl, "--.-V");
+    uiSetTextColor(g_lv.battLbl, g_lvColors.muted);
     return;
   }
   char buf[12];
   uint16_t whole = mv / 1000;
   uint16_t frac = (mv % 1000) / 10;
   snprintf(buf, sizeof(buf), "%u.%02uV", whole, frac);
-  lv_label_set_text(g_lv.battLbl, buf);
-  lv_obj_set_style_text_color(g_lv.battLbl,
-                              charging ? g_lvColors.mil : g_lvColors.green,
-                              LV_PART_MAIN);
+  uiSetLabel(g_lv.battLbl, buf);
+  uiSetTextColor(g_lv.battLbl, charging ? g_lvColors.mil : g_lvColors.green);
+}
+
+// Wraps one UI update so the widgets it touched and the area LVGL was asked
+// to repaint are attributed to it. Labels that resize are invalidated again
+// at the next layout pass, which lands in the refresh statistics instead.
+class UiUpdateScope {
+ public:
+  UiUpdateScope() : _startPx(lvglHelperGetStats().invalidatedPixels) {}
+  ~UiUpdateScope() {
+    uint32_t px = (uint32_t)(lvglHelperGetStats().invalidatedPixels - _startPx);
+    ++g_uiStats.updates;
+    g_uiStats.invalidatedPixels += px;
+    g_uiStats.lastInvalidatedPixels = px;
+  }
+
+ private:
+  uint64_t _startPx;
+};
+
+#if FEATURE_RADAR_VIEW
+// Range rings, cardinal ticks and labels never change, so they are drawn
+// once into a canvas; refreshes only blit the dirty part of it.
+static void uiRadarDrawRings() {
+  int16_t d = g_radar.size;
+  int16_t c = d / 2;
+  lv_canvas_fill_bg(g_radar.rings, g_lvColors.bezel, LV_OPA_COVER);
+
+  lv_draw_arc_dsc_t arc;
+  lv_draw_arc_dsc_init(&arc);
+  arc.color = g_lvColors.greenDim;
+  arc.width = 1;
+  lv_draw_label_dsc_t text;
+  lv_draw_label_dsc_init(&text);
+  text.color = g_lvColors.label;
+  text.font = &lv_font_montserrat_14;
+  for (int i = 1; i <= 3; ++i) {
+    int16_t r = (int16_t)((c - 4) * i / 3);
+    lv_canvas_draw_arc(g_radar.rings, c, c, r, 0, 360, &arc);
+    char buf[12];
+    snprintf(buf, sizeof(buf), "%.0f", g_radar.rangeKm * i / 3.0f);
+    lv_canvas_draw_text(g_radar.rings, c + 4, c - r + 2, 40, &text, buf);
+  }
+
+  lv_draw_line_dsc_t line;
+  lv_draw_line_dsc_init(&line);
+  line.color = g_lvColors.greenDim;
+  line.width = 1;
+  for (int i = 0; i < 4; ++i) {
+    float rad = i * 90.0f * PI / 180.0f;
+    lv_point_t pts[2] = {
+        {(lv_coord_t)(c + sinf(rad) * (c - 16)), (lv_coord_t)(c - cosf(rad) * (c - 16))},
+        {(lv_coord_t)(c + sinf(rad) * (c - 4)), (lv_coord_t)(c - cosf(rad) * (c - 4))},
+    };
+    lv_canvas_draw_line(g_radar.rings, pts, 2, &line);
+  }
+  lv_point_t h[2] = {{(lv_coord_t)(c - 6), (lv_coord_t)c}, {(lv_coord_t)(c + 6), (lv_coord_t)c}};
+  lv_point_t v[2] = {{(lv_coord_t)c, (lv_coord_t)(c - 6)}, {(lv_coord_t)c, (lv_coord_t)(c + 6)}};
+  line.color = g_lvColors.text;
+  lv_canvas_draw_line(g_radar.rings, h, 2, &line);
+  lv_canvas_draw_line(g_radar.rings, v, 2, &line);
+}
+
+static void uiRadarInit(lv_obj_t *scr) {
+  g_radar.size = (int16_t)((g_metrics.safeRadius * 2) & ~1);
+  g_radar.rangeKm = RADAR_RANGE_KM > 0 ? (float)RADAR_RANGE_KM : (float)SEARCH_RADIUS_KM;
+  g_radar.ringBuf = reinterpret_cast<lv_color_t *>(
+      ps_malloc(LV_CANVAS_BUF_SIZE_TRUE_COLOR(g_radar.size, g_radar.size)));
+  if (!g_radar.ringBuf) {
+    LOG_WARN("Radar view disabled: ring buffer allocation failed");
+    return;
+  }
+
+  g_radar.layer = lv_obj_create(scr);
+  lv_obj_remove_style_all(g_radar.layer);
+  lv_obj_set_size(g_radar.layer, g_metrics.screenW, g_metrics.screenH);
+  lv_obj_set_style_bg_color(g_radar.layer, g_lvColors.bezel, LV_PART_MAIN);
+  lv_obj_set_style_bg_opa(g_radar.layer, LV_OPA_COVER, LV_PART_MAIN);
+  lv_obj_add_flag(g_radar.layer, LV_OBJ_FLAG_EVENT_BUBBLE);
+  lv_obj_add_flag(g_radar.layer, LV_OBJ_FLAG_HIDDEN);
+  lv_obj_clear_flag(g_radar.layer, LV_OBJ_FLAG_SCROLLABLE);
+
+  g_radar.rings = lv_canvas_create(g_radar.layer);
+  lv_canvas_set_buffer(g_radar.rings, g_radar.ringBuf, g_radar.size, g_radar.size,
+                       LV_IMG_CF_TRUE_COLOR);
+  lv_obj_set_pos(g_radar.rings, g_metrics.centerX - g_radar.size / 2,
+                 g_metrics.centerY - g_radar.size / 2);
+  uiRadarDrawRings();
+
+  for (size_t i = 0; i < RADAR_MAX_BLIPS; ++i) {
+    UiRadarBlip &b = g_radar.blips[i];
+    b.box = lv_obj_create(g_radar.layer);
+    lv_obj_remove_style_all(b.box);
+    lv_obj_set_size(b.box, kBlipBox, kBlipBox);
+    lv_obj_clear_flag(b.box, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_flag(b.box, LV_OBJ_FLAG_HIDDEN);
+
+    b.dot = lv_obj_create(b.box);
+    lv_obj_remove_style_all(b.dot);
+    lv_obj_set_size(b.dot, kBlipDot, kBlipDot);
+    lv_obj_set_style_radius(b.dot, LV_RADIUS_CIRCLE, LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(b.dot, LV_OPA_COVER, LV_PART_MAIN);
+    lv_obj_set_style_bg_color(b.dot, g_lvColors.greenDim, LV_PART_MAIN);
+    lv_obj_center(b.dot);
+
+    b.tick = lv_line_create(b.box);
+    lv_obj_set_style_line_color(b.tick, g_lvColors.green, LV_PART_MAIN);
+    lv_obj_set_style_line_width(b.tick, 2, LV_PART_MAIN);
+    lv_obj_add_flag(b.tick, LV_OBJ_FLAG_HIDDEN);
+  }
+}
+
+static void uiRadarToggle(lv_event_t *e) {
+  (void)e;
+  if (!g_radar.layer) return;
+  if (lv_obj_has_flag(g_radar.layer, LV_OBJ_FLAG_HIDDEN)) {
+    lv_obj_clear_flag(g_radar.layer, LV_OBJ_FLAG_HIDDEN);
+  } else {
+    lv_obj_add_flag(g_radar.layer, LV_OBJ_FLAG_HIDDEN);
+  }
+}
+
+// Each setter below invalidates only what changed: a move repaints the old
+// and new blip boxes, a new heading only the box it sits in.
+static void uiRadarPlace(UiRadarBlip &b, const RadarBlip &t) {
+  float half = g_radar.size * 0.5f - kBlipBox * 0.5f;
+  float r = t.rangeKm >= g_radar.rangeKm ? half : half * t.rangeKm / g_radar.rangeKm;
+  float rad = t.bearingDeg * PI / 180.0f;
+  int16_t x = (int16_t)(g_metrics.centerX + sinf(rad) * r - kBlipBox / 2) & ~1;
+  int16_t y = (int16_t)(g_metrics.centerY - cosf(rad) * r - kBlipBox / 2) & ~1;
+
+  if (!b.used || lv_obj_has_flag(b.box, LV_OBJ_FLAG_HIDDEN) || x != b.x || y != b.y) {
+    lv_obj_set_pos(b.box, x, y);
+    b.x = x;
+    b.y = y;
+  }
+  if (!b.used || b.airborne != t.airborne) {
+    lv_obj_set_style_bg_color(b.dot, t.airborne ? g_lvColors.green : g_lvColors.label, LV_PART_MAIN);
+    b.airborne = t.airborne;
+  }
+
+  int16_t tickDeg = isnan(t.trackDeg) ? -1 : (int16_t)(lroundf(t.trackDeg / 5.0f) * 5 % 360);
+  if (tickDeg != b.tickDeg) {
+    if (tickDeg < 0) {
+      lv_obj_add_flag(b.tick, LV_OBJ_FLAG_HIDDEN);
+    } else {
+      float trk = tickDeg * PI / 180.0f;
+      b.tickPts[0] = {kBlipBox / 2, kBlipBox / 2};
+      b.tickPts[1] = {(lv_coord_t)(kBlipBox / 2 + sinf(trk) * kTickLen),
+                      (lv_coord_t)(kBlipBox / 2 - cosf(trk) * kTickLen)};
+      lv_line_set_points(b.tick, b.tickPts, 2);
+      lv_obj_clear_flag(b.tick, LV_OBJ_FLAG_HIDDEN);
+    }
+    b.tickDeg = tickDeg;
+  }
+  lv_obj_clear_flag(b.box, LV_OBJ_FLAG_HIDDEN);
+  b.id = t.id;
+  b.used = true;
+}
+#endif
+// Re-applies the palette to every widget styled at creation; the LEDs and
+// the radar's ring canvas are redrawn from scratch.
+static void uiApplyPalette() {
+  lv_obj_set_style_bg_color(lv_scr_act(), g_lvColors.bg, LV_PART_MAIN);
+  lv_obj_set_style_bg_color(g_lv.bezel, g_lvColors.bezel, LV_PART_MAIN);
+  lv_obj_set_style_border_color(g_lv.bezel, g_lvColors.bezelBorder, LV_PART_MAIN);
+  lv_obj_set_style_bg_color(g_lv.window, g_lvColors.screen, LV_PART_MAIN);
+  lv_obj_set_style_border_color(g_lv.window, g_lvColors.screenBorder, LV_PART_MAIN);
+  lv_obj_set_style_text_color(g_lv.timeLbl, g_lvColors.muted, LV_PART_MAIN);
+  lv_obj_set_style_text_color(g_lv.title, g_lvColors.green, LV_PART_MAIN);
+  lv_obj_set_style_text_color(g_lv.subtitle, g_lvColors.green, LV_PART_MAIN);
+  lv_obj_set_style_text_color(g_lv.route, g_lvColors.green, LV_PART_MAIN);
+  for (int i = 0; i < 3; ++i) {
+    lv_obj_set_style_text_color(g_lv.metricLbl[i], g_lvColors.label, LV_PART_MAIN);
+    lv_obj_set_style_text_color(g_lv.metricVal[i], g_lvColors.green, LV_PART_MAIN);
+  }
+  int8_t active = g_activeOp;
+  g_activeOp = -2;
+  uiSetOpClass(active >= 0 ? kOpLabels[active] : nullptr);
+
+#if FEATURE_RADAR_VIEW
+  if (g_radar.layer) {
+    lv_obj_set_style_bg_color(g_radar.layer, g_lvColors.bezel, LV_PART_MAIN);
+    uiRadarDrawRings();
+    for (size_t i = 0; i < RADAR_MAX_BLIPS; ++i) {
+      UiRadarBlip &b = g_radar.blips[i];
+      lv_obj_set_style_bg_color(b.dot, b.airborne ? g_lvColors.green : g_lvColors.label,
+                                LV_PART_MAIN);
+      lv_obj_set_style_line_color(b.tick, g_lvColors.green, LV_PART_MAIN);
+    }
+  }
+#endif
 }
 
 UiState uiInit(const DisplayMetrics &metrics) {
@@ -124,20 +419,7 @@ UiState uiInit(const DisplayMetrics &metrics) {
   }
   computeLayout();
 
-  g_lvColors.bg = lv_color_hex(0x0A0B0C);
-  g_lvColors.bezel = lv_color_hex(0x000000);
-  g_lvColors.bezelBorder = lv_color_hex(0x000000);
-  g_lvColors.screen = lv_color_hex(0x0A100B);
-  g_lvColors.screenBorder = lv_color_hex(0x000000);
-  g_lvColors.text = lv_color_hex(0xE6E6E6);
-  g_lvColors.muted = lv_color_hex(0x9AA0A6);
-  g_lvColors.label = lv_color_hex(0x7C7C7C);
-  g_lvColors.green = lv_color_hex(0x64FF78);
-  g_lvColors.greenDim = lv_color_hex(0x3CAA50);
-  g_lvColors.pvt = lv_color_hex(0xE6E6E6);
-  g_lvColors.com = lv_color_hex(0xFAF5EB);
-  g_lvColors.mil = lv_color_hex(0xD21E1E);
-  g_lvColors.ledOff = lv_color_hex(0x2F3336);
+  uiSetPalette(g_lowPower);
 
   lv_obj_t *scr = lv_scr_act();
   lv_obj_set_style_bg_color(scr, g_lvColors.bg, LV_PART_MAIN);
@@ -262,6 +544,16 @@ UiState uiInit(const DisplayMetrics &metrics) {
     lv_obj_set_pos(g_lv.battLbl, g_metrics.centerX + 30, topY);
   }
 
+#if FEATURE_RADAR_VIEW
+  // A long press anywhere flips between the flight card and the scope;
+  // a short tap stays a brightness boost for the power manager.
+  lv_obj_add_flag(g_lv.bezel, LV_OBJ_FLAG_EVENT_BUBBLE);
+  lv_obj_add_flag(g_lv.window, LV_OBJ_FLAG_EVENT_BUBBLE);
+  for (int i = 0; i < 3; ++i) lv_obj_add_flag(g_lv.ledBtn[i], LV_OBJ_FLAG_EVENT_BUBBLE);
+  uiRadarInit(scr);
+  lv_obj_add_event_cb(scr, uiRadarToggle, LV_EVENT_LONG_PRESSED, nullptr);
+#endif
+
   g_lvReady = true;
   state.ready = true;
   return state;
@@ -269,13 +561,26 @@ UiState uiInit(const DisplayMetrics &metrics) {
 
 void uiUpdateBattery(const UiState &state) {
   if (!state.ready || !displayIsReady()) return;
-  uint16_t mv = displayPanel().getBattVoltage();
-  bool charging = displayPanel().isCharging();
-  uiSetBatteryMv(mv, charging);
+  UiUpdateScope scope;
+  DisplayPower power = displayGetPower();
+#if LOW_POWER_THEME
+  if (power.onBattery != g_lowPower) {
+    LOG_INFO("UI theme: %s", power.onBattery ? "low power" : "normal");
+    g_lowPower = power.onBattery;
+    uiSetPalette(g_lowPower);
+    uiApplyPalette();
+    // The battery label keeps its color when the text is unchanged.
+    lv_obj_set_style_text_color(g_lv.battLbl, g_lvColors.muted, LV_PART_MAIN);
+  }
+#endif
+  uiSetBatteryMv(power.battMv, power.charging);
 }
 
+bool uiLowPowerTheme() { return g_lowPower; }
+
 void uiRenderSplash(const UiState &state, const char *title, const char *subtitle) {
   if (!state.ready || !displayIsReady()) return;
+  UiUpdateScope scope;
   uiSetOpClass(nullptr);
   uiSetTitle(String(title ? title : ""), subtitle ? String(subtitle) : String(""));
   uiSetRoute(String("-"));
@@ -284,15 +589,14 @@ void uiRenderSplash(const UiState &state, const char *title, const char *subtitl
 
 void uiRenderNoData(const UiState &state, const char *detail) {
   if (!state.ready || !displayIsReady()) return;
+  UiUpdateScope scope;
   uiSetOpClass(nullptr);
   uiSetTitle(String("No Data"), detail ? String(detail) : String(""));
   uiSetRoute(String("-"));
   uiSetMetrics("-", "-", "-");
 }
 
-void uiRenderFlight(const UiState &state, const FlightInfo &fi) {
-  if (!state.ready || !displayIsReady()) return;
-
+void uiFormatFlight(const FlightInfo &fi, UiFlightText &out) {
   String friendly = fi.typeCode.length() ? aircraftFriendlyName(fi.typeCode) : String("");
   bool isPseudo = false;
   String codeUC = fi.typeCode;
@@ -315,49 +619,98 @@ void uiRenderFlight(const UiState &state, const FlightInfo &fi) {
   }
   if (!friendly.length() && fi.displayName.length()) friendly = fi.displayName;
   if (!friendly.length()) friendly = String("Unknown Aircraft");
+  out.title = friendly;
+  out.subtitle = fi.ident.length() ? fi.ident : String("-");
 
-  uiSetOpClass(fi.opClass.c_str());
-
-  String callsign = fi.ident.length() ? fi.ident : String("-");
-  uiSetTitle(friendly, callsign);
-
-  String routeLine = fi.route;
-  if (!routeLine.length() && fi.registeredOwner.length()) {
-    routeLine = fi.registeredOwner;
+  out.route = fi.route;
+  if (!out.route.length() && fi.registeredOwner.length()) {
+    out.route = fi.registeredOwner;
   }
-  if (!routeLine.length()) routeLine = String("-");
-  uiSetRoute(routeLine);
+  if (!out.route.length()) out.route = String("-");
 
-  char distStr[16];
   if (!isnan(fi.distanceKm)) {
-    snprintf(distStr, sizeof(distStr), "%.1f km", fi.distanceKm);
+    snprintf(out.dist, sizeof(out.dist), "%.1f km", fi.distanceKm);
   } else {
-    snprintf(distStr, sizeof(distStr), "-");
+    snprintf(out.dist, sizeof(out.dist), "-");
   }
 
-  char seatsStr[12];
   if (isPseudo) {
-    snprintf(seatsStr, sizeof(seatsStr), "-");
+    snprintf(out.seats, sizeof(out.seats), "-");
   } else if (fi.seatOverride > 0) {
-    snprintf(seatsStr, sizeof(seatsStr), "%d", fi.seatOverride);
+    snprintf(out.seats, sizeof(out.seats), "%d", fi.seatOverride);
   } else {
     uint16_t maxSeats = 0;
     if (fi.typeCode.length() && aircraftSeatMax(fi.typeCode, maxSeats) && maxSeats > 0) {
-      snprintf(seatsStr, sizeof(seatsStr), "%u", maxSeats);
+      snprintf(out.seats, sizeof(out.seats), "%u", maxSeats);
     } else {
-      snprintf(seatsStr, sizeof(seatsStr), "-");
+      snprintf(out.seats, sizeof(out.seats), "-");
     }
   }
 
-  char altStr[16];
   if (fi.altitudeFt <= 0) {
-    snprintf(altStr, sizeof(altStr), "ground");
+    snprintf(out.alt, sizeof(out.alt), "ground");
   } else {
     int meters = (int)(fi.altitudeFt * 0.3048 + 0.5);
-    snprintf(altStr, sizeof(altStr), "%d m", meters);
+    snprintf(out.alt, sizeof(out.alt), "%d m", meters);
   }
+}
 
-  uiSetMetrics(distStr, seatsStr, altStr);
+void uiRenderFlight(const UiState &state, const FlightInfo &fi) {
+  if (!state.ready || !displayIsReady()) return;
+  UiUpdateScope scope;
+
+  UiFlightText text;
+  uiFormatFlight(fi, text);
+  uiSetOpClass(fi.opClass.c_str());
+  uiSetTitle(text.title, text.subtitle);
+  uiSetRoute(text.route);
+  uiSetMetrics(text.dist, text.seats, text.alt);
+}
+
+void uiRenderRadar(const UiState &state, const RadarSnapshot &snap) {
+#if FEATURE_RADAR_VIEW
+  if (!state.ready || !displayIsReady() || !g_radar.layer) return;
+  UiUpdateScope scope;
+
+  // Keep each aircraft on the blip object it had last time so a moving
+  // target repaints only its own box, then hand out the rest.
+  int8_t slotFor[RADAR_MAX_BLIPS];
+  bool taken[RADAR_MAX_BLIPS] = {};
+  for (size_t i = 0; i < snap.count; ++i) {
+    slotFor[i] = -1;
+    for (size_t j = 0; j < RADAR_MAX_BLIPS; ++j) {
+      if (!taken[j] && g_radar.blips[j].used && g_radar.blips[j].id == snap.blips[i].id) {
+        slotFor[i] = (int8_t)j;
+        taken[j] = true;
+        break;
+      }
+    }
+  }
+  for (size_t i = 0; i < snap.count; ++i) {
+    if (slotFor[i] >= 0) continue;
+    for (size_t j = 0; j < RADAR_MAX_BLIPS; ++j) {
+      if (taken[j]) continue;
+      slotFor[i] = (int8_t)j;
+      taken[j] = true;
+      g_radar.blips[j].used = false;
+      break;
+    }
+  }
+  for (size_t i = 0; i < snap.count; ++i) {
+    uiRadarPlace(g_radar.blips[slotFor[i]], snap.blips[i]);
+  }
+  for (size_t j = 0; j < RADAR_MAX_BLIPS; ++j) {
+    UiRadarBlip &b = g_radar.blips[j];
+    if (taken[j] || !b.used) continue;
+    lv_obj_add_flag(b.box, LV_OBJ_FLAG_HIDDEN);
+    b.used = false;
+  }
+#else
+  (void)state;
+  (void)snap;
+#endif
 }
 
 bool uiIsReady(const UiState &state) { return state.ready; }
+
+UiRenderStats uiGetRenderStats() { return g_uiStats; }
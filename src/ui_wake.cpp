@@ -0,0 +1,26 @@
+#include "ui_wake.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static TaskHandle_t g_uiTask = nullptr;
+
+void uiWakeInit() { g_uiTask = xTaskGetCurrentTaskHandle(); }
+
+void uiWake() {
+  if (g_uiTask) xTaskNotifyGive(g_uiTask);
+}
+
+void IRAM_ATTR uiWakeFromIsr() {
+  if (!g_uiTask) return;
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(g_uiTask, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+bool uiWakeWait(uint32_t maxMs) {
+  if (!g_uiTask || maxMs == 0) return false;
+  // Wake-ups that arrived while the loop was busy are consumed here, so a
+  // publish never gets lost between the check and the wait.
+  return ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(maxMs)) > 0;
+}
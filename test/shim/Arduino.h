@@ -0,0 +1,240 @@
+#pragma once
+
+// Host stand-in for the slice of the Arduino-ESP32 core that the
+// hardware-independent modules use, so they build and run under the native
+// test env. Header-only: every test binary gets its own copy of the state.
+
+#include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "esp32-hal-psram.h"
+
+#ifndef __cplusplus
+// C sources (LVGL's LV_TICK_CUSTOM_INCLUDE) only need a millisecond tick.
+// They read the host's monotonic clock and do not follow a pinned clock.
+#include <time.h>
+
+static inline uint32_t millis(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000);
+}
+#else
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using std::max;
+using std::min;
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// Clock. micros()/millis() follow the host's monotonic clock until a test
+// pins them with shimSetMicros(); from then on they only move when the test
+// advances them (delay() advances a pinned clock instead of sleeping).
+namespace shim {
+inline bool fakeClock = false;
+inline uint64_t fakeUs = 0;
+
+inline uint64_t realUs() {
+  static const auto start = std::chrono::steady_clock::now();
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+}  // namespace shim
+
+inline void shimSetMicros(uint64_t us) {
+  shim::fakeClock = true;
+  shim::fakeUs = us;
+}
+inline void shimAdvanceMicros(uint64_t us) { shim::fakeUs += us; }
+inline void shimAdvanceMillis(uint32_t ms) { shim::fakeUs += (uint64_t)ms * 1000; }
+inline void shimUseRealClock() { shim::fakeClock = false; }
+
+inline uint32_t micros() { return (uint32_t)(shim::fakeClock ? shim::fakeUs : shim::realUs()); }
+inline uint32_t millis() {
+  return (uint32_t)((shim::fakeClock ? shim::fakeUs : shim::realUs()) / 1000);
+}
+inline void delay(uint32_t ms) {
+  if (shim::fakeClock) {
+    shimAdvanceMillis(ms);
+  } else {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+  }
+}
+inline void yield() {}
+
+class String {
+ public:
+  String() = default;
+  String(const char *s) : _s(s ? s : "") {}
+  String(const std::string &s) : _s(s) {}
+  explicit String(char c) : _s(1, c) {}
+  explicit String(int v) : _s(std::to_string(v)) {}
+  explicit String(unsigned v) : _s(std::to_string(v)) {}
+  explicit String(long v) : _s(std::to_string(v)) {}
+  explicit String(unsigned long v) : _s(std::to_string(v)) {}
+  String(double v, unsigned decimals) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+    _s = buf;
+  }
+
+  const char *c_str() const { return _s.c_str(); }
+  unsigned length() const { return (unsigned)_s.size(); }
+  bool reserve(unsigned n) {
+    _s.reserve(n);
+    return true;
+  }
+  char charAt(unsigned i) const { return i < _s.size() ? _s[i] : 0; }
+  char operator[](unsigned i) const { return charAt(i); }
+
+  void trim() {
+    size_t b = 0;
+    size_t e = _s.size();
+    while (b < e && isspace((unsigned char)_s[b])) ++b;
+    while (e > b && isspace((unsigned char)_s[e - 1])) --e;
+    _s = _s.substr(b, e - b);
+  }
+  void toUpperCase() {
+    for (char &c : _s) c = (char)toupper((unsigned char)c);
+  }
+  void toLowerCase() {
+    for (char &c : _s) c = (char)tolower((unsigned char)c);
+  }
+  bool startsWith(const String &p) const { return _s.compare(0, p._s.size(), p._s) == 0; }
+  bool endsWith(const String &p) const {
+    return _s.size() >= p._s.size() && _s.compare(_s.size() - p._s.size(), p._s.size(), p._s) == 0;
+  }
+  bool equals(const String &o) const { return _s == o._s; }
+  bool equalsIgnoreCase(const String &o) const { return strcasecmp(c_str(), o.c_str()) == 0; }
+  int indexOf(char c, unsigned from = 0) const { return find(_s.find(c, from)); }
+  int indexOf(const String &s, unsigned from = 0) const { return find(_s.find(s._s, from)); }
+  String substring(unsigned from) const { return from < _s.size() ? _s.substr(from) : ""; }
+  String substring(unsigned from, unsigned to) const {
+    if (from > to) std::swap(from, to);
+    return from < _s.size() ? _s.substr(from, to - from) : "";
+  }
+  void replace(const String &from, const String &to) {
+    if (from._s.empty()) return;
+    for (size_t p = _s.find(from._s); p != std::string::npos; p = _s.find(from._s, p + to._s.size())) {
+      _s.replace(p, from._s.size(), to._s);
+    }
+  }
+  long toInt() const { return strtol(c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(c_str(), nullptr); }
+
+  String &operator+=(const String &o) {
+    _s += o._s;
+    return *this;
+  }
+  String &operator+=(const char *o) {
+    _s += o;
+    return *this;
+  }
+  String &operator+=(char c) {
+    _s += c;
+    return *this;
+  }
+  friend String operator+(const String &a, const String &b) { return a._s + b._s; }
+  friend String operator+(const String &a, const char *b) { return a._s + b; }
+  friend String operator+(const char *a, const String &b) { return a + b._s; }
+  friend bool operator==(const String &a, const String &b) { return a._s == b._s; }
+  friend bool operator==(const String &a, const char *b) { return a._s == (b ? b : ""); }
+  friend bool operator!=(const String &a, const String &b) { return a._s != b._s; }
+  friend bool operator!=(const String &a, const char *b) { return !(a == b); }
+  friend bool operator<(const String &a, const String &b) { return a._s < b._s; }
+
+ private:
+  static int find(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+
+  std::string _s;
+};
+
+class Print {
+ public:
+  virtual ~Print() = default;
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, size_t n) {
+    for (size_t i = 0; i < n; ++i) write(buf[i]);
+    return n;
+  }
+  size_t print(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+  size_t print(const String &s) { return print(s.c_str()); }
+  size_t println(const char *s = "") { return print(s) + write((uint8_t)'\n'); }
+  size_t println(const String &s) { return println(s.c_str()); }
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[512];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (n < 0) return 0;
+    return write((const uint8_t *)buf, std::min((size_t)n, sizeof(buf) - 1));
+  }
+  virtual void flush() {}
+};
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual size_t readBytes(char *buf, size_t n) {
+    size_t i = 0;
+    for (; i < n; ++i) {
+      int c = read();
+      if (c < 0) break;
+      buf[i] = (char)c;
+    }
+    return i;
+  }
+  size_t readBytes(uint8_t *buf, size_t n) { return readBytes((char *)buf, n); }
+};
+
+// Serial output goes to stdout; tests that check output use their own Print.
+class HardwareSerial : public Stream {
+ public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+  size_t write(const uint8_t *buf, size_t n) override { return fwrite(buf, 1, n, stdout); }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  void flush() override { fflush(stdout); }
+};
+
+inline HardwareSerial Serial;
+
+// FreeRTOS critical sections map onto a plain mutex; like portMUX they are
+// not recursive.
+struct portMUX_TYPE {
+  std::mutex lock;
+};
+#define portMUX_INITIALIZER_UNLOCKED \
+  {}
+#define portENTER_CRITICAL(mux) (mux)->lock.lock()
+#define portEXIT_CRITICAL(mux) (mux)->lock.unlock()
+#define portENTER_CRITICAL_ISR(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux) portEXIT_CRITICAL(mux)
+
+#endif  // __cplusplus
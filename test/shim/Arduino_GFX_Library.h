@@ -0,0 +1,4 @@
+#pragma once
+
+// config_hw.h names GFX colour orders in macros that host builds never
+// expand; nothing from the GFX library is needed.
@@ -0,0 +1,4 @@
+#pragma once
+
+// config_hw.h names Wi-Fi TX power levels in macros that host builds never
+// expand; nothing from the Wi-Fi library is needed.
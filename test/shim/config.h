@@ -0,0 +1,5 @@
+#pragma once
+
+// Host builds use the example configuration, so a local config.h with real
+// credentials never ends up in a test binary.
+#include "example-config.h"
@@ -0,0 +1,10 @@
+#pragma once
+
+// PSRAM allocations come from the ordinary heap on the host. Also included
+// from C (LVGL's LV_MEM_CUSTOM_INCLUDE), hence static inline.
+
+#include <stdlib.h>
+
+static inline void *ps_malloc(size_t size) { return malloc(size); }
+static inline void *ps_calloc(size_t n, size_t size) { return calloc(n, size); }
+static inline void *ps_realloc(void *ptr, size_t size) { return realloc(ptr, size); }
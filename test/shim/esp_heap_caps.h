@@ -0,0 +1,22 @@
+#pragma once
+
+// Host memory has no capabilities to choose between; every request is a
+// plain heap allocation.
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_8BIT (1 << 2)
+
+inline void *heap_caps_malloc(size_t size, uint32_t caps) {
+  (void)caps;
+  return malloc(size);
+}
+inline void heap_caps_free(void *ptr) { free(ptr); }
+inline size_t heap_caps_get_free_size(uint32_t caps) {
+  (void)caps;
+  return 0;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+
+// Deterministic stand-in for the hardware RNG so runs are repeatable; tests
+// that care about the sequence reseed it.
+namespace shim {
+inline uint32_t randomState = 0x2545F491u;
+}  // namespace shim
+
+inline void shimSeedRandom(uint32_t seed) { shim::randomState = seed ? seed : 1; }
+
+inline uint32_t esp_random() {
+  uint32_t x = shim::randomState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  shim::randomState = x;
+  return x;
+}
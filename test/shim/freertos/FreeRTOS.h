@@ -0,0 +1,21 @@
+#pragma once
+
+// Enough of the FreeRTOS types and macros for code that only hands out
+// wake-ups and waits; on the host there is no scheduler to talk to.
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY 0xFFFFFFFFu
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portYIELD_FROM_ISR() \
+  do {                       \
+  } while (0)
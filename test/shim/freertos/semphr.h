@@ -0,0 +1,46 @@
+#pragma once
+
+// Binary and mutex semaphores on a condition variable, for code that hands a
+// completion from one thread to another.
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include "FreeRTOS.h"
+
+struct ShimSemaphore {
+  std::mutex lock;
+  std::condition_variable cv;
+  unsigned count = 0;
+};
+typedef ShimSemaphore *SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateBinary() { return new ShimSemaphore(); }
+inline SemaphoreHandle_t xSemaphoreCreateMutex() {
+  SemaphoreHandle_t s = new ShimSemaphore();
+  s->count = 1;
+  return s;
+}
+inline void vSemaphoreDelete(SemaphoreHandle_t s) { delete s; }
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(s->lock);
+  auto ready = [s]() { return s->count > 0; };
+  if (ticks == portMAX_DELAY) {
+    s->cv.wait(lock, ready);
+  } else if (!s->cv.wait_for(lock, std::chrono::milliseconds(ticks), ready)) {
+    return pdFALSE;
+  }
+  --s->count;
+  return pdTRUE;
+}
+
+// Giving a binary semaphore that is already available leaves it at one.
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+  std::lock_guard<std::mutex> lock(s->lock);
+  if (s->count) return pdFALSE;
+  s->count = 1;
+  s->cv.notify_one();
+  return pdTRUE;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+// Tasks do not exist on the host: there is no current task handle, so code
+// that notifies "the UI task" sees none registered and does nothing.
+
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return nullptr; }
+inline BaseType_t xTaskNotifyGive(TaskHandle_t) { return pdPASS; }
+inline void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t *woken) {
+  if (woken) *woken = pdFALSE;
+}
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
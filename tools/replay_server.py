@@ -0,0 +1,272 @@
+#!/usr/bin/env python3
+"""Local HTTPS stand-in for the aggregator, MIL list, routeset and HexDB APIs.
+
+Serves responses from a capture file so the firmware's fetch cycle can be
+exercised repeatably without internet access. Latency, jitter, truncated
+bodies and errors can be injected with a fixed seed.
+
+Capture format: JSON Lines, one response per line.
+
+    {"method": "GET", "path": "/v2/mil", "status": 200,
+     "headers": {"Content-Type": "application/json"}, "body": "..."}
+
+Optional keys:
+    "match"          regex matched against the request path instead of "path"
+    "body_contains"  substring the request body must contain (routeset POSTs)
+    "body_file"      file with the body, relative to the capture file
+
+Several records for the same request are served in turn, one per request,
+and the last one repeats; a capture of consecutive polls replays as a
+sequence.
+
+    tools/replay_server.py record -o capture.jsonl URL [URL ...]
+    tools/replay_server.py serve capture.jsonl --cert cert.pem --key key.pem
+"""
+
+import argparse
+import http.server
+import json
+import os
+import random
+import re
+import ssl
+import sys
+import threading
+import time
+import urllib.error
+import urllib.parse
+import urllib.request
+
+
+class Capture:
+    def __init__(self, path):
+        self.records = []
+        base = os.path.dirname(os.path.abspath(path))
+        with open(path, encoding="utf-8") as f:
+            for lineno, line in enumerate(f, 1):
+                line = line.strip()
+                if not line or line.startswith("#"):
+                    continue
+                rec = json.loads(line)
+                if "body_file" in rec:
+                    with open(os.path.join(base, rec["body_file"]), "rb") as bf:
+                        rec["body"] = bf.read()
+                elif isinstance(rec.get("body"), str):
+                    rec["body"] = rec["body"].encode("utf-8")
+                rec.setdefault("method", "GET")
+                rec.setdefault("status", 200)
+                rec.setdefault("headers", {"Content-Type": "application/json"})
+                rec.setdefault("body", b"")
+                rec["_line"] = lineno
+                if "match" in rec:
+                    rec["_re"] = re.compile(rec["match"])
+                self.records.append(rec)
+        self._next = {}
+        self._lock = threading.Lock()
+
+    def _matches(self, rec, method, path, body):
+        if rec["method"] != method:
+            return False
+        if "_re" in rec:
+            if not rec["_re"].search(path):
+                return False
+        elif rec.get("path") != path:
+            return False
+        needle = rec.get("body_contains")
+        return needle is None or needle.encode("utf-8") in body
+
+    def lookup(self, method, path, body):
+        hits = [r for r in self.records if self._matches(r, method, path, body)]
+        if not hits:
+            return None
+        key = (method, path, hits[0]["_line"])
+        with self._lock:
+            i = self._next.get(key, 0)
+            self._next[key] = i + 1
+        return hits[min(i, len(hits) - 1)]
+
+
+class Faults:
+    def __init__(self, args):
+        self.latency_ms = args.latency_ms
+        self.jitter_ms = args.jitter_ms
+        self.error_rate = args.error_rate
+        self.truncate_rate = args.truncate_rate
+        self.drop_rate = args.drop_rate
+        self._rng = random.Random(args.seed)
+        self._lock = threading.Lock()
+
+    def roll(self):
+        with self._lock:
+            delay = self.latency_ms + self._rng.uniform(0, self.jitter_ms)
+            r = self._rng.random()
+        if r < self.drop_rate:
+            return delay, "drop"
+        r -= self.drop_rate
+        if r < self.error_rate:
+            return delay, "error"
+        r -= self.error_rate
+        if r < self.truncate_rate:
+            return delay, "truncate"
+        return delay, None
+
+
+class Stats:
+    def __init__(self):
+        self.requests = 0
+        self.bytes = 0
+        self.misses = 0
+        self.faults = {}
+        self._lock = threading.Lock()
+
+    def add(self, sent, fault, miss):
+        with self._lock:
+            self.requests += 1
+            self.bytes += sent
+            self.misses += miss
+            if fault:
+                self.faults[fault] = self.faults.get(fault, 0) + 1
+
+    def summary(self):
+        faults = " ".join(f"{k}={v}" for k, v in sorted(self.faults.items()))
+        return (f"requests={self.requests} bytes={self.bytes} misses={self.misses}"
+                f" {faults}").rstrip()
+
+
+def make_handler(capture, faults, stats, quiet):
+    class Handler(http.server.BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.1"
+
+        def _serve(self):
+            length = int(self.headers.get("Content-Length") or 0)
+            body = self.rfile.read(length) if length else b""
+            path = urllib.parse.urlsplit(self.path).path
+            delay, fault = faults.roll()
+            time.sleep(delay / 1000.0)
+
+            rec = capture.lookup(self.command, path, body)
+            if fault == "drop":
+                stats.add(0, fault, rec is None)
+                self.close_connection = True
+                return
+            if rec is None:
+                self._reply(404, {"Content-Type": "text/plain"}, b"not in capture\n")
+                stats.add(0, None, True)
+                return
+            if fault == "error":
+                self._reply(503, {"Content-Type": "text/plain"}, b"injected error\n")
+                stats.add(0, fault, False)
+                return
+
+            payload = rec["body"]
+            sent = payload
+            if fault == "truncate":
+                sent = payload[: len(payload) // 2]
+            self._reply(rec["status"], rec["headers"], payload, sent)
+            stats.add(len(sent), fault, False)
+
+        def _reply(self, status, headers, payload, sent=None):
+            self.send_response(status)
+            for k, v in headers.items():
+                if k.lower() not in ("content-length", "transfer-encoding", "connection"):
+                    self.send_header(k, v)
+            self.send_header("Content-Length", str(len(payload)))
+            self.send_header("Connection", "close")
+            self.end_headers()
+            self.wfile.write(payload if sent is None else sent)
+            self.close_connection = True
+
+        do_GET = _serve
+        do_POST = _serve
+
+        def log_message(self, fmt, *args):
+            if not quiet:
+                sys.stderr.write("%s %s\n" % (self.log_date_time_string(), fmt % args))
+
+    return Handler
+
+
+def serve(args):
+    capture = Capture(args.capture)
+    faults = Faults(args)
+    stats = Stats()
+    handler = make_handler(capture, faults, stats, args.quiet)
+    server = http.server.ThreadingHTTPServer((args.host, args.port), handler)
+    if args.cert:
+        ctx = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        ctx.load_cert_chain(args.cert, args.key)
+        server.socket = ctx.wrap_socket(server.socket, server_side=True)
+    scheme = "https" if args.cert else "http"
+    print(f"Serving {len(capture.records)} records on {scheme}://{args.host}:{args.port}",
+          file=sys.stderr)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    print(stats.summary(), file=sys.stderr)
+
+
+def record(args):
+    with open(args.output, "a", encoding="utf-8") as out:
+        for url in args.urls:
+            data = args.post_json.encode("utf-8") if args.post_json else None
+            req = urllib.request.Request(url, data=data, method="POST" if data else "GET")
+            req.add_header("User-Agent", "ESP32-FlightDisplay/2.0")
+            req.add_header("Accept", "application/json")
+            if data:
+                req.add_header("Content-Type", "application/json")
+            try:
+                with urllib.request.urlopen(req, timeout=args.timeout) as resp:
+                    status, headers, body = resp.status, resp.headers, resp.read()
+            except urllib.error.HTTPError as e:
+                status, headers, body = e.code, e.headers, e.read()
+            rec = {
+                "method": req.get_method(),
+                "path": urllib.parse.urlsplit(url).path,
+                "status": status,
+                "headers": {"Content-Type": headers.get("Content-Type", "application/json")},
+                "body": body.decode("utf-8", "replace"),
+            }
+            if args.match:
+                rec["match"] = args.match
+            out.write(json.dumps(rec) + "\n")
+            print(f"{status} {len(body)}B {url}", file=sys.stderr)
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    sub = p.add_subparsers(dest="cmd", required=True)
+
+    s = sub.add_parser("serve", help="replay a capture")
+    s.add_argument("capture")
+    s.add_argument("--host", default="0.0.0.0")
+    s.add_argument("--port", type=int, default=8443)
+    s.add_argument("--cert", help="PEM certificate; omit to serve plain HTTP")
+    s.add_argument("--key", help="PEM private key")
+    s.add_argument("--latency-ms", type=float, default=0.0)
+    s.add_argument("--jitter-ms", type=float, default=0.0)
+    s.add_argument("--error-rate", type=float, default=0.0, help="share answered with 503")
+    s.add_argument("--truncate-rate", type=float, default=0.0,
+                   help="share whose body stops halfway")
+    s.add_argument("--drop-rate", type=float, default=0.0,
+                   help="share closed without a response")
+    s.add_argument("--seed", type=int, default=1)
+    s.add_argument("--quiet", action="store_true")
+    s.set_defaults(func=serve)
+
+    r = sub.add_parser("record", help="append live responses to a capture")
+    r.add_argument("urls", nargs="+")
+    r.add_argument("-o", "--output", required=True)
+    r.add_argument("--post-json", help="send this JSON body as a POST (routeset)")
+    r.add_argument("--match", help="store a path regex instead of the exact path")
+    r.add_argument("--timeout", type=float, default=15.0)
+    r.set_defaults(func=record)
+
+    args = p.parse_args()
+    if args.cmd == "serve" and bool(args.cert) != bool(args.key):
+        p.error("--cert and --key go together")
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()